@@ -0,0 +1,37 @@
+import { NodeRand_mt19937 as NodeRand, NodeRand_xoshiro256ss } from '../src'
+import { measure, report, BenchResult } from './harness'
+
+// calls per measured run, keeps harness overhead out of ns/call
+const CALLS = 100000;
+const MIN = -1000;
+const MAX = 1000;
+
+/**
+ * Per call overhead of the synchronous API. values/sec and ns/value read as calls/sec and ns/call.
+ */
+export async function run(): Promise<void> {
+    const results: BenchResult[] = [];
+
+    for (const Engine of [NodeRand, NodeRand_xoshiro256ss]) {
+        const rng = new Engine();
+        rng.SetSeed(10);
+
+        results.push(await measure(`${Engine.name} Generate`, CALLS, () => {
+            for (let i = 0; i < CALLS; i++) {
+                rng.Generate(MIN, MAX);
+            }
+        }));
+        results.push(await measure(`${Engine.name} SetSeed`, CALLS, () => {
+            for (let i = 0; i < CALLS; i++) {
+                rng.SetSeed(i);
+            }
+        }));
+        results.push(await measure(`${Engine.name} construction`, CALLS, () => {
+            for (let i = 0; i < CALLS; i++) {
+                new Engine();
+            }
+        }));
+    }
+
+    report(`Call overhead (ns/value = ns/call)`, results);
+}
@@ -0,0 +1,28 @@
+import { NodeRand_mt19937 as NodeRand, StreamOptions } from '../src'
+import { measure, report, BenchResult } from './harness'
+
+const COUNT = 10000000;
+const MIN = -1000;
+const MAX = 1000;
+
+function drain(rng: NodeRand, options: StreamOptions): Promise<void> {
+    return new Promise(resolve => {
+        const readable = rng.GenerateSequenceStream(MIN, MAX, COUNT, options);
+        readable.on('data', () => {});
+        readable.on('end', resolve);
+    });
+}
+
+export async function run(): Promise<void> {
+    const rng = new NodeRand();
+    rng.SetSeed(10);
+
+    const results: BenchResult[] = [];
+    for (const chunkSize of [250, 500, 2000, 8000, 32000, 128000, 512000]) {
+        results.push(await measure(`chunkSize ${chunkSize}`, COUNT, () => drain(rng, { chunkSize })));
+    }
+    results.push(await measure('adaptive', COUNT, () => drain(rng, { adaptive: true })));
+    results.push(await measure('adaptive, highWaterMark 4MB', COUNT, () => drain(rng, { adaptive: true, highWaterMark: 4 * 1024 * 1024 })));
+
+    report(`GenerateSequenceStream throughput by chunk size, ${COUNT} values`, results);
+}
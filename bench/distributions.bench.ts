@@ -0,0 +1,37 @@
+import { NodeRand_xoshiro256ss as NodeRand } from '../src'
+import { measure, report, BenchResult } from './harness'
+
+const COUNT = 1000000;
+
+/**
+ * Native distribution handles against transforming uniform doubles in JS.
+ */
+export async function run(): Promise<void> {
+    const rng = new NodeRand();
+    rng.SetSeed(10);
+
+    const uniforms = new Float64Array(COUNT);
+    const out = new Float64Array(COUNT);
+    const results: BenchResult[] = [];
+
+    results.push(await measure('JS Box-Muller over GenerateInto Float64Array', COUNT, () => {
+        rng.GenerateInto(uniforms, 0, 1);
+        for (let i = 0; i + 1 < COUNT; i += 2) {
+            const r = Math.sqrt(-2 * Math.log(1 - uniforms[i]));
+            const theta = 2 * Math.PI * uniforms[i + 1];
+            out[i] = r * Math.cos(theta);
+            out[i + 1] = r * Math.sin(theta);
+        }
+    }));
+    results.push(await measure('Uniform GenerateInto Float64Array', COUNT, () => rng.GenerateInto(out, 0, 1)));
+    results.push(await measure('Uniform GenerateInto Float32Array', COUNT, () => rng.GenerateInto(new Float32Array(out.buffer, 0, COUNT), 0, 1)));
+    results.push(await measure('Normal Fill Float64Array', COUNT, () => rng.Normal(0, 1).Fill(out)));
+    results.push(await measure('Exponential Fill Float64Array', COUNT, () => rng.Exponential(1).Fill(out)));
+    results.push(await measure('Gamma(2.5) Fill Float64Array', COUNT, () => rng.Gamma(2.5, 1).Fill(out)));
+    results.push(await measure('Poisson(4) Fill Float64Array', COUNT, () => rng.Poisson(4).Fill(out)));
+    results.push(await measure('Poisson(100) Fill Float64Array', COUNT, () => rng.Poisson(100).Fill(out)));
+    results.push(await measure('Binomial(1000, 0.3) Fill Float64Array', COUNT, () => rng.Binomial(1000, 0.3).Fill(out)));
+    results.push(await measure('Discrete(1000 weights) Fill Int32Array', COUNT, () => rng.Discrete(Array.from({ length: 1000 }, (_, i) => i + 1)).Fill(new Int32Array(out.buffer, 0, COUNT))));
+
+    report(`Distributions, ${COUNT} values`, results);
+}
@@ -0,0 +1,50 @@
+import { NodeRand_mt19937 as NodeRand, RingReader, Type } from '../src'
+import { Readable } from 'stream'
+import * as os from 'os'
+import { measure, report, BenchResult } from './harness'
+
+const COUNT = 1000000;
+const MIN = -1000;
+const MAX = 1000;
+const THREADS = Math.min(os.cpus().length, 256);
+
+function drain(readable: Readable): Promise<void> {
+    return new Promise(resolve => {
+        readable.on('data', () => {});
+        readable.on('end', resolve);
+    });
+}
+
+export async function run(): Promise<void> {
+    const rng = new NodeRand();
+    rng.SetSeed(10);
+
+    const bigInt64 = new BigInt64Array(COUNT);
+    const int32 = new Int32Array(COUNT);
+    const float64 = new Float64Array(COUNT);
+    const results: BenchResult[] = [];
+
+    results.push(await measure('Generate x N', COUNT, () => {
+        for (let i = 0; i < COUNT; i++) {
+            rng.Generate(MIN, MAX);
+        }
+    }));
+    results.push(await measure('GenerateSequenceStream (drain)', COUNT, () => drain(rng.GenerateSequenceStream(MIN, MAX, COUNT))));
+    results.push(await measure('GenerateBatches Int32 (for await)', COUNT, async () => {
+        for await (const batch of rng.GenerateBatches(MIN, MAX, COUNT, { type: Type.Int32, chunkSize: 16384 })) {}
+    }));
+    results.push(await measure('GenerateSequenceStream Int32 (drain)', COUNT, () => drain(rng.GenerateSequenceStream(MIN, MAX, COUNT, { type: Type.Int32, chunkSize: 16384 }))));
+    results.push(await measure('GenerateInto BigInt64Array', COUNT, () => rng.GenerateInto(bigInt64, MIN, MAX)));
+    results.push(await measure('GenerateInto Int32Array', COUNT, () => rng.GenerateInto(int32, MIN, MAX)));
+    results.push(await measure('GenerateInto Float64Array', COUNT, () => rng.GenerateInto(float64, MIN, MAX)));
+    results.push(await measure('GenerateIntoAsync BigInt64Array', COUNT, () => rng.GenerateIntoAsync(bigInt64, MIN, MAX)));
+    results.push(await measure(`GenerateInto BigInt64Array (threads: ${THREADS})`, COUNT, () => rng.GenerateInto(bigInt64, MIN, MAX, { threads: THREADS })));
+    results.push(await measure(`GenerateSequenceStream (drain, threads: ${THREADS})`, COUNT, () => drain(rng.GenerateSequenceStream(MIN, MAX, COUNT, { threads: THREADS }))));
+
+    const ring = rng.SharedRing(MIN, MAX);
+    const reader = new RingReader(ring.Buffer());
+    results.push(await measure('SharedRing RingReader.Fill BigInt64Array', COUNT, () => reader.Fill(bigInt64)));
+    ring.Close();
+
+    report(`Bulk generation of ${COUNT} values`, results);
+}
@@ -0,0 +1,76 @@
+/**
+ * Minimal benchmark harness. Each benchmark runs fn() until at least minTime ms have elapsed
+ * and reports throughput in values/sec and ns/value, and the heap bytes one run allocates per value.
+ */
+import * as fs from 'fs'
+import * as v8 from 'v8'
+import * as vm from 'vm'
+
+export interface BenchResult {
+    name: string;
+    values: number;
+    seconds: number;
+    // JS heap and ArrayBuffer bytes still allocated after one run, per value
+    bytesPerValue: number;
+}
+
+const DEFAULT_MIN_TIME_MS = 500;
+
+v8.setFlagsFromString('--expose-gc');
+const gc: () => void = vm.runInNewContext('gc');
+
+// every reported result, per suite, for writeJson
+const reported: { suite: string, result: BenchResult }[] = [];
+
+function allocatedBytes(): number {
+    const usage = process.memoryUsage();
+    return usage.heapUsed + usage.external;
+}
+
+export async function measure(name: string, valuesPerRun: number, fn: () => unknown, minTimeMs: number = DEFAULT_MIN_TIME_MS): Promise<BenchResult> {
+    // warmup, then one run from a collected heap. Garbage collected during the run is not counted.
+    await fn();
+    gc();
+    const before = allocatedBytes();
+    await fn();
+    const bytesPerValue = Math.max(0, allocatedBytes() - before) / valuesPerRun;
+
+    let runs = 0;
+    const start = process.hrtime.bigint();
+    let elapsed = BigInt(0);
+    while (elapsed < BigInt(minTimeMs) * BigInt(1e6)) {
+        await fn();
+        runs++;
+        elapsed = process.hrtime.bigint() - start;
+    }
+    return { name, values: runs * valuesPerRun, seconds: Number(elapsed) / 1e9, bytesPerValue };
+}
+
+export function report(title: string, results: BenchResult[]): void {
+    reported.push(...results.map(result => ({ suite: title, result })));
+    console.log(`\n${title}`);
+    console.table(results.map(r => ({
+        name: r.name,
+        'values/sec': Math.round(r.values / r.seconds).toLocaleString(),
+        'ns/value': (r.seconds * 1e9 / r.values).toFixed(2),
+        'bytes/value': r.bytesPerValue.toFixed(3),
+    })));
+}
+
+/**
+ * Write every reported result as JSON, same layout as the native benchmark's --json
+ */
+export function writeJson(path: string): void {
+    const results = reported.map(({ suite, result: r }) => ({
+        suite,
+        name: r.name,
+        values: r.values,
+        seconds: r.seconds,
+        valuesPerSec: r.values / r.seconds,
+        nsPerValue: r.seconds * 1e9 / r.values,
+        bytesPerValue: r.bytesPerValue,
+    }));
+    const json = { suite: 'js', date: Math.floor(Date.now() / 1000), node: process.version, results };
+    fs.writeFileSync(path, JSON.stringify(json, null, 2) + '\n');
+    console.log(`Wrote ${path}`);
+}
@@ -0,0 +1,289 @@
+/**
+ * Native benchmarks of the engines and distributions, without N-API. Built by binding.gyp when
+ * node_rand_bench=1, see README. Each case runs until at least --min-time ms have elapsed and reports
+ * values/sec, ns/value and heap bytes allocated per value. Same JSON layout as bench/run.ts --json.
+ *
+ *   node_rand_bench [--json path] [--min-time ms] [--filter substring] [--threads n]
+ */
+
+#include "NodeEngines.h"
+#include "NodeRNG.h"
+#include "NodeDistributions.h"
+#include "NodeParallel.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace node_rand;
+
+// heap bytes allocated by operator new, process wide
+static std::atomic<uint64_t> g_allocatedBytes{0};
+
+void* operator new(size_t size)
+{
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == nullptr) {
+        // node-gyp builds without exceptions
+        std::abort();
+    }
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+/// \brief Numbers per measured run. Fits L2, so Fill cases measure generation rather than memory bandwidth.
+const size_t VALUES = 1 << 16;
+
+struct BenchResult {
+    std::string suite;
+    std::string name;
+    uint64_t values;
+    double seconds;
+    uint64_t valuesPerRun;
+    // heap bytes allocated by one run
+    uint64_t allocatedBytes;
+};
+
+struct BenchOptions {
+    std::string json;
+    std::string filter;
+    double minTimeMs{200};
+    uint32_t threads{std::max(1u, std::thread::hardware_concurrency())};
+};
+
+// results of every case, in run order
+std::vector<BenchResult> g_results;
+// keeps generated values observable so the optimizer cannot drop them
+volatile uint64_t g_sink = 0;
+
+/// \brief Run fn() until options.minTimeMs elapsed, after one warmup run which also counts allocations
+void Measure(const BenchOptions& options, const std::string& suite, const std::string& name, uint64_t valuesPerRun,
+    const std::function<void()>& fn)
+{
+    if (!options.filter.empty() && (suite + " " + name).find(options.filter) == std::string::npos) {
+        return;
+    }
+
+    const uint64_t allocatedBefore = g_allocatedBytes.load();
+    fn();
+    const uint64_t allocated = g_allocatedBytes.load() - allocatedBefore;
+
+    typedef std::chrono::steady_clock Clock;
+    const auto minTime = std::chrono::duration<double, std::milli>(options.minTimeMs);
+    uint64_t runs = 0;
+    const auto start = Clock::now();
+    auto elapsed = Clock::now() - start;
+    while (elapsed < minTime) {
+        fn();
+        runs++;
+        elapsed = Clock::now() - start;
+    }
+
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    g_results.push_back({ suite, name, runs * valuesPerRun, seconds, valuesPerRun, allocated });
+    const BenchResult& r = g_results.back();
+    std::cout << std::left << std::setw(16) << suite << std::setw(44) << name << std::right
+              << std::setw(16) << std::fixed << std::setprecision(0) << r.values / r.seconds << " values/sec"
+              << std::setw(10) << std::setprecision(2) << r.seconds * 1e9 / r.values << " ns/value"
+              << std::setw(10) << std::setprecision(3) << double(r.allocatedBytes) / valuesPerRun << " bytes/value" << std::endl;
+}
+
+/// \brief XOR of out into the sink
+template<class T>
+void Sink(const std::vector<T>& out)
+{
+    uint64_t x = 0;
+    for (const T& v : out) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(T));
+        x ^= bits;
+    }
+    g_sink = g_sink ^ x;
+}
+
+template<class T, class GENERATOR, class DISTRIBUTION>
+void FillCase(const BenchOptions& options, const std::string& suite, const std::string& name, GENERATOR& generator,
+    DISTRIBUTION distribution)
+{
+    std::vector<T> out(VALUES);
+    Measure(options, suite, name, VALUES, [&] {
+        distribution.Fill(generator, out.data(), out.size());
+        Sink(out);
+    });
+}
+
+/// \brief Every case of one engine
+template<class GENERATOR>
+void RunEngine(const BenchOptions& options, const std::string& suite)
+{
+    GENERATOR generator(10);
+
+    Measure(options, suite, "raw engine output", VALUES, [&] {
+        uint64_t x = 0;
+        for (size_t i = 0; i < VALUES; i++) {
+            x ^= generator();
+        }
+        g_sink = g_sink ^ x;
+    });
+
+    NodeRNGUniformDistribution<int64_t> uniform(-1000, 1000);
+    Measure(options, suite, "UniformInt int64 per call", VALUES, [&] {
+        uint64_t x = 0;
+        for (size_t i = 0; i < VALUES; i++) {
+            x ^= static_cast<uint64_t>(uniform(generator));
+        }
+        g_sink = g_sink ^ x;
+    });
+
+    FillCase<int64_t>(options, suite, "UniformInt int64 Fill", generator, NodeRNGUniformDistribution<int64_t>(-1000, 1000));
+    FillCase<int32_t>(options, suite, "UniformInt int32 Fill", generator, NodeRNGUniformDistribution<int32_t>(-1000, 1000));
+    FillCase<int64_t>(options, suite, "UniformInt int64 full range Fill", generator, NodeRNGUniformDistribution<int64_t>());
+    FillCase<double>(options, suite, "Uniform float64 Fill", generator, NodeRNGUniformDistribution<double>(0, 1));
+    FillCase<float>(options, suite, "Uniform float32 Fill", generator, NodeRNGUniformDistribution<float>(0, 1));
+    FillCase<double>(options, suite, "Normal Fill", generator, NodeNormalDistribution(0, 1));
+    FillCase<double>(options, suite, "Exponential Fill", generator, NodeExponentialDistribution(1));
+    FillCase<int64_t>(options, suite, "Poisson(10) Fill", generator, NodePoissonDistribution(10));
+
+    // parallel sequence, large enough to split into blocks
+    const size_t parallelValues = size_t(PARALLEL_BLOCK_SIZE) * 64;
+    std::vector<int64_t> parallel(parallelValues);
+    NodeRNGUniformDistribution<int64_t> parallelUniform(-1000, 1000);
+    Measure(options, suite, "ParallelFill int64 (threads: " + std::to_string(options.threads) + ")", parallelValues, [&] {
+        ParallelFill<int64_t, GENERATOR>(10, options.threads, parallelUniform, parallel.data(), parallel.size());
+        Sink(parallel);
+    });
+}
+
+/// \brief Rounds of a parallel stream: one block per thread per round, at 1, 2, 4 .. options.threads threads. Threads
+///        started per round (ParallelFor) against threads reused by every round (ParallelTeam, as streams do).
+template<class GENERATOR>
+void RunParallelRounds(const BenchOptions& options, const std::string& suite)
+{
+    const size_t rounds = 4;
+    NodeRNGUniformDistribution<int64_t> uniform(-1000, 1000);
+    for (uint32_t threads = 1; ; threads = std::min(threads * 2, options.threads)) {
+        std::vector<int64_t> blocks(size_t(PARALLEL_BLOCK_SIZE) * threads);
+        const uint64_t valuesPerRun = rounds * blocks.size();
+        auto block = [&blocks, &uniform] (size_t b) {
+            GenerateBlock<int64_t, GENERATOR>(10, b, uniform, blocks.data() + b * PARALLEL_BLOCK_SIZE, PARALLEL_BLOCK_SIZE);
+        };
+
+        Measure(options, suite, "stream rounds ParallelFor (threads: " + std::to_string(threads) + ")", valuesPerRun, [&] {
+            for (size_t r = 0; r < rounds; r++) {
+                ParallelFor(threads, threads, block);
+            }
+            Sink(blocks);
+        });
+
+        ParallelTeam team(threads);
+        Measure(options, suite, "stream rounds ParallelTeam (threads: " + std::to_string(threads) + ")", valuesPerRun, [&] {
+            for (size_t r = 0; r < rounds; r++) {
+                team.For(threads, block);
+            }
+            Sink(blocks);
+        });
+
+        if (threads == options.threads) {
+            break;
+        }
+    }
+}
+
+void WriteJson(const BenchOptions& options)
+{
+    std::ofstream out(options.json);
+    out << "{\n  \"suite\": \"native\",\n  \"date\": " << std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() << ",\n  \"results\": [";
+    for (size_t i = 0; i < g_results.size(); i++) {
+        const BenchResult& r = g_results[i];
+        out << (i == 0 ? "\n" : ",\n") << std::setprecision(6)
+            << "    { \"suite\": \"" << r.suite << "\", \"name\": \"" << r.name << "\", \"values\": " << r.values
+            << ", \"seconds\": " << r.seconds << ", \"valuesPerSec\": " << r.values / r.seconds
+            << ", \"nsPerValue\": " << r.seconds * 1e9 / r.values
+            << ", \"bytesPerValue\": " << double(r.allocatedBytes) / r.valuesPerRun << " }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--json") {
+            options.json = argv[i + 1];
+        }
+        else if (flag == "--min-time") {
+            options.minTimeMs = std::atof(argv[i + 1]);
+        }
+        else if (flag == "--filter") {
+            options.filter = argv[i + 1];
+        }
+        else if (flag == "--threads") {
+            options.threads = static_cast<uint32_t>(std::max(1, std::atoi(argv[i + 1])));
+        }
+        else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    RunEngine<std::mt19937>(options, "mt19937");
+    RunEngine<std::mt19937_64>(options, "mt19937_64");
+    RunEngine<philox4x32>(options, "philox4x32");
+    RunEngine<threefry4x64>(options, "threefry4x64");
+    RunEngine<xoshiro256ss>(options, "xoshiro256ss");
+    RunEngine<pcg64>(options, "pcg64");
+    RunEngine<splitmix64>(options, "splitmix64");
+
+    // a slow and two fast engines, where starting threads costs the most against generating a block
+    RunParallelRounds<std::mt19937>(options, "mt19937");
+    RunParallelRounds<philox4x32>(options, "philox4x32");
+    RunParallelRounds<splitmix64>(options, "splitmix64");
+
+    if (!options.json.empty()) {
+        WriteJson(options);
+        std::cout << "Wrote " << options.json << std::endl;
+    }
+    return 0;
+}
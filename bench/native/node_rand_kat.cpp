@@ -0,0 +1,173 @@
+/**
+ * Known answer tests of the counter based engines, without N-API. Built by binding.gyp next to node_rand_bench when
+ * node_rand_bench=1, see README.
+ *
+ * Runs the Random123 kat_vectors of philox4x32-10 and threefry4x64-20 through the block function of every lane type
+ * compiled in (scalar, SSE2, AVX2 with -Dnode_rand_avx2=1), and the zero vectors through the engines' generate().
+ * Then checks that every lane type, generate() and operator() agree over a multi batch run across the 2^32 block
+ * boundary, where the 64 bit block counter carries into the second Philox counter word.
+ *
+ *   node_rand_kat
+ */
+
+#include "NodeEngines.h"
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace node_rand;
+
+namespace {
+
+/// \brief Random123 kat_vectors line: counter words, key words, expected output words
+template<class UINT, size_t KEY>
+struct KnownAnswer {
+    std::array<UINT, 4> counter;
+    std::array<UINT, KEY> key;
+    std::array<UINT, 4> expected;
+};
+
+const KnownAnswer<uint32_t, 2> PHILOX4X32_10[] = {
+    { { 0x00000000, 0x00000000, 0x00000000, 0x00000000 }, { 0x00000000, 0x00000000 },
+      { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } },
+    { { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff },
+      { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } },
+    { { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 },
+      { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } },
+};
+
+const KnownAnswer<uint64_t, 4> THREEFRY4X64_20[] = {
+    { { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 },
+      { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 },
+      { 0x09218ebde6c85537, 0x55941f5266d86105, 0x4bd25e16282434dc, 0xee29ec846bd2e40b } },
+    { { 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff },
+      { 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff },
+      { 0x29c24097942bba1b, 0x0371bbfb0f6f4e11, 0x3c231ffa33f83a1c, 0xcd29113fde32d168 } },
+    // key word 2 repeats word 1, as in kat_vectors
+    { { 0x243f6a8885a308d3, 0x13198a2e03707344, 0xa4093822299f31d0, 0x082efa98ec4e6c89 },
+      { 0x452821e638d01377, 0xbe5466cf34e90c6c, 0xbe5466cf34e90c6c, 0xc0ac29b7c97c50dd },
+      { 0xa7e8fde591651bd9, 0xbaafd0c30138319b, 0x84a5c1a729e685b9, 0x901d406ccebc1ba4 } },
+};
+
+int g_failures = 0;
+
+template<class UINT>
+void Check(const std::string& name, const UINT* actual, const UINT* expected, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (actual[i] != expected[i]) {
+            std::cout << "FAIL " << name << ": word " << i << " is 0x" << std::hex << uint64_t(actual[i])
+                      << ", expected 0x" << uint64_t(expected[i]) << std::dec << std::endl;
+            g_failures++;
+            return;
+        }
+    }
+    std::cout << "ok   " << name << std::endl;
+}
+
+/// \brief Every vector through lanes L. Lane 0 holds the vector's counter, the other lanes count on from it.
+template<class L>
+void PhiloxKnownAnswers(const std::string& lanes)
+{
+    for (size_t v = 0; v < sizeof(PHILOX4X32_10) / sizeof(PHILOX4X32_10[0]); v++) {
+        const KnownAnswer<uint32_t, 2>& kat = PHILOX4X32_10[v];
+        const uint64_t first = kat.counter[0] | uint64_t(kat.counter[1]) << 32;
+        std::vector<uint32_t> out(4 * L::Lanes);
+        philox4x32::Blocks<L>(kat.key, first, L::Lanes, out.data(), { kat.counter[2], kat.counter[3] });
+        Check("philox4x32-10 kat " + std::to_string(v) + " " + lanes, out.data(), kat.expected.data(), 4);
+    }
+}
+
+template<class L>
+void ThreefryKnownAnswers(const std::string& lanes)
+{
+    for (size_t v = 0; v < sizeof(THREEFRY4X64_20) / sizeof(THREEFRY4X64_20[0]); v++) {
+        const KnownAnswer<uint64_t, 4>& kat = THREEFRY4X64_20[v];
+        std::vector<uint64_t> out(4 * L::Lanes);
+        threefry4x64::Blocks<L>(kat.key, kat.counter[0], L::Lanes, out.data(), { kat.counter[1], kat.counter[2], kat.counter[3] });
+        Check("threefry4x64-20 kat " + std::to_string(v) + " " + lanes, out.data(), kat.expected.data(), 4);
+    }
+}
+
+/// \brief The engines key with the seed and count blocks from 0, so the zero vectors are the first outputs of seed 0
+void EngineKnownAnswers()
+{
+    std::array<uint32_t, 4> philox;
+    philox4x32(0).generate(philox.data(), philox.size());
+    Check("philox4x32-10 kat 0 generate()", philox.data(), PHILOX4X32_10[0].expected.data(), 4);
+
+    std::array<uint64_t, 4> threefry;
+    threefry4x64(0).generate(threefry.data(), threefry.size());
+    Check("threefry4x64-20 kat 0 generate()", threefry.data(), THREEFRY4X64_20[0].expected.data(), 4);
+}
+
+/// \brief Lanes L against scalar lanes, generate() and operator() over several batches from an unaligned position
+///        a few blocks before block 2^32
+/// \param key the key ENGINE(seed) derives
+template<class ENGINE, class L, class SCALAR, class KEY>
+void CrossLanes(const std::string& engine, const std::string& lanes, uint64_t seed, const KEY& key)
+{
+    typedef typename ENGINE::result_type UINT;
+    const uint64_t firstBlock = (uint64_t(1) << 32) - 37;
+    // 83 blocks, not a multiple of any lane count
+    const size_t blocks = 83;
+
+    std::vector<UINT> scalar(4 * blocks);
+    std::vector<UINT> vector(4 * blocks);
+    ENGINE::template Blocks<SCALAR>(key, firstBlock, blocks, scalar.data());
+    ENGINE::template Blocks<L>(key, firstBlock, blocks, vector.data());
+    Check(engine + " " + lanes + " lanes match scalar lanes across block 2^32", vector.data(), scalar.data(), scalar.size());
+
+    // generate() from 3 words into the first block, leaving an unaligned tail
+    const size_t skip = 3;
+    const size_t n = scalar.size() - skip - 2;
+    ENGINE generated(seed);
+    generated.discard(firstBlock * 4 + skip);
+    std::vector<UINT> out(n);
+    generated.generate(out.data(), n);
+    Check(engine + " generate() matches scalar lanes across block 2^32", out.data(), scalar.data() + skip, n);
+
+    ENGINE called(seed);
+    called.discard(firstBlock * 4 + skip);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = called();
+    }
+    Check(engine + " operator() matches scalar lanes across block 2^32", out.data(), scalar.data() + skip, n);
+}
+
+template<class L32, class L64>
+void RunLanes(const std::string& lanes)
+{
+    PhiloxKnownAnswers<L32>(lanes);
+    ThreefryKnownAnswers<L64>(lanes);
+    const uint64_t seed = 0x0123456789abcdefULL;
+    // philox keys with the seed, threefry with the seed as key word 0
+    CrossLanes<philox4x32, L32, engine_lanes::ScalarU32>("philox4x32", lanes, seed,
+        std::array<uint32_t, 2>{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) });
+    CrossLanes<threefry4x64, L64, engine_lanes::ScalarU64>("threefry4x64", lanes, seed, std::array<uint64_t, 4>{ seed, 0, 0, 0 });
+}
+
+}
+
+int main()
+{
+    RunLanes<engine_lanes::ScalarU32, engine_lanes::ScalarU64>("scalar");
+#ifdef NODE_RAND_SSE2
+    RunLanes<engine_lanes::Sse2U32, engine_lanes::Sse2U64>("sse2");
+#endif
+#ifdef NODE_RAND_AVX2
+    RunLanes<engine_lanes::Avx2U32, engine_lanes::Avx2U64>("avx2");
+#endif
+    EngineKnownAnswers();
+
+    if (g_failures > 0) {
+        std::cout << g_failures << " failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all passed" << std::endl;
+    return 0;
+}
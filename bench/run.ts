@@ -0,0 +1,20 @@
+import * as generateInto from './generate_into.bench'
+import * as chunkSize from './chunk_size.bench'
+import * as calls from './calls.bench'
+import * as distributions from './distributions.bench'
+import { writeJson } from './harness'
+
+const benches = [calls, generateInto, distributions, chunkSize];
+
+// ts-node bench/run.ts [--json path]
+const jsonFlag = process.argv.indexOf('--json');
+const jsonPath = jsonFlag >= 0 ? process.argv[jsonFlag + 1] : undefined;
+
+(async () => {
+    for (const bench of benches) {
+        await bench.run();
+    }
+    if (jsonPath) {
+        writeJson(jsonPath);
+    }
+})();
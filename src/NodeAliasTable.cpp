@@ -0,0 +1,102 @@
+#include "NodeAliasTable.h"
+
+#include <assert.h>
+#include <cmath>
+#include <limits>
+
+using namespace node_rand;
+
+const char* NodeAliasTable::Check(const std::vector<double>& weights)
+{
+    if (weights.empty() || weights.size() > std::numeric_limits<uint32_t>::max()) {
+        return "Discrete expects between 1 and 2^32 - 1 weights";
+    }
+    double sum = 0;
+    for (double w : weights) {
+        if (!std::isfinite(w) || w < 0) {
+            return "Discrete expects finite weights >= 0";
+        }
+        sum += w;
+    }
+    if (!(sum > 0) || !std::isfinite(sum)) {
+        return "Discrete expects weights with a positive, finite sum";
+    }
+    return nullptr;
+}
+
+NodeAliasTable::NodeAliasTable(const std::vector<double>& weights) : m_columns(weights.size())
+{
+    assert(Check(weights) == nullptr);
+    const size_t n = weights.size();
+    double sum = 0;
+    for (double w : weights) {
+        sum += w;
+    }
+
+    // scaled[i] = n * p(i). work holds the small (< 1) stack at the front and the large stack at the back.
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> work(n);
+    size_t small = 0, large = n;
+    for (size_t i = 0; i < n; i++) {
+        scaled[i] = weights[i] * n / sum;
+        if (scaled[i] < 1) {
+            work[small++] = static_cast<uint32_t>(i);
+        }
+        else {
+            work[--large] = static_cast<uint32_t>(i);
+        }
+    }
+
+    while (small > 0 && large < n) {
+        const uint32_t s = work[--small];
+        const uint32_t l = work[large++];
+        m_columns[s].threshold = static_cast<uint32_t>(scaled[s] * 0x1.0p32);
+        m_columns[s].alias = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1;
+        if (scaled[l] < 1) {
+            work[small++] = l;
+        }
+        else {
+            work[--large] = l;
+        }
+    }
+
+    // left over columns are 1 up to rounding
+    for (size_t i = 0; i < small; i++) {
+        m_columns[work[i]] = { std::numeric_limits<uint32_t>::max(), work[i] };
+    }
+    for (size_t i = large; i < n; i++) {
+        m_columns[work[i]] = { std::numeric_limits<uint32_t>::max(), work[i] };
+    }
+}
+
+NodeAliasTableRegistry& NodeAliasTableRegistry::Instance()
+{
+    // Never destroyed, tables can be released by worker envs torn down after static destructors
+    static NodeAliasTableRegistry* registry = new NodeAliasTableRegistry();
+    return *registry;
+}
+
+uint32_t NodeAliasTableRegistry::Add(const std::shared_ptr<const NodeAliasTable>& table)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // tables are built rarely, drop freed ones here instead of tracking destruction
+    for (auto it = m_tables.begin(); it != m_tables.end();) {
+        it = it->second.expired() ? m_tables.erase(it) : std::next(it);
+    }
+
+    uint32_t id = m_nextId++;
+    while (id == 0 || m_tables.count(id) > 0) {
+        id = m_nextId++;
+    }
+    m_tables[id] = table;
+    return id;
+}
+
+std::shared_ptr<const NodeAliasTable> NodeAliasTableRegistry::Find(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_tables.find(id);
+    return it == m_tables.end() ? nullptr : it->second.lock();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace node_rand {
+
+/// \class NodeAliasTable
+/// \brief Walker alias table over n weights, built with Vose's method. Immutable once built, safe to share between threads.
+/// \note 8 bytes per weight. Column i is kept when a uniform 32 bit coin is below its threshold, otherwise its alias is returned.
+class NodeAliasTable {
+public:
+    struct Column {
+        // P(keep column) * 2^32, saturated. Columns kept with probability 1 alias themselves
+        uint32_t threshold;
+        uint32_t alias;
+    };
+
+    /// \brief Weights must be finite, >= 0 with a positive finite sum, between 1 and 2^32 - 1 of them
+    /// \return error message, nullptr if valid
+    static const char* Check(const std::vector<double>& weights);
+
+    /// \brief Build the table. Weights must pass Check.
+    explicit NodeAliasTable(const std::vector<double>& weights);
+
+    size_t size() const { return m_columns.size(); }
+
+    const Column& operator[](uint32_t i) const { return m_columns[i]; }
+
+private:
+    std::vector<Column> m_columns;
+};
+
+/// \class NodeAliasTableRegistry
+/// \brief Process wide id -> table map, lets any thread (eg: a worker_threads Worker) attach to a table built elsewhere.
+/// \note Thread-safe. Holds weak references, a table is freed with its last handle and its id stops resolving.
+class NodeAliasTableRegistry {
+    std::mutex m_mutex;
+    std::unordered_map<uint32_t, std::weak_ptr<const NodeAliasTable>> m_tables;
+    uint32_t m_nextId{1};
+
+    NodeAliasTableRegistry() = default;
+
+public:
+    NodeAliasTableRegistry(const NodeAliasTableRegistry&) = delete;
+    NodeAliasTableRegistry& operator=(const NodeAliasTableRegistry&) = delete;
+
+    /// \brief Singleton instance
+    static NodeAliasTableRegistry& Instance();
+
+    /// \brief Register table
+    /// \return id of table, never 0
+    uint32_t Add(const std::shared_ptr<const NodeAliasTable>& table);
+
+    /// \brief Table registered as id
+    /// \return nullptr if id is unknown or its table was freed
+    std::shared_ptr<const NodeAliasTable> Find(uint32_t id);
+};
+
+}
@@ -0,0 +1,55 @@
+#include "NodeBufferPool.h"
+
+#include <new>
+
+using namespace node_rand;
+
+NodeBufferPool& NodeBufferPool::Instance()
+{
+    // Never destroyed. External ArrayBuffers can be finalized during env teardown, after static destructors.
+    static NodeBufferPool* pool = new NodeBufferPool();
+    return *pool;
+}
+
+size_t NodeBufferPool::Bucket(size_t bytes)
+{
+    size_t bucket = 0;
+    while ((size_t(1) << bucket) < bytes) {
+        bucket++;
+    }
+    return bucket;
+}
+
+void* NodeBufferPool::Acquire(size_t bytes)
+{
+    const size_t bucket = Bucket(bytes);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& free = m_free[bucket];
+        if (!free.empty()) {
+            void* buffer = free.back();
+            free.pop_back();
+            return buffer;
+        }
+    }
+    return ::operator new(size_t(1) << bucket);
+}
+
+void NodeBufferPool::Release(void* buffer, size_t bytes)
+{
+    const size_t bucket = Bucket(bytes);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& free = m_free[bucket];
+        if (free.size() < MaxFreePerBucket) {
+            free.push_back(buffer);
+            return;
+        }
+    }
+    ::operator delete(buffer);
+}
+
+void NodeBufferPool::Finalize(napi_env env, void* finalize_data, void* finalize_hint)
+{
+    Instance().Release(finalize_data, reinterpret_cast<size_t>(finalize_hint));
+}
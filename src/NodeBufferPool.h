@@ -0,0 +1,44 @@
+#include <node_api.h>
+#include <array>
+#include <vector>
+#include <mutex>
+
+#pragma once
+
+namespace node_rand {
+
+/// \brief Process wide pool of raw buffers handed to JS as external ArrayBuffers.
+/// \note Thread-safe. Buffers are bucketed by power of two capacity so chunks of any size can be reused.
+class NodeBufferPool {
+    // max number of free buffers kept per bucket, anything above is freed
+    static const size_t MaxFreePerBucket{16};
+    // buckets of 2^i bytes
+    static const size_t BucketCount{48};
+
+    std::mutex m_mutex;
+    std::array<std::vector<void*>, BucketCount> m_free;
+
+    /// \brief Bucket index for a buffer of size bytes
+    static size_t Bucket(size_t bytes);
+
+    NodeBufferPool() = default;
+
+public:
+    NodeBufferPool(const NodeBufferPool&) = delete;
+    NodeBufferPool& operator=(const NodeBufferPool&) = delete;
+
+    /// \brief Singleton instance
+    static NodeBufferPool& Instance();
+
+    /// \brief Get a buffer of at least size bytes
+    void* Acquire(size_t bytes);
+
+    /// \brief Return a buffer acquired with the same size bytes
+    void Release(void* buffer, size_t bytes);
+
+    /// \brief napi_finalize for external ArrayBuffers backed by pool memory
+    /// \param finalize_hint size in bytes passed to Acquire
+    static void Finalize(napi_env env, void* finalize_data, void* finalize_hint);
+};
+
+}
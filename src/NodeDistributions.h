@@ -0,0 +1,659 @@
+#pragma once
+
+#include "NodeAliasTable.h"
+#include "NodeRNG.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace node_rand {
+
+/**
+ * Non-uniform distributions
+ *
+ * Same interface as NodeUniformIntDistribution: result_type, operator()(generator), Fill(generator, out, n), min(), max().
+ * Every draw is built from rng_bits::Next64/NextDouble, so a seed gives the same sequence for a given engine no matter
+ * which standard library is used. Results go through exp/log/sqrt, last bit reproducibility across libm
+ * implementations is not guaranteed.
+ *
+ * Parameters are validated by the static Check(...), which returns an error message or nullptr.
+ * Constructors assume valid parameters and precompute everything the sampling loop needs.
+ *
+ *  - Normal, LogNormal, Exponential: 256 layer Ziggurat (Marsaglia & Tsang 2000), exact tails
+ *  - Gamma: Marsaglia & Tsang 2000 on top of the normal Ziggurat
+ *  - Poisson: multiplication method below mean 10, PTRS transformed rejection above (Hörmann 1993)
+ *  - Binomial: inversion below n * p 10, BTRS transformed rejection above (Hörmann 1993)
+ *  - Discrete: Walker/Vose alias table, O(1) per number
+ */
+
+namespace distribution_detail {
+
+/// \brief Fill(generator, out, n) as n calls to D::operator()
+template<class D, class T>
+struct ScalarFill {
+    template<class GENERATOR>
+    void Fill(GENERATOR& generator, T* out, size_t n) const {
+        const D& d = static_cast<const D&>(*this);
+        for (size_t i = 0; i < n; i++) {
+            out[i] = d(generator);
+        }
+    }
+};
+
+/// \brief Uniform double in (0, 1], safe for log()
+template<class GENERATOR>
+double NextOpenDouble(GENERATOR& generator) {
+    return 1.0 - rng_bits::NextDouble(generator);
+}
+
+/// \brief Ziggurat tables, built once on first use
+struct ZigguratTables {
+    static const int Layers = 256;
+
+    // normal: x = rabs * wn[i], accept quickly if rabs < kn[i]. rabs has 52 bits
+    uint64_t kn[Layers];
+    double wn[Layers];
+    double fn[Layers];
+    // exponential: same with 53 bit draws
+    uint64_t ke[Layers];
+    double we[Layers];
+    double fe[Layers];
+
+    // start of the tail, and area of each layer
+    static constexpr double NormalR = 3.6541528853610088;
+    static constexpr double NormalV = 0.00492867323399;
+    static constexpr double ExponentialR = 7.69711747013104972;
+    static constexpr double ExponentialV = 0.0039496598225815571993;
+
+    static const ZigguratTables& Instance() {
+        static const ZigguratTables tables;
+        return tables;
+    }
+
+private:
+    ZigguratTables() {
+        const double m1 = 0x1.0p52;
+        double dn = NormalR, tn = dn;
+        const double qn = NormalV / std::exp(-0.5 * dn * dn);
+        kn[0] = static_cast<uint64_t>((dn / qn) * m1);
+        kn[1] = 0;
+        wn[0] = qn / m1;
+        wn[Layers - 1] = dn / m1;
+        fn[0] = 1.0;
+        fn[Layers - 1] = std::exp(-0.5 * dn * dn);
+        for (int i = Layers - 2; i >= 1; i--) {
+            dn = std::sqrt(-2.0 * std::log(NormalV / dn + std::exp(-0.5 * dn * dn)));
+            kn[i + 1] = static_cast<uint64_t>((dn / tn) * m1);
+            tn = dn;
+            fn[i] = std::exp(-0.5 * dn * dn);
+            wn[i] = dn / m1;
+        }
+
+        const double m2 = 0x1.0p53;
+        double de = ExponentialR, te = de;
+        const double qe = ExponentialV / std::exp(-de);
+        ke[0] = static_cast<uint64_t>((de / qe) * m2);
+        ke[1] = 0;
+        we[0] = qe / m2;
+        we[Layers - 1] = de / m2;
+        fe[0] = 1.0;
+        fe[Layers - 1] = std::exp(-de);
+        for (int i = Layers - 2; i >= 1; i--) {
+            de = -std::log(ExponentialV / de + std::exp(-de));
+            ke[i + 1] = static_cast<uint64_t>((de / te) * m2);
+            te = de;
+            fe[i] = std::exp(-de);
+            we[i] = de / m2;
+        }
+    }
+};
+
+/// \brief Standard normal, one Next64 per number except for the ~1% of draws outside the rectangles
+template<class GENERATOR>
+double StandardNormal(GENERATOR& generator) {
+    const ZigguratTables& z = ZigguratTables::Instance();
+    while (true) {
+        uint64_t r = rng_bits::Next64(generator);
+        const int i = static_cast<int>(r & 0xFF);
+        r >>= 8;
+        const bool negative = (r & 1) != 0;
+        const uint64_t rabs = (r >> 1) & 0x000FFFFFFFFFFFFFull;
+        double x = static_cast<double>(rabs) * z.wn[i];
+        if (negative) {
+            x = -x;
+        }
+        if (rabs < z.kn[i]) {
+            return x;
+        }
+        if (i == 0) {
+            // tail beyond NormalR (Marsaglia 1964)
+            while (true) {
+                const double xx = -std::log(NextOpenDouble(generator)) / ZigguratTables::NormalR;
+                const double yy = -std::log(NextOpenDouble(generator));
+                if (yy + yy > xx * xx) {
+                    return negative ? -(ZigguratTables::NormalR + xx) : ZigguratTables::NormalR + xx;
+                }
+            }
+        }
+        if ((z.fn[i - 1] - z.fn[i]) * rng_bits::NextDouble(generator) + z.fn[i] < std::exp(-0.5 * x * x)) {
+            return x;
+        }
+    }
+}
+
+/// \brief Standard exponential, one Next64 per number except for draws outside the rectangles
+template<class GENERATOR>
+double StandardExponential(GENERATOR& generator) {
+    const ZigguratTables& z = ZigguratTables::Instance();
+    while (true) {
+        uint64_t r = rng_bits::Next64(generator) >> 3;
+        const int i = static_cast<int>(r & 0xFF);
+        r >>= 8;
+        const double x = static_cast<double>(r) * z.we[i];
+        if (r < z.ke[i]) {
+            return x;
+        }
+        if (i == 0) {
+            // memoryless tail
+            return ZigguratTables::ExponentialR - std::log(NextOpenDouble(generator));
+        }
+        if ((z.fe[i - 1] - z.fe[i]) * rng_bits::NextDouble(generator) + z.fe[i] < std::exp(-x)) {
+            return x;
+        }
+    }
+}
+
+/// \brief log(Gamma(x)) for x >= 1 with a Stirling series. std::lgamma may write the global signgam, not thread safe.
+inline double LogGamma(double x) {
+    static const double a[10] = {
+        8.333333333333333e-02, -2.777777777777778e-03, 7.936507936507937e-04, -5.952380952380952e-04, 8.417508417508418e-04,
+        -1.917526917526918e-03, 6.410256410256410e-03, -2.955065359477124e-02, 1.796443723688307e-01, -1.39243221690590e+00
+    };
+    if (x == 1.0 || x == 2.0) {
+        return 0.0;
+    }
+    const int n = x < 7.0 ? static_cast<int>(7 - x) : 0;
+    double x0 = x + n;
+    const double x2 = (1.0 / x0) * (1.0 / x0);
+    double gl0 = a[9];
+    for (int k = 8; k >= 0; k--) {
+        gl0 = gl0 * x2 + a[k];
+    }
+    // 0.5 * log(2 pi)
+    double gl = gl0 / x0 + 0.91893853320467274178 + (x0 - 0.5) * std::log(x0) - x0;
+    for (int k = 1; k <= n; k++) {
+        gl -= std::log(x0 - 1.0);
+        x0 -= 1.0;
+    }
+    return gl;
+}
+
+/// \brief Stirling series tail log(k!) - (k + 1/2)log(k + 1) + (k + 1) - log(2pi)/2, used by BTRS
+inline double StirlingTail(double k) {
+    static const double table[10] = {
+        0.08106146679532726, 0.04134069595540929, 0.02767792568499834, 0.02079067210376509, 0.01664469118982119,
+        0.01387612882307075, 0.01189670994589177, 0.01041126526197209, 0.009255462182712733, 0.008330563433362871
+    };
+    if (k < 10) {
+        return table[static_cast<int>(k)];
+    }
+    const double kp1sq = (k + 1) * (k + 1);
+    return (1.0 / 12 - (1.0 / 360 - 1.0 / 1260 / kp1sq) / kp1sq) / (k + 1);
+}
+
+inline bool IsFinite(double value) {
+    return std::isfinite(value);
+}
+
+} // end distribution_detail namespace
+
+/// \class NodeNormalDistribution
+/// \brief Normal (Gaussian) with mean and stddev
+class NodeNormalDistribution : public distribution_detail::ScalarFill<NodeNormalDistribution, double> {
+    double m_mean;
+    double m_stddev;
+
+public:
+    typedef double result_type;
+
+    static const char* Check(double mean, double stddev) {
+        if (!distribution_detail::IsFinite(mean) || !distribution_detail::IsFinite(stddev) || stddev <= 0) {
+            return "Normal expects a finite mean and stddev > 0";
+        }
+        return nullptr;
+    }
+
+    NodeNormalDistribution(double mean = 0, double stddev = 1) : m_mean(mean), m_stddev(stddev) {
+        assert(Check(mean, stddev) == nullptr);
+    }
+
+    template<class GENERATOR>
+    double operator()(GENERATOR& generator) const {
+        return m_mean + m_stddev * distribution_detail::StandardNormal(generator);
+    }
+
+    double min() const { return -std::numeric_limits<double>::infinity(); }
+    double max() const { return std::numeric_limits<double>::infinity(); }
+};
+
+/// \class NodeLogNormalDistribution
+/// \brief exp(Normal(mean, stddev)), mean and stddev are of the underlying normal
+class NodeLogNormalDistribution : public distribution_detail::ScalarFill<NodeLogNormalDistribution, double> {
+    double m_mean;
+    double m_stddev;
+
+public:
+    typedef double result_type;
+
+    static const char* Check(double mean, double stddev) {
+        if (!distribution_detail::IsFinite(mean) || !distribution_detail::IsFinite(stddev) || stddev <= 0) {
+            return "LogNormal expects a finite mean and stddev > 0";
+        }
+        return nullptr;
+    }
+
+    NodeLogNormalDistribution(double mean = 0, double stddev = 1) : m_mean(mean), m_stddev(stddev) {
+        assert(Check(mean, stddev) == nullptr);
+    }
+
+    template<class GENERATOR>
+    double operator()(GENERATOR& generator) const {
+        return std::exp(m_mean + m_stddev * distribution_detail::StandardNormal(generator));
+    }
+
+    double min() const { return 0; }
+    double max() const { return std::numeric_limits<double>::infinity(); }
+};
+
+/// \class NodeExponentialDistribution
+/// \brief Exponential with rate lambda
+class NodeExponentialDistribution : public distribution_detail::ScalarFill<NodeExponentialDistribution, double> {
+    // 1 / lambda
+    double m_scale;
+
+public:
+    typedef double result_type;
+
+    static const char* Check(double lambda) {
+        if (!distribution_detail::IsFinite(lambda) || lambda <= 0) {
+            return "Exponential expects a finite lambda > 0";
+        }
+        return nullptr;
+    }
+
+    NodeExponentialDistribution(double lambda = 1) : m_scale(1.0 / lambda) {
+        assert(Check(lambda) == nullptr);
+    }
+
+    template<class GENERATOR>
+    double operator()(GENERATOR& generator) const {
+        return m_scale * distribution_detail::StandardExponential(generator);
+    }
+
+    double min() const { return 0; }
+    double max() const { return std::numeric_limits<double>::infinity(); }
+};
+
+/// \class NodeGammaDistribution
+/// \brief Gamma with shape k and scale theta. Shapes below 1 are boosted: Gamma(k + 1) * U^(1 / k)
+class NodeGammaDistribution : public distribution_detail::ScalarFill<NodeGammaDistribution, double> {
+    double m_scale;
+    // Marsaglia-Tsang constants for max(shape, shape + 1)
+    double m_d;
+    double m_c;
+    // 1 / shape when shape < 1, 0 otherwise
+    double m_boost;
+
+public:
+    typedef double result_type;
+
+    static const char* Check(double shape, double scale) {
+        if (!distribution_detail::IsFinite(shape) || !distribution_detail::IsFinite(scale) || shape <= 0 || scale <= 0) {
+            return "Gamma expects a finite shape > 0 and scale > 0";
+        }
+        return nullptr;
+    }
+
+    NodeGammaDistribution(double shape = 1, double scale = 1) : m_scale(scale) {
+        assert(Check(shape, scale) == nullptr);
+        m_boost = shape < 1 ? 1.0 / shape : 0;
+        m_d = (shape < 1 ? shape + 1 : shape) - 1.0 / 3;
+        m_c = 1.0 / std::sqrt(9 * m_d);
+    }
+
+    template<class GENERATOR>
+    double operator()(GENERATOR& generator) const {
+        double v = 0;
+        while (true) {
+            double x = 0;
+            do {
+                x = distribution_detail::StandardNormal(generator);
+                v = 1 + m_c * x;
+            } while (v <= 0);
+            v = v * v * v;
+            const double u = distribution_detail::NextOpenDouble(generator);
+            const double x2 = x * x;
+            if (u < 1 - 0.0331 * x2 * x2 || std::log(u) < 0.5 * x2 + m_d * (1 - v + std::log(v))) {
+                break;
+            }
+        }
+        double result = m_d * v;
+        if (m_boost != 0) {
+            result *= std::pow(distribution_detail::NextOpenDouble(generator), m_boost);
+        }
+        return result * m_scale;
+    }
+
+    double min() const { return 0; }
+    double max() const { return std::numeric_limits<double>::infinity(); }
+};
+
+/// \class NodePoissonDistribution
+/// \brief Poisson with mean
+class NodePoissonDistribution : public distribution_detail::ScalarFill<NodePoissonDistribution, int64_t> {
+    // PTRS is used from this mean up
+    static constexpr double RejectionMean = 10;
+
+    double m_mean{0};
+    // multiplication method: exp(-mean)
+    double m_expMean{0};
+    // PTRS constants
+    double m_logMean{0};
+    double m_a{0};
+    double m_b{0};
+    double m_logInvAlpha{0};
+    double m_vr{0};
+
+    template<class GENERATOR>
+    int64_t Multiplication(GENERATOR& generator) const {
+        int64_t k = 0;
+        double product = distribution_detail::NextOpenDouble(generator);
+        while (product > m_expMean) {
+            k++;
+            product *= distribution_detail::NextOpenDouble(generator);
+        }
+        return k;
+    }
+
+    template<class GENERATOR>
+    int64_t Ptrs(GENERATOR& generator) const {
+        while (true) {
+            const double u = rng_bits::NextDouble(generator) - 0.5;
+            const double v = distribution_detail::NextOpenDouble(generator);
+            const double us = 0.5 - std::fabs(u);
+            const double k = std::floor((2 * m_a / us + m_b) * u + m_mean + 0.43);
+            if (us >= 0.07 && v <= m_vr) {
+                return static_cast<int64_t>(k);
+            }
+            if (k < 0 || (us < 0.013 && v > us)) {
+                continue;
+            }
+            if (std::log(v) + m_logInvAlpha - std::log(m_a / (us * us) + m_b)
+                <= -m_mean + k * m_logMean - distribution_detail::LogGamma(k + 1)) {
+                return static_cast<int64_t>(k);
+            }
+        }
+    }
+
+public:
+    typedef int64_t result_type;
+
+    static const char* Check(double mean) {
+        if (!distribution_detail::IsFinite(mean) || mean < 0 || mean > 0x1.0p53) {
+            return "Poisson expects a mean between 0 and 2^53";
+        }
+        return nullptr;
+    }
+
+    NodePoissonDistribution(double mean = 1) : m_mean(mean) {
+        assert(Check(mean) == nullptr);
+        if (mean < RejectionMean) {
+            m_expMean = std::exp(-mean);
+        }
+        else {
+            m_logMean = std::log(mean);
+            m_b = 0.931 + 2.53 * std::sqrt(mean);
+            m_a = -0.059 + 0.02483 * m_b;
+            m_logInvAlpha = std::log(1.1239 + 1.1328 / (m_b - 3.4));
+            m_vr = 0.9277 - 3.6224 / (m_b - 2);
+        }
+    }
+
+    template<class GENERATOR>
+    int64_t operator()(GENERATOR& generator) const {
+        if (m_mean == 0) {
+            return 0;
+        }
+        return m_mean < RejectionMean ? Multiplication(generator) : Ptrs(generator);
+    }
+
+    int64_t min() const { return 0; }
+    int64_t max() const { return std::numeric_limits<int64_t>::max(); }
+};
+
+/// \class NodeBinomialDistribution
+/// \brief Number of successes in n trials with probability p. Sampled with p' = min(p, 1 - p) and mirrored.
+class NodeBinomialDistribution : public distribution_detail::ScalarFill<NodeBinomialDistribution, int64_t> {
+    // BTRS is used from n * p' up
+    static constexpr double RejectionMean = 10;
+
+    int64_t m_n{1};
+    double m_p{0.5};
+    // p > 0.5, return n - k
+    bool m_mirror{false};
+    // inversion constants
+    double m_q{0};
+    double m_qn{0};
+    double m_bound{0};
+    // BTRS constants
+    double m_m{0};
+    double m_r{0};
+    double m_nr{0};
+    double m_npq{0};
+    double m_a{0};
+    double m_b{0};
+    double m_c{0};
+    double m_alpha{0};
+    double m_vr{0};
+    double m_urvr{0};
+    double m_h{0};
+
+    template<class GENERATOR>
+    int64_t Inversion(GENERATOR& generator) const {
+        int64_t x = 0;
+        double px = m_qn;
+        double u = rng_bits::NextDouble(generator);
+        while (u > px) {
+            x++;
+            if (x > m_bound) {
+                x = 0;
+                px = m_qn;
+                u = rng_bits::NextDouble(generator);
+            }
+            else {
+                u -= px;
+                px = ((m_n - x + 1) * m_p * px) / (x * m_q);
+            }
+        }
+        return x;
+    }
+
+    template<class GENERATOR>
+    int64_t Btrs(GENERATOR& generator) const {
+        const double n = static_cast<double>(m_n);
+        while (true) {
+            double v = rng_bits::NextDouble(generator);
+            double u = 0;
+            if (v <= m_urvr) {
+                u = v / m_vr - 0.43;
+                return static_cast<int64_t>(std::floor((2 * m_a / (0.5 - std::fabs(u)) + m_b) * u + m_c));
+            }
+            if (v >= m_vr) {
+                u = rng_bits::NextDouble(generator) - 0.5;
+            }
+            else {
+                u = v / m_vr - 0.93;
+                u = (u < 0 ? -0.5 : 0.5) - u;
+                v = rng_bits::NextDouble(generator) * m_vr;
+            }
+
+            const double us = 0.5 - std::fabs(u);
+            const double k = std::floor((2 * m_a / us + m_b) * u + m_c);
+            if (k < 0 || k > n) {
+                continue;
+            }
+            v = v * m_alpha / (m_a / (us * us) + m_b);
+            const double km = std::fabs(k - m_m);
+
+            if (km <= 15) {
+                // f(k) / f(m) by recursion
+                double f = 1;
+                if (m_m < k) {
+                    for (double i = m_m + 1; i <= k; i++) {
+                        f *= m_nr / i - m_r;
+                    }
+                }
+                else {
+                    for (double i = k + 1; i <= m_m; i++) {
+                        v *= m_nr / i - m_r;
+                    }
+                }
+                if (v <= f) {
+                    return static_cast<int64_t>(k);
+                }
+                continue;
+            }
+
+            // squeeze, then the exact log test
+            v = std::log(v);
+            const double rho = (km / m_npq) * (((km / 3 + 0.625) * km + 1.0 / 6) / m_npq + 0.5);
+            const double t = -km * km / (2 * m_npq);
+            if (v < t - rho) {
+                return static_cast<int64_t>(k);
+            }
+            if (v > t + rho) {
+                continue;
+            }
+            const double nk = n - k + 1;
+            if (v <= m_h + (n + 1) * std::log((n - m_m + 1) / nk) + (k + 0.5) * std::log(nk * m_r / (k + 1))
+                - distribution_detail::StirlingTail(k) - distribution_detail::StirlingTail(n - k)) {
+                return static_cast<int64_t>(k);
+            }
+        }
+    }
+
+public:
+    typedef int64_t result_type;
+
+    static const char* Check(double n, double p) {
+        if (!distribution_detail::IsFinite(n) || n < 0 || n > 0x1.0p53 || n != std::floor(n)
+            || !distribution_detail::IsFinite(p) || p < 0 || p > 1) {
+            return "Binomial expects an integer n between 0 and 2^53 and p between 0 and 1";
+        }
+        return nullptr;
+    }
+
+    NodeBinomialDistribution(double n = 1, double p = 0.5) : m_n(static_cast<int64_t>(n)), m_mirror(p > 0.5) {
+        assert(Check(n, p) == nullptr);
+        m_p = m_mirror ? 1 - p : p;
+        m_q = 1 - m_p;
+        const double np = n * m_p;
+        if (np < RejectionMean) {
+            m_qn = std::exp(n * std::log1p(-m_p));
+            m_bound = std::min(n, np + 10 * std::sqrt(np * m_q + 1));
+        }
+        else {
+            m_m = std::floor((n + 1) * m_p);
+            m_r = m_p / m_q;
+            m_nr = (n + 1) * m_r;
+            m_npq = np * m_q;
+            const double spq = std::sqrt(m_npq);
+            m_b = 1.15 + 2.53 * spq;
+            m_a = -0.0873 + 0.0248 * m_b + 0.01 * m_p;
+            m_c = np + 0.5;
+            m_alpha = (2.83 + 5.1 / m_b) * spq;
+            m_vr = 0.92 - 4.2 / m_b;
+            m_urvr = 0.86 * m_vr;
+            m_h = (m_m + 0.5) * std::log((m_m + 1) / (m_r * (n - m_m + 1)))
+                + distribution_detail::StirlingTail(m_m) + distribution_detail::StirlingTail(n - m_m);
+        }
+    }
+
+    template<class GENERATOR>
+    int64_t operator()(GENERATOR& generator) const {
+        if (m_n == 0 || m_p == 0) {
+            return m_mirror ? m_n : 0;
+        }
+        const int64_t k = m_n * m_p < RejectionMean ? Inversion(generator) : Btrs(generator);
+        return m_mirror ? m_n - k : k;
+    }
+
+    int64_t min() const { return 0; }
+    int64_t max() const { return m_n; }
+};
+
+/// \class NodeDiscreteDistribution
+/// \brief Index i with probability weights[i] / sum(weights). One uniform column and one 32 bit coin per number.
+/// \note The alias table is shared between copies, streams and parallel blocks copy the distribution freely.
+///       Tables built once with AliasTable.Build are shared by every handle created from them.
+class NodeDiscreteDistribution {
+    // numbers drawn per Fill block before their columns are read
+    static const size_t FillBlock = 64;
+
+    std::shared_ptr<const NodeAliasTable> m_table;
+    NodeUniformIntDistribution<uint32_t> m_column;
+
+public:
+    typedef uint32_t result_type;
+
+    static const char* Check(const std::vector<double>& weights) {
+        return NodeAliasTable::Check(weights);
+    }
+
+    NodeDiscreteDistribution() : NodeDiscreteDistribution(std::vector<double>{1}) {}
+
+    explicit NodeDiscreteDistribution(const std::vector<double>& weights)
+        : NodeDiscreteDistribution(std::make_shared<const NodeAliasTable>(weights)) {}
+
+    /// \brief Sample a prebuilt table, not copied
+    explicit NodeDiscreteDistribution(std::shared_ptr<const NodeAliasTable> table)
+        : m_table(std::move(table)), m_column(0, static_cast<uint32_t>(m_table->size() - 1)) {}
+
+    template<class GENERATOR>
+    uint32_t operator()(GENERATOR& generator) const {
+        const uint32_t i = m_column(generator);
+        const NodeAliasTable::Column& column = (*m_table)[i];
+        return rng_bits::Next32(generator) < column.threshold ? i : column.alias;
+    }
+
+    /// \brief Same sequence as n calls to operator(). Columns and coins of a block are drawn first and their
+    ///        columns prefetched, so table lookups overlap instead of stalling one by one.
+    template<class GENERATOR>
+    void Fill(GENERATOR& generator, uint32_t* out, size_t n) const {
+        uint32_t coins[FillBlock];
+        while (n > 0) {
+            const size_t k = std::min(n, FillBlock);
+            for (size_t j = 0; j < k; j++) {
+                out[j] = m_column(generator);
+                coins[j] = rng_bits::Next32(generator);
+                engine_detail::Prefetch(&(*m_table)[out[j]]);
+            }
+            for (size_t j = 0; j < k; j++) {
+                const NodeAliasTable::Column& column = (*m_table)[out[j]];
+                out[j] = coins[j] < column.threshold ? out[j] : column.alias;
+            }
+            out += k;
+            n -= k;
+        }
+    }
+
+    uint32_t min() const { return 0; }
+    uint32_t max() const { return static_cast<uint32_t>(m_table->size() - 1); }
+};
+
+}
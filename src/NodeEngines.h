@@ -0,0 +1,723 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <limits>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+// Define NODE_RAND_NO_SIMD to force the scalar kernels
+#if !defined(NODE_RAND_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NODE_RAND_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__SIZEOF_INT128__)
+#include <intrin.h>
+#endif
+
+#if !defined(NODE_RAND_NO_SIMD) && defined(__AVX2__)
+#define NODE_RAND_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace node_rand {
+
+/**
+ * Random number engines usable as NodeRand<GENERATOR>. Same contract as std engines:
+ * result_type, min(), max(), operator()(), seed(s), discard(z), ==, << and >>.
+ *
+ * Counter based engines (Philox, Threefry) compute each output block as a pure function of
+ * (key, block counter). Blocks are computed in batches by a lane generic kernel, instantiated
+ * for AVX2, SSE2 and scalar lanes, so every instruction set produces bit-identical output.
+ *
+ * Small state engines (xoshiro256**, PCG64, SplitMix64) keep 8 - 32 bytes of state instead of
+ * mt19937's 5kb. Engines that can skip ahead cheaply expose jump() and/or advance(n).
+ */
+
+namespace engine_lanes {
+
+/// \brief Scalar lanes, fallback for every instruction set
+struct ScalarU32 {
+    typedef uint32_t V;
+    static const size_t Lanes = 1;
+    static V set1(uint32_t x) { return x; }
+    static V counter(uint64_t first, int word) { return static_cast<uint32_t>(first >> (32 * word)); }
+    static V add(V a, V b) { return a + b; }
+    static V xor3(V a, V b, V c) { return a ^ b ^ c; }
+    static void mulhilo(V a, uint32_t m, V& hi, V& lo) {
+        const uint64_t product = static_cast<uint64_t>(a) * m;
+        hi = static_cast<uint32_t>(product >> 32);
+        lo = static_cast<uint32_t>(product);
+    }
+    static void store(uint32_t* out, V x0, V x1, V x2, V x3) {
+        out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+    }
+};
+
+struct ScalarU64 {
+    typedef uint64_t V;
+    static const size_t Lanes = 1;
+    static V set1(uint64_t x) { return x; }
+    static V counter(uint64_t first) { return first; }
+    static V add(V a, V b) { return a + b; }
+    static V xor2(V a, V b) { return a ^ b; }
+    template<int R> static V rotl(V x) { return (x << R) | (x >> (64 - R)); }
+    static void store(uint64_t* out, V x0, V x1, V x2, V x3) {
+        out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+    }
+};
+
+#ifdef NODE_RAND_SSE2
+/// \brief 4 Philox blocks per vector, lane i holds block first + i
+struct Sse2U32 {
+    typedef __m128i V;
+    static const size_t Lanes = 4;
+    static V set1(uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+    static V counter(uint64_t first, int word) {
+        return _mm_set_epi32(static_cast<int>((first + 3) >> (32 * word)), static_cast<int>((first + 2) >> (32 * word)),
+                             static_cast<int>((first + 1) >> (32 * word)), static_cast<int>(first >> (32 * word)));
+    }
+    static V add(V a, V b) { return _mm_add_epi32(a, b); }
+    static V xor3(V a, V b, V c) { return _mm_xor_si128(_mm_xor_si128(a, b), c); }
+    static void mulhilo(V a, uint32_t m, V& hi, V& lo) {
+        const V mv = _mm_set1_epi32(static_cast<int>(m));
+        const V even = _mm_mul_epu32(a, mv);                      // lo0 hi0 lo2 hi2
+        const V odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), mv);   // lo1 hi1 lo3 hi3
+        const V lowMask = _mm_set_epi32(0, -1, 0, -1);
+        lo = _mm_or_si128(_mm_and_si128(even, lowMask), _mm_slli_epi64(odd, 32));
+        hi = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_andnot_si128(lowMask, odd));
+    }
+    static void store(uint32_t* out, V x0, V x1, V x2, V x3) {
+        // 4x4 transpose, lanes -> blocks
+        const V t0 = _mm_unpacklo_epi32(x0, x1);
+        const V t1 = _mm_unpacklo_epi32(x2, x3);
+        const V t2 = _mm_unpackhi_epi32(x0, x1);
+        const V t3 = _mm_unpackhi_epi32(x2, x3);
+        _mm_storeu_si128(reinterpret_cast<V*>(out + 0), _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128(reinterpret_cast<V*>(out + 4), _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128(reinterpret_cast<V*>(out + 8), _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128(reinterpret_cast<V*>(out + 12), _mm_unpackhi_epi64(t2, t3));
+    }
+};
+
+/// \brief 2 Threefry blocks per vector
+struct Sse2U64 {
+    typedef __m128i V;
+    static const size_t Lanes = 2;
+    static V set1(uint64_t x) { return _mm_set_epi64x(static_cast<int64_t>(x), static_cast<int64_t>(x)); }
+    static V counter(uint64_t first) { return _mm_set_epi64x(static_cast<int64_t>(first + 1), static_cast<int64_t>(first)); }
+    static V add(V a, V b) { return _mm_add_epi64(a, b); }
+    static V xor2(V a, V b) { return _mm_xor_si128(a, b); }
+    template<int R> static V rotl(V x) { return _mm_or_si128(_mm_slli_epi64(x, R), _mm_srli_epi64(x, 64 - R)); }
+    static void store(uint64_t* out, V x0, V x1, V x2, V x3) {
+        _mm_storeu_si128(reinterpret_cast<V*>(out + 0), _mm_unpacklo_epi64(x0, x1));
+        _mm_storeu_si128(reinterpret_cast<V*>(out + 2), _mm_unpacklo_epi64(x2, x3));
+        _mm_storeu_si128(reinterpret_cast<V*>(out + 4), _mm_unpackhi_epi64(x0, x1));
+        _mm_storeu_si128(reinterpret_cast<V*>(out + 6), _mm_unpackhi_epi64(x2, x3));
+    }
+};
+#endif
+
+#ifdef NODE_RAND_AVX2
+/// \brief 8 Philox blocks per vector
+struct Avx2U32 {
+    typedef __m256i V;
+    static const size_t Lanes = 8;
+    static V set1(uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+    static V counter(uint64_t first, int word) {
+        alignas(32) uint32_t c[8];
+        for (int i = 0; i < 8; i++) {
+            c[i] = static_cast<uint32_t>((first + i) >> (32 * word));
+        }
+        return _mm256_load_si256(reinterpret_cast<const V*>(c));
+    }
+    static V add(V a, V b) { return _mm256_add_epi32(a, b); }
+    static V xor3(V a, V b, V c) { return _mm256_xor_si256(_mm256_xor_si256(a, b), c); }
+    static void mulhilo(V a, uint32_t m, V& hi, V& lo) {
+        const V mv = _mm256_set1_epi32(static_cast<int>(m));
+        const V even = _mm256_mul_epu32(a, mv);
+        const V odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), mv);
+        const V lowMask = _mm256_set1_epi64x(0xFFFFFFFF);
+        lo = _mm256_or_si256(_mm256_and_si256(even, lowMask), _mm256_slli_epi64(odd, 32));
+        hi = _mm256_or_si256(_mm256_srli_epi64(even, 32), _mm256_andnot_si256(lowMask, odd));
+    }
+    static void store(uint32_t* out, V x0, V x1, V x2, V x3) {
+        // transpose within each 128 bit half, low half holds blocks 0-3, high half blocks 4-7
+        const V t0 = _mm256_unpacklo_epi32(x0, x1);
+        const V t1 = _mm256_unpacklo_epi32(x2, x3);
+        const V t2 = _mm256_unpackhi_epi32(x0, x1);
+        const V t3 = _mm256_unpackhi_epi32(x2, x3);
+        const V b0 = _mm256_unpacklo_epi64(t0, t1);
+        const V b1 = _mm256_unpackhi_epi64(t0, t1);
+        const V b2 = _mm256_unpacklo_epi64(t2, t3);
+        const V b3 = _mm256_unpackhi_epi64(t2, t3);
+        _mm256_storeu_si256(reinterpret_cast<V*>(out + 0), _mm256_permute2x128_si256(b0, b1, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<V*>(out + 8), _mm256_permute2x128_si256(b2, b3, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<V*>(out + 16), _mm256_permute2x128_si256(b0, b1, 0x31));
+        _mm256_storeu_si256(reinterpret_cast<V*>(out + 24), _mm256_permute2x128_si256(b2, b3, 0x31));
+    }
+};
+
+/// \brief 4 Threefry blocks per vector
+struct Avx2U64 {
+    typedef __m256i V;
+    static const size_t Lanes = 4;
+    static V set1(uint64_t x) { return _mm256_set1_epi64x(static_cast<int64_t>(x)); }
+    static V counter(uint64_t first) {
+        return _mm256_set_epi64x(static_cast<int64_t>(first + 3), static_cast<int64_t>(first + 2),
+                                 static_cast<int64_t>(first + 1), static_cast<int64_t>(first));
+    }
+    static V add(V a, V b) { return _mm256_add_epi64(a, b); }
+    static V xor2(V a, V b) { return _mm256_xor_si256(a, b); }
+    template<int R> static V rotl(V x) { return _mm256_or_si256(_mm256_slli_epi64(x, R), _mm256_srli_epi64(x, 64 - R)); }
+    static void store(uint64_t* out, V x0, V x1, V x2, V x3) {
+        const V t0 = _mm256_unpacklo_epi64(x0, x1);   // b0.0 b0.1 | b2.0 b2.1
+        const V t1 = _mm256_unpacklo_epi64(x2, x3);   // b0.2 b0.3 | b2.2 b2.3
+        const V t2 = _mm256_unpackhi_epi64(x0, x1);   // b1.0 b1.1 | b3.0 b3.1
+        const V t3 = _mm256_unpackhi_epi64(x2, x3);   // b1.2 b1.3 | b3.2 b3.3
+        _mm256_storeu_si256(reinterpret_cast<V*>(out + 0), _mm256_permute2x128_si256(t0, t1, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<V*>(out + 4), _mm256_permute2x128_si256(t2, t3, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<V*>(out + 8), _mm256_permute2x128_si256(t0, t1, 0x31));
+        _mm256_storeu_si256(reinterpret_cast<V*>(out + 12), _mm256_permute2x128_si256(t2, t3, 0x31));
+    }
+};
+#endif
+
+#if defined(NODE_RAND_AVX2)
+typedef Avx2U32 BestU32;
+typedef Avx2U64 BestU64;
+#elif defined(NODE_RAND_SSE2)
+typedef Sse2U32 BestU32;
+typedef Sse2U64 BestU64;
+#else
+typedef ScalarU32 BestU32;
+typedef ScalarU64 BestU64;
+#endif
+
+} // end engine_lanes namespace
+
+/// \brief Shared buffering for counter based engines. Output word i is word (i % 4) of block (i / 4).
+/// \param Derived must provide static Blocks(key, firstBlock, nblocks, out) writing 4 * nblocks words
+/// \param UINT word type
+/// \param KEY key type
+template<class Derived, class UINT, class KEY>
+class NodeCounterEngine {
+protected:
+    // blocks computed per refill
+    static const size_t BatchBlocks = 16;
+    static const size_t BufferSize = BatchBlocks * 4;
+
+    KEY m_key;
+    // block index of m_buffer[0]
+    uint64_t m_block{0};
+    // next word in m_buffer
+    size_t m_index{BufferSize};
+    std::array<UINT, BufferSize> m_buffer;
+
+    void Refill(uint64_t block) {
+        m_block = block;
+        Derived::Blocks(m_key, m_block, BatchBlocks, m_buffer.data());
+    }
+
+    /// \brief absolute position of the next output word
+    uint64_t Position() const { return m_block * 4 + m_index; }
+
+    void SetPosition(uint64_t position) {
+        Refill(position / 4);
+        m_index = static_cast<size_t>(position % 4);
+    }
+
+public:
+    typedef UINT result_type;
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (m_index == BufferSize) {
+            Refill(m_block + BatchBlocks);
+            m_index = 0;
+        }
+        return m_buffer[m_index++];
+    }
+
+    /// \brief Advance z outputs in O(1)
+    void discard(unsigned long long z) {
+        SetPosition(Position() + z);
+    }
+
+    /// \brief Skip n outputs in O(1)
+    void advance(uint64_t n) { discard(n); }
+
+    /// \brief Write the next n outputs to out. Same sequence as n calls to operator().
+    void generate(result_type* out, size_t n) {
+        // drain buffer up to a block boundary
+        while (n > 0 && (m_index == BufferSize || m_index % 4 != 0)) {
+            *out++ = (*this)();
+            n--;
+        }
+        // whole blocks straight into out
+        const size_t blocks = n / 4;
+        if (blocks > 0) {
+            const uint64_t first = m_block + m_index / 4;
+            Derived::Blocks(m_key, first, blocks, out);
+            out += blocks * 4;
+            n -= blocks * 4;
+            SetPosition((first + blocks) * 4);
+        }
+        while (n > 0) {
+            *out++ = (*this)();
+            n--;
+        }
+    }
+
+    friend bool operator==(const Derived& a, const Derived& b) {
+        return a.m_key == b.m_key && a.Position() == b.Position();
+    }
+    friend bool operator!=(const Derived& a, const Derived& b) { return !(a == b); }
+
+    /// \brief Textual state: key words followed by output position
+    friend std::ostream& operator<<(std::ostream& os, const Derived& e) {
+        for (auto k : e.m_key) {
+            os << static_cast<uint64_t>(k) << ' ';
+        }
+        return os << e.Position();
+    }
+    friend std::istream& operator>>(std::istream& is, Derived& e) {
+        KEY key;
+        uint64_t position = 0;
+        for (auto& k : key) {
+            uint64_t word = 0;
+            is >> word;
+            k = static_cast<typename KEY::value_type>(word);
+        }
+        if (is >> position) {
+            e.m_key = key;
+            e.SetPosition(position);
+        }
+        return is;
+    }
+};
+
+/// \class philox4x32
+/// \brief Philox4x32-10 (Salmon et al., Random123). 64 bit seed is the key, block counter starts at 0.
+class philox4x32 : public NodeCounterEngine<philox4x32, uint32_t, std::array<uint32_t, 2>> {
+    friend class NodeCounterEngine<philox4x32, uint32_t, std::array<uint32_t, 2>>;
+
+    static const uint32_t M0 = 0xD2511F53;
+    static const uint32_t M1 = 0xCD9E8D57;
+    static const uint32_t W0 = 0x9E3779B9;
+    static const uint32_t W1 = 0xBB67AE85;
+    static const int Rounds = 10;
+
+    /// \brief Compute L::Lanes consecutive blocks
+    template<class L>
+    static void Lanes(const std::array<uint32_t, 2>& key, uint64_t first, const std::array<uint32_t, 2>& high, uint32_t* out) {
+        typename L::V x0 = L::counter(first, 0);
+        typename L::V x1 = L::counter(first, 1);
+        typename L::V x2 = L::set1(high[0]);
+        typename L::V x3 = L::set1(high[1]);
+        uint32_t k0 = key[0];
+        uint32_t k1 = key[1];
+        for (int round = 0; round < Rounds; round++) {
+            typename L::V hi0, lo0, hi1, lo1;
+            L::mulhilo(x0, M0, hi0, lo0);
+            L::mulhilo(x2, M1, hi1, lo1);
+            x0 = L::xor3(hi1, x1, L::set1(k0));
+            x1 = lo1;
+            x2 = L::xor3(hi0, x3, L::set1(k1));
+            x3 = lo0;
+            k0 += W0;
+            k1 += W1;
+        }
+        L::store(out, x0, x1, x2, x3);
+    }
+
+public:
+    /// \brief Random123 philox4x32_R(10, counter, key) of the nblocks counters { first + b, high[0], high[1] }, on lanes L.
+    ///        The engine uses BestU32 and high 0. Public for known answer tests, see bench/native/node_rand_kat.cpp
+    template<class L = engine_lanes::BestU32>
+    static void Blocks(const std::array<uint32_t, 2>& key, uint64_t first, size_t nblocks, uint32_t* out,
+        const std::array<uint32_t, 2>& high = {}) {
+        const size_t vectorBlocks = nblocks - nblocks % L::Lanes;
+        size_t b = 0;
+        for (; b < vectorBlocks; b += L::Lanes) {
+            Lanes<L>(key, first + b, high, out + b * 4);
+        }
+        for (; b < nblocks; b++) {
+            Lanes<engine_lanes::ScalarU32>(key, first + b, high, out + b * 4);
+        }
+    }
+
+    static constexpr uint64_t default_seed = 5489u;
+
+    explicit philox4x32(uint64_t s = default_seed) { seed(s); }
+
+    void seed(uint64_t s) {
+        m_key = { static_cast<uint32_t>(s), static_cast<uint32_t>(s >> 32) };
+        SetPosition(0);
+    }
+};
+
+/// \class threefry4x64
+/// \brief Threefry4x64-20 (Salmon et al., Random123). 64 bit seed is key word 0, block counter starts at 0.
+class threefry4x64 : public NodeCounterEngine<threefry4x64, uint64_t, std::array<uint64_t, 4>> {
+    friend class NodeCounterEngine<threefry4x64, uint64_t, std::array<uint64_t, 4>>;
+
+    static const uint64_t Parity = 0x1BD11BDAA9FC1A22ULL;
+
+    /// \brief Even round, mixes (x0, x1) and (x2, x3)
+    template<class L, int RA, int RB>
+    static void Even(typename L::V& x0, typename L::V& x1, typename L::V& x2, typename L::V& x3) {
+        x0 = L::add(x0, x1); x1 = L::xor2(L::template rotl<RA>(x1), x0);
+        x2 = L::add(x2, x3); x3 = L::xor2(L::template rotl<RB>(x3), x2);
+    }
+
+    /// \brief Odd round, mixes (x0, x3) and (x2, x1)
+    template<class L, int RA, int RB>
+    static void Odd(typename L::V& x0, typename L::V& x1, typename L::V& x2, typename L::V& x3) {
+        x0 = L::add(x0, x3); x3 = L::xor2(L::template rotl<RA>(x3), x0);
+        x2 = L::add(x2, x1); x1 = L::xor2(L::template rotl<RB>(x1), x2);
+    }
+
+    /// \brief Key injection s, after every 4 rounds
+    template<class L>
+    static void Inject(typename L::V& x0, typename L::V& x1, typename L::V& x2, typename L::V& x3, const uint64_t* ks, uint64_t s) {
+        x0 = L::add(x0, L::set1(ks[s % 5]));
+        x1 = L::add(x1, L::set1(ks[(s + 1) % 5]));
+        x2 = L::add(x2, L::set1(ks[(s + 2) % 5]));
+        x3 = L::add(x3, L::set1(ks[(s + 3) % 5] + s));
+    }
+
+    /// \brief Compute L::Lanes consecutive blocks
+    template<class L>
+    static void Lanes(const std::array<uint64_t, 4>& key, uint64_t first, const std::array<uint64_t, 3>& high, uint64_t* out) {
+        const uint64_t ks[5] = { key[0], key[1], key[2], key[3], Parity ^ key[0] ^ key[1] ^ key[2] ^ key[3] };
+
+        typename L::V x0 = L::add(L::counter(first), L::set1(ks[0]));
+        typename L::V x1 = L::set1(high[0] + ks[1]);
+        typename L::V x2 = L::set1(high[1] + ks[2]);
+        typename L::V x3 = L::set1(high[2] + ks[3]);
+
+        // 20 rounds, rotation constants repeat every 8 rounds
+        for (uint64_t s = 1; s <= 5; s += 2) {
+            Even<L, 14, 16>(x0, x1, x2, x3);
+            Odd<L, 52, 57>(x0, x1, x2, x3);
+            Even<L, 23, 40>(x0, x1, x2, x3);
+            Odd<L, 5, 37>(x0, x1, x2, x3);
+            Inject<L>(x0, x1, x2, x3, ks, s);
+            if (s == 5) {
+                break;
+            }
+            Even<L, 25, 33>(x0, x1, x2, x3);
+            Odd<L, 46, 12>(x0, x1, x2, x3);
+            Even<L, 58, 22>(x0, x1, x2, x3);
+            Odd<L, 32, 32>(x0, x1, x2, x3);
+            Inject<L>(x0, x1, x2, x3, ks, s + 1);
+        }
+        L::store(out, x0, x1, x2, x3);
+    }
+
+public:
+    /// \brief Random123 threefry4x64_R(20, counter, key) of the nblocks counters { first + b, high[0], high[1], high[2] },
+    ///        on lanes L. The engine uses BestU64 and high 0. Public for known answer tests, see bench/native/node_rand_kat.cpp
+    template<class L = engine_lanes::BestU64>
+    static void Blocks(const std::array<uint64_t, 4>& key, uint64_t first, size_t nblocks, uint64_t* out,
+        const std::array<uint64_t, 3>& high = {}) {
+        const size_t vectorBlocks = nblocks - nblocks % L::Lanes;
+        size_t b = 0;
+        for (; b < vectorBlocks; b += L::Lanes) {
+            Lanes<L>(key, first + b, high, out + b * 4);
+        }
+        for (; b < nblocks; b++) {
+            Lanes<engine_lanes::ScalarU64>(key, first + b, high, out + b * 4);
+        }
+    }
+
+    static constexpr uint64_t default_seed = 5489u;
+
+    explicit threefry4x64(uint64_t s = default_seed) { seed(s); }
+
+    void seed(uint64_t s) {
+        m_key = { s, 0, 0, 0 };
+        SetPosition(0);
+    }
+};
+
+/// \class splitmix64
+/// \brief SplitMix64 (Steele, Lea, Flood). Output i is Mix(seed + (i + 1) * Gamma), so advance is O(1).
+class splitmix64 {
+    static const uint64_t Gamma = 0x9E3779B97F4A7C15ULL;
+    uint64_t m_state;
+
+public:
+    typedef uint64_t result_type;
+    static constexpr uint64_t default_seed = 5489u;
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit splitmix64(uint64_t s = default_seed) { seed(s); }
+
+    void seed(uint64_t s) { m_state = s; }
+
+    /// \brief SplitMix64 output function, a bijective 64 bit hash
+    static uint64_t Mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    result_type operator()() {
+        m_state += Gamma;
+        return Mix(m_state);
+    }
+
+    void discard(unsigned long long z) { m_state += Gamma * z; }
+
+    /// \brief Skip n outputs in O(1)
+    void advance(uint64_t n) { discard(n); }
+
+    friend bool operator==(const splitmix64& a, const splitmix64& b) { return a.m_state == b.m_state; }
+    friend bool operator!=(const splitmix64& a, const splitmix64& b) { return !(a == b); }
+    friend std::ostream& operator<<(std::ostream& os, const splitmix64& e) { return os << e.m_state; }
+    friend std::istream& operator>>(std::istream& is, splitmix64& e) { return is >> e.m_state; }
+};
+
+/// \class xoshiro256ss
+/// \brief xoshiro256** 1.0 (Blackman, Vigna). Seed is expanded to 256 bits with SplitMix64.
+class xoshiro256ss {
+    std::array<uint64_t, 4> m_s;
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    void Step() {
+        const uint64_t t = m_s[1] << 17;
+        m_s[2] ^= m_s[0];
+        m_s[3] ^= m_s[1];
+        m_s[1] ^= m_s[2];
+        m_s[0] ^= m_s[3];
+        m_s[2] ^= t;
+        m_s[3] = rotl(m_s[3], 45);
+    }
+
+    /// \brief Multiply the state by the given characteristic polynomial
+    void Jump(const uint64_t (&polynomial)[4]) {
+        std::array<uint64_t, 4> s{};
+        for (uint64_t word : polynomial) {
+            for (int b = 0; b < 64; b++) {
+                if (word & (uint64_t(1) << b)) {
+                    for (size_t i = 0; i < 4; i++) {
+                        s[i] ^= m_s[i];
+                    }
+                }
+                Step();
+            }
+        }
+        m_s = s;
+    }
+
+public:
+    typedef uint64_t result_type;
+    static constexpr uint64_t default_seed = 5489u;
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit xoshiro256ss(uint64_t s = default_seed) { seed(s); }
+
+    /// \note SplitMix64 outputs are distinct, so the state is never all zero
+    void seed(uint64_t s) {
+        splitmix64 expand(s);
+        for (auto& word : m_s) {
+            word = expand();
+        }
+    }
+
+    result_type operator()() {
+        const uint64_t result = rotl(m_s[1] * 5, 7) * 9;
+        Step();
+        return result;
+    }
+
+    void discard(unsigned long long z) {
+        for (; z > 0; z--) {
+            Step();
+        }
+    }
+
+    /// \brief Skip 2^128 outputs. Gives 2^128 non-overlapping subsequences.
+    void jump() {
+        static const uint64_t Polynomial[4] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+        Jump(Polynomial);
+    }
+
+    /// \brief Skip 2^192 outputs. Gives 2^64 starting points, each with 2^64 jump() subsequences.
+    void long_jump() {
+        static const uint64_t Polynomial[4] = { 0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL, 0x39109BB02ACBE635ULL };
+        Jump(Polynomial);
+    }
+
+    friend bool operator==(const xoshiro256ss& a, const xoshiro256ss& b) { return a.m_s == b.m_s; }
+    friend bool operator!=(const xoshiro256ss& a, const xoshiro256ss& b) { return !(a == b); }
+    friend std::ostream& operator<<(std::ostream& os, const xoshiro256ss& e) {
+        return os << e.m_s[0] << ' ' << e.m_s[1] << ' ' << e.m_s[2] << ' ' << e.m_s[3];
+    }
+    friend std::istream& operator>>(std::istream& is, xoshiro256ss& e) {
+        std::array<uint64_t, 4> s;
+        if (is >> s[0] >> s[1] >> s[2] >> s[3]) {
+            e.m_s = s;
+        }
+        return is;
+    }
+};
+
+namespace engine_detail {
+
+/// \brief Full 128 bit product of two 64 bit words
+inline void Mul64(uint64_t a, uint64_t b, uint64_t& hi, uint64_t& lo) {
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    hi = static_cast<uint64_t>(product >> 64);
+    lo = static_cast<uint64_t>(product);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    lo = _umul128(a, b, &hi);
+#else
+    const uint64_t a0 = a & 0xFFFFFFFF, a1 = a >> 32;
+    const uint64_t b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+    const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+    hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    lo = (mid << 32) | (p00 & 0xFFFFFFFF);
+#endif
+}
+
+/// \brief Hint that the cache line at p is read soon. Used to overlap random accesses into large arrays.
+inline void Prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p);
+#elif defined(NODE_RAND_SSE2)
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+    (void)p;
+#endif
+}
+
+/// \brief Portable unsigned 128 bit integer, only what PCG64 needs
+struct uint128 {
+    uint64_t hi;
+    uint64_t lo;
+
+    friend bool operator==(const uint128& a, const uint128& b) { return a.hi == b.hi && a.lo == b.lo; }
+
+    friend uint128 operator+(const uint128& a, const uint128& b) {
+        const uint64_t lo = a.lo + b.lo;
+        return { a.hi + b.hi + (lo < a.lo), lo };
+    }
+
+    friend uint128 operator*(const uint128& a, const uint128& b) {
+        uint64_t hi, lo;
+        Mul64(a.lo, b.lo, hi, lo);
+        return { hi + a.hi * b.lo + a.lo * b.hi, lo };
+    }
+};
+
+} // end engine_detail namespace
+
+/// \class pcg64
+/// \brief PCG XSL RR 128/64 (O'Neill), same state transition, seeding and stream as pcg-cpp's pcg64.
+class pcg64 {
+    typedef engine_detail::uint128 uint128;
+
+    static constexpr uint128 Multiplier{ 2549297995355413924ULL, 4865540595714422341ULL };
+    static constexpr uint128 Increment{ 6364136223846793005ULL, 1442695040888963407ULL };
+
+    uint128 m_state;
+
+    void Step() { m_state = m_state * Multiplier + Increment; }
+
+    /// \brief Jump the LCG ahead by delta steps in O(log delta) (Brown, "Random Number Generation with Arbitrary Strides")
+    void Advance(uint128 delta) {
+        uint128 accMult{ 0, 1 }, accPlus{ 0, 0 };
+        uint128 curMult = Multiplier, curPlus = Increment;
+        while (delta.hi != 0 || delta.lo != 0) {
+            if (delta.lo & 1) {
+                accMult = accMult * curMult;
+                accPlus = accPlus * curMult + curPlus;
+            }
+            curPlus = (curMult + uint128{ 0, 1 }) * curPlus;
+            curMult = curMult * curMult;
+            delta = { delta.hi >> 1, (delta.lo >> 1) | (delta.hi << 63) };
+        }
+        m_state = accMult * m_state + accPlus;
+    }
+
+public:
+    typedef uint64_t result_type;
+    static constexpr uint64_t default_seed = 5489u;
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit pcg64(uint64_t s = default_seed) { seed(s); }
+
+    void seed(uint64_t s) {
+        m_state = uint128{ 0, s } + Increment;
+        Step();
+    }
+
+    result_type operator()() {
+        Step();
+        const uint64_t xored = m_state.hi ^ m_state.lo;
+        const unsigned rot = static_cast<unsigned>(m_state.hi >> 58);
+        return (xored >> rot) | (xored << ((64 - rot) & 63));
+    }
+
+    void discard(unsigned long long z) { Advance(uint128{ 0, z }); }
+
+    /// \brief Skip n outputs in O(log n)
+    void advance(uint64_t n) { discard(n); }
+
+    /// \brief Skip 2^64 outputs. Gives 2^64 non-overlapping subsequences.
+    void jump() { Advance(uint128{ 1, 0 }); }
+
+    friend bool operator==(const pcg64& a, const pcg64& b) { return a.m_state == b.m_state; }
+    friend bool operator!=(const pcg64& a, const pcg64& b) { return !(a == b); }
+    friend std::ostream& operator<<(std::ostream& os, const pcg64& e) { return os << e.m_state.hi << ' ' << e.m_state.lo; }
+    friend std::istream& operator>>(std::istream& is, pcg64& e) {
+        uint128 state;
+        if (is >> state.hi >> state.lo) {
+            e.m_state = state;
+        }
+        return is;
+    }
+};
+
+namespace engine_traits {
+
+/// \brief GENERATOR has jump(), skip a fixed large distance
+template<class GENERATOR, class = void>
+struct HasJump : std::false_type {};
+template<class GENERATOR>
+struct HasJump<GENERATOR, std::void_t<decltype(std::declval<GENERATOR&>().jump())>> : std::true_type {};
+
+/// \brief GENERATOR has advance(n), skip n outputs faster than discard's O(n) default
+template<class GENERATOR, class = void>
+struct HasAdvance : std::false_type {};
+template<class GENERATOR>
+struct HasAdvance<GENERATOR, std::void_t<decltype(std::declval<GENERATOR&>().advance(uint64_t(0)))>> : std::true_type {};
+
+/// \brief GENERATOR has a bulk generate(out, n), same sequence as n calls to operator()
+template<class GENERATOR, class = void>
+struct HasGenerate : std::false_type {};
+template<class GENERATOR>
+struct HasGenerate<GENERATOR, std::void_t<decltype(std::declval<GENERATOR&>().generate(
+    std::declval<typename GENERATOR::result_type*>(), size_t(0)))>> : std::true_type {};
+
+} // end engine_traits namespace
+
+}
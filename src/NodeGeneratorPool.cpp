@@ -0,0 +1,178 @@
+#include "NodeGeneratorPool.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+using namespace node_rand;
+
+NodeGeneratorPool& NodeGeneratorPool::Instance()
+{
+    // Never destroyed, threads are detached and may still wait on it while static destructors run
+    static NodeGeneratorPool* pool = new NodeGeneratorPool();
+    return *pool;
+}
+
+void NodeGeneratorPool::SetThreads(uint32_t threads)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (threads == 0) {
+        m_enabled = false;
+        return;
+    }
+    while (m_started < threads) {
+        std::thread(&NodeGeneratorPool::Run, this, m_started++).detach();
+    }
+    m_active = threads;
+    m_enabled = true;
+    m_resize.notify_all();
+    // surplus threads stop waiting for tasks
+    m_wake.notify_all();
+}
+
+void NodeGeneratorPool::Push(uint32_t index, Task&& task)
+{
+    std::lock_guard<std::mutex> lock(m_workers[index].mutex);
+    m_workers[index].tasks.push_back(std::move(task));
+    m_queued++;
+}
+
+void NodeGeneratorPool::Submit(Task task)
+{
+    const uint32_t active = std::max(1u, m_active.load());
+    Push(m_next++ % active, std::move(task));
+
+    // a thread between checking m_queued and waiting holds m_mutex
+    { std::lock_guard<std::mutex> lock(m_mutex); }
+    m_wake.notify_one();
+}
+
+void NodeGeneratorPool::ParallelFor(uint32_t threads, size_t count, const std::function<void(size_t)>& fn)
+{
+    // shared with helper tasks, which may run after this call returned
+    struct Job {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+        size_t count = 0;
+        // valid until finished reaches count
+        const std::function<void(size_t)>* fn = nullptr;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->count = count;
+    job->fn = &fn;
+
+    auto work = [job] () {
+        for (size_t i = job->next++; i < job->count; i = job->next++) {
+            (*job->fn)(i);
+            if (++job->finished == job->count) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->done.notify_one();
+            }
+        }
+        return false;
+    };
+
+    const size_t helpers = std::min<size_t>({ threads, count, std::max(1u, m_active.load()) }) - (count > 0 ? 1 : 0);
+    for (size_t t = 0; t < helpers; t++) {
+        Submit(work);
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done.wait(lock, [&job] { return job->finished == job->count; });
+}
+
+bool NodeGeneratorPool::Steal(uint32_t index, Task& task)
+{
+    // started threads only, a surplus thread may own tasks until it handed them off
+    uint32_t started = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        started = m_started;
+    }
+    for (uint32_t i = 1; i < started; i++) {
+        Worker& victim = m_workers[(index + i) % started];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            m_queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NodeGeneratorPool::Take(uint32_t index, Task& task, bool steal)
+{
+    if (steal && Steal(index, task)) {
+        return true;
+    }
+    {
+        Worker& own = m_workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            m_queued--;
+            return true;
+        }
+    }
+    return !steal && Steal(index, task);
+}
+
+void NodeGeneratorPool::HandOff(uint32_t index)
+{
+    std::deque<Task> tasks;
+    {
+        Worker& own = m_workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        tasks.swap(own.tasks);
+        m_queued -= tasks.size();
+    }
+    if (tasks.empty()) {
+        return;
+    }
+
+    const uint32_t active = std::max(1u, m_active.load());
+    for (Task& task : tasks) {
+        Push(m_next++ % active, std::move(task));
+    }
+
+    // a thread between checking m_queued and waiting holds m_mutex
+    { std::lock_guard<std::mutex> lock(m_mutex); }
+    m_wake.notify_all();
+}
+
+void NodeGeneratorPool::Run(uint32_t index)
+{
+    uint32_t taken = 0;
+    while (true) {
+        if (index >= m_active) {
+            // the pool shrank, a task requeued here after that would never run again
+            HandOff(index);
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_resize.wait(lock, [this, index] { return index < m_active; });
+            continue;
+        }
+
+        Task task;
+        if (!Take(index, task, ++taken % STEAL_INTERVAL == 0)) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, index] { return m_queued > 0 || index >= m_active; });
+            continue;
+        }
+
+        if (task()) {
+            // behind the tasks already queued here, each stream gets a chunk in turn. A surplus thread hands it off
+            // on its next turn of the loop.
+            Push(index, std::move(task));
+            if (m_queued > 1) {
+                // let an idle thread steal, this thread takes the task it just queued itself
+                m_wake.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace node_rand {
+
+/// \brief Upper bound for SetGeneratorThreads
+static const uint32_t MAX_GENERATOR_THREADS = 256;
+
+/// \brief A thread tries to steal before taking its own front every STEAL_INTERVAL tasks
+static const uint32_t STEAL_INTERVAL = 8;
+
+/**
+ * Generator pool
+ *
+ * Streams run their production runs as libuv async work by default, so a stream with a fast consumer holds one of
+ * the UV_THREADPOOL_SIZE (4) libuv threads for as long as it has demand, and fs, dns and crypto calls of the process
+ * queue behind it. SetGeneratorThreads(n) moves streams created afterwards to this pool of n native threads.
+ *
+ * A task is one step of a stream: it generates and queues one chunk (one round of blocks in parallel mode), then goes
+ * back to the end of the deque of the thread that ran it, so every stream on a thread gets a chunk in turn. Idle
+ * threads steal from the other end of the other deques, busy threads every STEAL_INTERVAL tasks so an uneven split
+ * of streams between threads evens out. A thread above the new size of a shrunk pool hands its tasks to the remaining
+ * threads before it parks. Tasks never block on the JS thread, a stream whose tsfn queue
+ * is full leaves the pool until the JS thread has taken a chunk. A stream with options.threads shares the blocks of its
+ * round with helper tasks on the pool (see ParallelFor), it does not start threads of its own.
+ */
+
+/// \class NodeGeneratorPool
+/// \brief Process wide work stealing pool of generator threads. Threads are started on demand and never stopped.
+/// \note Thread-safe
+class NodeGeneratorPool {
+public:
+    /// \brief Runs one step, returns true to be queued again
+    typedef std::function<bool()> Task;
+
+private:
+    /// \brief Tasks of one thread. The owner takes from the front, thieves from the back.
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::array<Worker, MAX_GENERATOR_THREADS> m_workers;
+
+    // guards m_started and the waits below
+    std::mutex m_mutex;
+    // a task was submitted
+    std::condition_variable m_wake;
+    // threads at or above m_active wait here until the pool grows again
+    std::condition_variable m_resize;
+    uint32_t m_started{0};
+    // threads taking tasks, the first m_active workers
+    std::atomic<uint32_t> m_active{0};
+    // tasks in every deque, updated under the deque mutex
+    std::atomic<size_t> m_queued{0};
+    // new streams run on the pool
+    std::atomic<bool> m_enabled{false};
+    // round robin thread of the next Submit
+    std::atomic<uint32_t> m_next{0};
+
+    NodeGeneratorPool() = default;
+
+    /// \brief Thread index loop
+    void Run(uint32_t index);
+
+    /// \brief Pop the front of the own deque, else steal the back of another one. steal tries the other deques first.
+    bool Take(uint32_t index, Task& task, bool steal);
+
+    /// \brief Steal the back of a deque other than index
+    bool Steal(uint32_t index, Task& task);
+
+    /// \brief Move the tasks of surplus thread index to the active threads, round robin
+    void HandOff(uint32_t index);
+
+    /// \brief Append task to the deque of thread index
+    void Push(uint32_t index, Task&& task);
+
+public:
+    NodeGeneratorPool(const NodeGeneratorPool&) = delete;
+    NodeGeneratorPool& operator=(const NodeGeneratorPool&) = delete;
+
+    /// \brief Singleton instance
+    static NodeGeneratorPool& Instance();
+
+    /// \brief Threads taking tasks. 0 disables the pool for new streams, streams already on it keep running on the
+    ///        threads they have. Shrinking moves the streams of the surplus threads to the remaining ones.
+    /// \param threads 0 to MAX_GENERATOR_THREADS
+    void SetThreads(uint32_t threads);
+
+    /// \brief Threads taking tasks, 0 while disabled
+    uint32_t Threads() const { return m_enabled ? m_active.load() : 0; }
+
+    /// \brief New streams run on the pool
+    bool Enabled() const { return m_enabled; }
+
+    /// \brief Queue task on the next thread, round robin
+    void Submit(Task task);
+
+    /// \brief ParallelFor of NodeParallel.h for tasks on the pool: run fn(i) for every i in [0, count) on the calling
+    ///        thread and up to threads - 1 helper tasks, without starting threads. The caller only waits for the
+    ///        fn(i) helpers already started, helpers that run later find nothing left to do.
+    void ParallelFor(uint32_t threads, size_t count, const std::function<void(size_t)>& fn);
+};
+
+}
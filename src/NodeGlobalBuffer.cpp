@@ -2,32 +2,65 @@
 
 using namespace node_rand;
 
-NodeGlobalBuffer::NodeGlobalBuffer() : m_buffer(), m_generator(std::random_device{}()), m_distribution(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()) {}
+NodeGlobalBuffer::NodeGlobalBuffer() : m_seed(RandomSeed()) {}
 
-void NodeGlobalBuffer::FillBuffer()
+uint64_t NodeGlobalBuffer::RandomSeed()
 {
-    // Clear buffer
-    std::queue<int64_t> empty;
-    m_buffer.swap(empty);
+    static const uint64_t root = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+    static std::atomic<uint64_t> index{0};
 
-    // Fill Buffer
-    for (size_t i = 0; i < BufferMax; i++) {
-        auto num = m_distribution(m_generator);
-        m_buffer.push(num);
-    }
+    splitmix64 seeds(root);
+    seeds.advance(index++);
+    return seeds();
 }
 
 void NodeGlobalBuffer::SetSeed(const int64_t seed) {
-    m_generator.seed(seed);
-    FillBuffer();
+    m_seed.store(static_cast<uint64_t>(seed), std::memory_order_relaxed);
+    m_index.store(0, std::memory_order_relaxed);
+}
+
+uint64_t NodeGlobalBuffer::Seed() const
+{
+    return m_seed.load(std::memory_order_relaxed);
+}
+
+uint64_t NodeGlobalBuffer::Index() const
+{
+    return m_index.load(std::memory_order_relaxed);
+}
+
+void NodeGlobalBuffer::SetState(uint64_t seed, uint64_t index)
+{
+    m_seed.store(seed, std::memory_order_relaxed);
+    m_index.store(index, std::memory_order_relaxed);
 }
 
 int64_t NodeGlobalBuffer::Next()
 {
-    if (m_buffer.empty()) {
-        FillBuffer();
-    }
-    auto next = m_buffer.front();
-    m_buffer.pop();
-    return next;
-}
\ No newline at end of file
+    return At(m_index.fetch_add(1, std::memory_order_relaxed));
+}
+
+int64_t NodeGlobalBuffer::At(uint64_t index) const
+{
+    return PseudoSeed(m_seed.load(std::memory_order_relaxed), index);
+}
+
+int64_t NodeGlobalBuffer::Fork(uint64_t streamId) const
+{
+    return ForkSeed(m_seed.load(std::memory_order_relaxed), streamId);
+}
+
+int64_t NodeGlobalBuffer::PseudoSeed(uint64_t seed, uint64_t index)
+{
+    splitmix64 seeds(seed);
+    seeds.advance(index);
+    // full int64_t range, every bit pattern is a seed
+    return static_cast<int64_t>(seeds());
+}
+
+int64_t NodeGlobalBuffer::ForkSeed(uint64_t seed, uint64_t streamId)
+{
+    // domain separation from PseudoSeed(seed, i), digits of pi
+    static const uint64_t ForkKey = 0x243F6A8885A308D3ULL;
+    return PseudoSeed(splitmix64::Mix(seed ^ ForkKey), streamId);
+}
@@ -1,32 +1,61 @@
 #include <node_api.h>
 #include <random>
-#include <queue>
 #include <memory>
+#include <atomic>
+#include "NodeEngines.h"
 
 #pragma once
 
 namespace node_rand {
     
-/// \brief Singleton queue of int64_t of random numbers for async sequence calls. 
+/// \brief Per instance source of int64_t random numbers for async sequence calls. 
 /// \note Used for generating psuedo seeds based off a real seed.
+///       Pseudo seed i is output i of SplitMix64 seeded with the real seed, derived on demand from an atomic counter.
+///       Next is O(1), lock-free and allocation free, safe to call from any thread. SetSeed must not race with Next.
 class NodeGlobalBuffer {
-    static const uint64_t BufferMax{1000};
-    std::queue<int64_t> m_buffer;
-    std::mt19937 m_generator;
-    std::uniform_int_distribution<int64_t> m_distribution;
-
-    /// \brief Fill buffer with pseudo seed
-    void FillBuffer();
+    // "real" seed
+    std::atomic<uint64_t> m_seed;
+    // index of the next pseudo seed
+    std::atomic<uint64_t> m_index{0};
 
 public:
     /// \brief ctor
     NodeGlobalBuffer();
 
-    /// \brief Set the "real" seed
+    NodeGlobalBuffer(const NodeGlobalBuffer&) = delete;
+    NodeGlobalBuffer& operator=(const NodeGlobalBuffer&) = delete;
+
+    /// \brief Set the "real" seed, pseudo seeds restart at index 0
     void SetSeed(const int64_t seed);
 
+    /// \brief Real seed and index of the next pseudo seed, see GetState
+    uint64_t Seed() const;
+    uint64_t Index() const;
+
+    /// \brief Restore the real seed and the index of the next pseudo seed
+    void SetState(uint64_t seed, uint64_t index);
+
     /// \brief Get the next pseudo seed
     int64_t Next();
+
+    /// \brief Pseudo seed index of the real seed, O(1). Does not move the counter.
+    int64_t At(uint64_t index) const;
+
+    /// \brief Real seed of stream streamId, see ForkSeed. O(1), does not move the counter.
+    int64_t Fork(uint64_t streamId) const;
+
+    /// \brief Pseudo seed index of a real seed, output index of SplitMix64 seeded with seed
+    static int64_t PseudoSeed(uint64_t seed, uint64_t index);
+
+    /// \brief Real seed of stream streamId of a real seed. Keyed hash: the stream seeds of seed are the pseudo seeds
+    ///        of Mix(seed ^ key), so they do not line up with the pseudo seeds of seed itself.
+    ///        Hashing a path is folding it, eg: ForkSeed(ForkSeed(seed, a), b)
+    static int64_t ForkSeed(uint64_t seed, uint64_t streamId);
+
+    /// \brief Seed for instances without a set seed. std::random_device is read once per process, each call
+    ///        returns the next output of a SplitMix64 sequence seeded from it.
+    /// \note Thread-safe
+    static uint64_t RandomSeed();
 };
 
-}
\ No newline at end of file
+}
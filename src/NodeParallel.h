@@ -0,0 +1,183 @@
+#pragma once
+
+#include "NodeEngines.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace node_rand {
+
+/// \brief Numbers per substream block in parallel mode. Fixed, so the output does not depend on the thread count.
+static const uint32_t PARALLEL_BLOCK_SIZE = 1 << 16;
+
+/// \brief Upper bound for the threads option
+static const uint32_t MAX_PARALLEL_THREADS = 256;
+
+/**
+ * Parallel sequences
+ *
+ * A parallel sequence is cut into blocks of PARALLEL_BLOCK_SIZE numbers. Block b is generated by its own
+ * GENERATOR seeded with BlockSeed(seed, b), so any block can be produced on any thread and the blocks
+ * are reassembled in order. Same seed gives the same numbers for 1 or 32 threads.
+ * This is a different sequence than the sequential (threads not set) one.
+ */
+
+/// \brief Seed of block b. Output b of SplitMix64 seeded with the sequence seed, computed in O(1).
+inline uint64_t BlockSeed(uint64_t seed, uint64_t block)
+{
+    splitmix64 s(seed);
+    s.advance(block);
+    return s();
+}
+
+/// \brief Run fn(i) for every i in [0, count) on up to threads threads. The calling thread takes part.
+/// \note Blocks until every fn(i) returned
+template<class FN>
+void ParallelFor(uint32_t threads, size_t count, FN fn)
+{
+    std::atomic<size_t> next{0};
+    auto worker = [&next, count, &fn] () {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    const size_t helpers = std::min<size_t>(threads, count) - (count > 0 ? 1 : 0);
+    std::vector<std::thread> pool;
+    pool.reserve(helpers);
+    for (size_t t = 0; t < helpers; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+/// \class ParallelTeam
+/// \brief ParallelFor for callers running many short rounds, eg a parallel stream generates one round of blocks per
+///        chunk. The threads - 1 helpers start with the first round and wait for the next one instead of being started
+///        and joined per round. The destructor joins them.
+/// \note For() is called by one thread at a time
+class ParallelTeam {
+private:
+    std::vector<std::thread> m_threads;
+    size_t m_helpers;
+
+    // guards everything below, m_next aside
+    std::mutex m_mutex;
+    // a round started, or m_stop was set
+    std::condition_variable m_start;
+    // the last helper finished the round
+    std::condition_variable m_done;
+    // current round, helpers join each round once
+    uint64_t m_round{0};
+    // helpers that did not finish the current round yet
+    size_t m_busy{0};
+    bool m_stop{false};
+    const std::function<void(size_t)>* m_fn{nullptr};
+    size_t m_count{0};
+    std::atomic<size_t> m_next{0};
+
+    void Work()
+    {
+        for (size_t i = m_next++; i < m_count; i = m_next++) {
+            (*m_fn)(i);
+        }
+    }
+
+    void Help()
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_start.wait(lock, [this, &seen] { return m_stop || m_round != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_round;
+            lock.unlock();
+            Work();
+            lock.lock();
+            if (--m_busy == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+
+public:
+    /// \param threads threads of each round, the calling thread included
+    explicit ParallelTeam(uint32_t threads) : m_helpers(threads > 0 ? threads - 1 : 0) {}
+
+    ParallelTeam(const ParallelTeam&) = delete;
+    ParallelTeam& operator=(const ParallelTeam&) = delete;
+
+    ~ParallelTeam()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    /// \brief Run fn(i) for every i in [0, count), the calling thread takes part
+    /// \note Blocks until every fn(i) returned
+    void For(size_t count, const std::function<void(size_t)>& fn)
+    {
+        if (count <= 1 || m_helpers == 0) {
+            for (size_t i = 0; i < count; i++) {
+                fn(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (m_threads.size() < m_helpers) {
+                m_threads.emplace_back(&ParallelTeam::Help, this);
+            }
+            m_fn = &fn;
+            m_count = count;
+            m_next = 0;
+            m_busy = m_threads.size();
+            m_round++;
+        }
+        m_start.notify_all();
+        Work();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        m_fn = nullptr;
+    }
+};
+
+/// \brief Generate count numbers of block b of a parallel sequence into out
+template<class T, class GENERATOR, class DISTRIBUTION>
+void GenerateBlock(uint64_t seed, uint64_t block, const DISTRIBUTION& d, T* out, size_t count)
+{
+    GENERATOR generator(BlockSeed(seed, block));
+    DISTRIBUTION distribution(d);
+    distribution.Fill(generator, out, count);
+}
+
+/// \brief Fill out[0, length) with a parallel sequence starting at block 0
+template<class T, class GENERATOR, class DISTRIBUTION>
+void ParallelFill(uint64_t seed, uint32_t threads, const DISTRIBUTION& d, T* out, size_t length)
+{
+    const size_t blocks = (length + PARALLEL_BLOCK_SIZE - 1) / PARALLEL_BLOCK_SIZE;
+    ParallelFor(threads, blocks, [seed, &d, out, length] (size_t b) {
+        const size_t first = b * PARALLEL_BLOCK_SIZE;
+        GenerateBlock<T, GENERATOR>(seed, b, d, out + first, std::min<size_t>(PARALLEL_BLOCK_SIZE, length - first));
+    });
+}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "napi_extensions.h"
+#include "NodeParallel.h"
+
+#include <node_api.h>
+#include <sstream>
+
+namespace node_rand {
+
+/// \brief Parse optional threads option. 0 when not set (sequential). Throws a JS error and returns false if invalid.
+inline bool GetThreadsOption(napi_env env, const napi_extensions::NapiOptions& opts, uint32_t& threads)
+{
+    threads = 0;
+    if (!opts.Has("threads")) {
+        return true;
+    }
+    threads = opts.GetUint32("threads", 0);
+    if (threads < 1 || threads > MAX_PARALLEL_THREADS) {
+        std::stringstream ss;
+        ss << "threads must be between 1 and " << MAX_PARALLEL_THREADS << ". threads: " << threads << std::endl;
+        napi_throw_range_error(env, nullptr, ss.str().c_str());
+        return false;
+    }
+    return true;
+}
+
+}
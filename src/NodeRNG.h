@@ -5,24 +5,342 @@
 #include <assert.h>
 #include <type_traits>
 #include <functional>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include "NodeEngines.h"
 
 namespace node_rand {
 
+/**
+ * Raw bits from an engine. Only engines producing full 32 or 64 bit words are supported, so every
+ * distribution below consumes engine output the same way on every platform and standard library.
+ *  - 32 bits from a 64 bit engine: upper half of one output
+ *  - 64 bits from a 32 bit engine: two outputs, first one is the upper half
+ */
+namespace rng_bits {
+
+template<class GENERATOR>
+constexpr bool Is32() {
+    static_assert(GENERATOR::min() == 0 && (GENERATOR::max() == 0xFFFFFFFFu || GENERATOR::max() == std::numeric_limits<uint64_t>::max()),
+        "Engine must produce full 32 or 64 bit words");
+    return GENERATOR::max() == 0xFFFFFFFFu;
+}
+
+template<class GENERATOR>
+uint32_t Next32(GENERATOR& generator) {
+    if constexpr (Is32<GENERATOR>()) {
+        return static_cast<uint32_t>(generator());
+    }
+    else {
+        return static_cast<uint32_t>(static_cast<uint64_t>(generator()) >> 32);
+    }
+}
+
+template<class GENERATOR>
+uint64_t Next64(GENERATOR& generator) {
+    if constexpr (Is32<GENERATOR>()) {
+        const uint64_t hi = static_cast<uint32_t>(generator());
+        const uint64_t lo = static_cast<uint32_t>(generator());
+        return (hi << 32) | lo;
+    }
+    else {
+        return static_cast<uint64_t>(generator());
+    }
+}
+
+/// \brief Uniform double in [0, 1) from the upper 53 bits of Next64
+template<class GENERATOR>
+double NextDouble(GENERATOR& generator) {
+    return static_cast<double>(Next64(generator) >> 11) * 0x1.0p-53;
+}
+
+/// \brief Uniform float in [0, 1) from the upper 24 bits of Next32
+template<class GENERATOR>
+float NextFloat(GENERATOR& generator) {
+    return static_cast<float>(Next32(generator) >> 8) * 0x1.0p-24f;
+}
+
+/// \brief Engine has a bulk generate() writing 32 bit words, see Fill32
+template<class GENERATOR>
+constexpr bool HasFill32() {
+    return Is32<GENERATOR>() && engine_traits::HasGenerate<GENERATOR>::value
+        && std::is_same<typename GENERATOR::result_type, uint32_t>::value;
+}
+
+/// \brief n x Next32, with the engine's bulk generate() if it has one
+template<class GENERATOR>
+void Fill32(GENERATOR& generator, uint32_t* out, size_t n) {
+    if constexpr (HasFill32<GENERATOR>()) {
+        generator.generate(out, n);
+    }
+    else {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = Next32(generator);
+        }
+    }
+}
+
+} // end rng_bits namespace
+
+/// \class NodeUniformIntDistribution
+/// \brief Uniform integer in [a, b] with Lemire's nearly divisionless multiply-shift method
+///        ("Fast Random Integer Generation in an Interval", 2019).
+/// \note Output is fully specified here, unlike std::uniform_int_distribution which is implementation defined.
+///       Rejecting l < (2^N - s) % s is the same test as Lemire's lazy l < s check followed by l < t.
+///       Ranges below 2^32 take one Next32 per number, wider ranges one Next64, plus rare rejection retries.
+template<typename T>
+class NodeUniformIntDistribution {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "T must be an integer type");
+
+    // raw words drawn per batch by Fill
+    static const size_t Batch = 256;
+
+    T m_a;
+    T m_b;
+    // b - a, as unsigned
+    uint64_t m_span;
+    // Lemire rejection threshold (2^32 or 2^64 - s) % s for s = span + 1, computed once at construction
+    uint64_t m_threshold{0};
+
+    /// \brief a + offset, wrapping
+    T From(uint64_t offset) const {
+        return static_cast<T>(static_cast<uint64_t>(m_a) + offset);
+    }
+
+    template<class GENERATOR>
+    uint32_t Bounded32(GENERATOR& generator, uint32_t s) const {
+        const uint32_t t = static_cast<uint32_t>(m_threshold);
+        uint64_t m = static_cast<uint64_t>(rng_bits::Next32(generator)) * s;
+        while (static_cast<uint32_t>(m) < t) {
+            m = static_cast<uint64_t>(rng_bits::Next32(generator)) * s;
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    template<class GENERATOR>
+    uint64_t Bounded64(GENERATOR& generator, uint64_t s) const {
+        uint64_t hi, l;
+        engine_detail::Mul64(rng_bits::Next64(generator), s, hi, l);
+        while (l < m_threshold) {
+            engine_detail::Mul64(rng_bits::Next64(generator), s, hi, l);
+        }
+        return hi;
+    }
+
+public:
+    typedef T result_type;
+
+    NodeUniformIntDistribution(T a = std::numeric_limits<T>::min(), T b = std::numeric_limits<T>::max())
+        : m_a(a), m_b(b), m_span(static_cast<uint64_t>(b) - static_cast<uint64_t>(a)) {
+        assert(b >= a && "Max must be greater or equal to min");
+        if (m_span < 0xFFFFFFFFu) {
+            const uint32_t s = static_cast<uint32_t>(m_span + 1);
+            m_threshold = (0u - s) % s;
+        }
+        else if (m_span != 0xFFFFFFFFu && m_span != std::numeric_limits<uint64_t>::max()) {
+            const uint64_t s = m_span + 1;
+            m_threshold = (0 - s) % s;
+        }
+    }
+
+    T a() const { return m_a; }
+    T b() const { return m_b; }
+    T min() const { return m_a; }
+    T max() const { return m_b; }
+
+    template<class GENERATOR>
+    T operator()(GENERATOR& generator) const {
+        if (m_span < 0xFFFFFFFFu) {
+            return From(Bounded32(generator, static_cast<uint32_t>(m_span + 1)));
+        }
+        if (m_span == 0xFFFFFFFFu) {
+            return From(rng_bits::Next32(generator));
+        }
+        if (m_span == std::numeric_limits<uint64_t>::max()) {
+            return From(rng_bits::Next64(generator));
+        }
+        return From(Bounded64(generator, m_span + 1));
+    }
+
+    /// \brief Write n numbers to out. Same numbers and engine consumption as n calls to operator().
+    /// \note For engines with a bulk generate() (counter based engines) ranges below 2^32 draw raw words in
+    ///       batches and multiply them in a vectorizable loop.
+    ///       Other engines are faster with the scalar loop, the extra pass over memory costs more than it saves.
+    template<class GENERATOR>
+    void Fill(GENERATOR& generator, T* out, size_t n) const {
+        if constexpr (rng_bits::HasFill32<GENERATOR>()) {
+            if (m_span < 0xFFFFFFFFu) {
+                FillBatched(generator, out, n);
+                return;
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            out[i] = (*this)(generator);
+        }
+    }
+
+private:
+    template<class GENERATOR>
+    void FillBatched(GENERATOR& generator, T* out, size_t n) const {
+        const uint32_t s = static_cast<uint32_t>(m_span + 1);
+        const uint32_t t = static_cast<uint32_t>(m_threshold);
+        uint32_t words[Batch];
+        uint64_t products[Batch];
+
+        while (n > 0) {
+            // each word yields at most one number, never draws past what operator() would
+            const size_t k = std::min(n, Batch);
+            rng_bits::Fill32(generator, words, k);
+            for (size_t i = 0; i < k; i++) {
+                products[i] = static_cast<uint64_t>(words[i]) * s;
+            }
+            size_t accepted = 0;
+            for (size_t i = 0; i < k; i++) {
+                out[accepted] = From(products[i] >> 32);
+                accepted += static_cast<uint32_t>(products[i]) >= t;
+            }
+            out += accepted;
+            n -= accepted;
+        }
+    }
+};
+
+/// \class NodeUniformRealDistribution
+/// \brief Uniform float or double in [a, b): a + (b - a) * u, u built from 24 (float) or 53 (double) random bits,
+///        see rng_bits::NextFloat/NextDouble. One Next32 per float, one Next64 per double.
+/// \note Output is fully specified here, unlike std::uniform_real_distribution whose generate_canonical is implementation
+///       defined and slow. Ranges wider than the largest T are computed at half scale, results rounding up to b are
+///       returned as the largest T below b. Float Fill converts batches of raw words with SSE2, bit-identical to operator().
+template<typename T>
+class NodeUniformRealDistribution {
+    static_assert(std::is_same<T, double>::value || std::is_same<T, float>::value, "T must be float or double");
+
+    // raw words converted per batch by float Fill
+    static const size_t Batch = 256;
+
+    T m_a;
+    T m_b;
+    // result is (m_offset + m_span * u) * m_scale, m_scale is 2 if b - a overflows
+    T m_offset;
+    T m_span;
+    T m_scale;
+    // largest T below b
+    T m_below;
+
+    T FromUnit(T u) const {
+        const T r = (m_offset + m_span * u) * m_scale;
+        return r < m_b ? r : m_below;
+    }
+
+    /// \brief Floats from raw Next32 words, same as NextFloat. 4 at a time with SSE2, 24 bit integers convert exactly.
+    void Convert(const uint32_t* words, float* out, size_t n) const {
+        size_t i = 0;
+#if defined(NODE_RAND_SSE2)
+        const __m128 unit = _mm_set1_ps(0x1.0p-24f);
+        const __m128 offset = _mm_set1_ps(m_offset), span = _mm_set1_ps(m_span), scale = _mm_set1_ps(m_scale);
+        const __m128 b = _mm_set1_ps(m_b), below = _mm_set1_ps(m_below);
+        for (; i + 4 <= n; i += 4) {
+            const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+            const __m128 u = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(w, 8)), unit);
+            const __m128 r = _mm_mul_ps(_mm_add_ps(offset, _mm_mul_ps(span, u)), scale);
+            const __m128 keep = _mm_cmplt_ps(r, b);
+            _mm_storeu_ps(out + i, _mm_or_ps(_mm_and_ps(keep, r), _mm_andnot_ps(keep, below)));
+        }
+#endif
+        for (; i < n; i++) {
+            out[i] = FromUnit(static_cast<float>(words[i] >> 8) * 0x1.0p-24f);
+        }
+    }
+
+public:
+    typedef T result_type;
+
+    NodeUniformRealDistribution(T a = 0, T b = 1) : m_a(a), m_b(b) {
+        assert(b >= a && "Max must be greater or equal to min");
+        m_scale = std::isfinite(b - a) ? T(1) : T(2);
+        m_offset = a / m_scale;
+        m_span = b / m_scale - m_offset;
+        m_below = std::nextafter(b, a);
+    }
+
+    T a() const { return m_a; }
+    T b() const { return m_b; }
+    T min() const { return m_a; }
+    T max() const { return m_b; }
+
+    template<class GENERATOR>
+    T operator()(GENERATOR& generator) const {
+        if constexpr (std::is_same<T, double>::value) {
+            return FromUnit(rng_bits::NextDouble(generator));
+        }
+        else {
+            return FromUnit(rng_bits::NextFloat(generator));
+        }
+    }
+
+    /// \brief Write n numbers to out. Same numbers and engine consumption as n calls to operator().
+    /// \note Floats draw raw words in batches and convert them with SSE2. Doubles keep the scalar loop, without a
+    ///       64 bit integer to double instruction two SSE2 lanes do not beat one cvtsi2sd per number.
+    template<class GENERATOR>
+    void Fill(GENERATOR& generator, T* out, size_t n) const {
+        if constexpr (std::is_same<T, float>::value) {
+            uint32_t words[Batch];
+            while (n > 0) {
+                const size_t k = std::min(n, Batch);
+                rng_bits::Fill32(generator, words, k);
+                Convert(words, out, k);
+                out += k;
+                n -= k;
+            }
+        }
+        else {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = (*this)(generator);
+            }
+        }
+    }
+};
+
+namespace rng_traits {
+
+/// \brief DISTRIBUTION has Fill(generator, out, n)
+template<class DISTRIBUTION, class GENERATOR, class T, class = void>
+struct HasFill : std::false_type {};
+template<class DISTRIBUTION, class GENERATOR, class T>
+struct HasFill<DISTRIBUTION, GENERATOR, T, std::void_t<decltype(std::declval<const DISTRIBUTION&>().Fill(
+    std::declval<GENERATOR&>(), std::declval<T*>(), size_t(0)))>> : std::true_type {};
+
+} // end rng_traits namespace
+
 /// \class NodeRNG Base class for generating a random number using a random number generator and distribution
 /// \param T Types for distribution [min, max] and return
 /// \param Distribution Type of distribution
 /// \note Behaves like std distribution types, eg: min(), max(), operator()
 template<typename T, typename Distribution>
 class NodeRNG {
-    const Distribution m_distribution;
+    Distribution m_distribution;
 public:
+    typedef T result_type;
+
     NodeRNG(const T min, const T max) : m_distribution{min, max} {
         assert(max >= min && "Max must be greater or equal to min");
     }
 
     template<class Generator>
     const T operator()(Generator& generator) {
-        return static_cast<T>(const_cast<Distribution&>(m_distribution)(generator));
+        return static_cast<T>(m_distribution(generator));
+    }
+
+    /// \brief Write n numbers to out, same as n calls to operator(). Uses the distribution's batched Fill if it has one.
+    template<class Generator>
+    void Fill(Generator& generator, T* out, size_t n) {
+        if constexpr (rng_traits::HasFill<Distribution, Generator, T>::value) {
+            m_distribution.Fill(generator, out, n);
+        }
+        else {
+            std::generate(out, out + n, [this, &generator] () -> T { return (*this)(generator); });
+        }
     }
     const T min() const { return static_cast<T>(m_distribution.min()); }
     const T max() const { return static_cast<T>(m_distribution.max()); }
@@ -61,43 +379,24 @@ public:
     }
 };
 
-/// \brief Floating point types
-template <typename T>
-class NodeRNGUniformDistribution<T, std::enable_if_t<std::is_floating_point<T>::value>> : public NodeRNG<T, std::uniform_real_distribution<T>>
-{
-public:
-    NodeRNGUniformDistribution(const T min = std::numeric_limits<T>::min(), const T max = std::numeric_limits<T>::max()) : NodeRNG<T, std::uniform_real_distribution<T>>(min, max) {}
-};
-
-/// \brief Integer types (non 1 byte size)
-template <typename T>
-class NodeRNGUniformDistribution<T, std::enable_if_t<std::is_integral<T>::value && (sizeof(T) > 1)>> : public NodeRNG<T, std::uniform_int_distribution<T>> 
-{
-public:
-    NodeRNGUniformDistribution(const T min = std::numeric_limits<T>::min(), const T max = std::numeric_limits<T>::max()) : NodeRNG<T, std::uniform_int_distribution<T>> (min, max) {}
-};
-
-/// \brief int8_t type (will use int16_t for distribution)
+/// \brief Floating point types, [min, max)
 template <typename T>
-class NodeRNGUniformDistribution<T, std::enable_if_t<std::is_integral<T>::value
-                                                && std::is_same<int8_t, T>::value>> : public NodeRNG<T, std::uniform_int_distribution<int16_t>>
+class NodeRNGUniformDistribution<T, std::enable_if_t<std::is_floating_point<T>::value>> : public NodeRNG<T, NodeUniformRealDistribution<T>>
 {
 public:
-    NodeRNGUniformDistribution(const T min = std::numeric_limits<T>::min(), const T max = std::numeric_limits<T>::max()) : NodeRNG<T, std::uniform_int_distribution<int16_t>>(min, max) {}
+    NodeRNGUniformDistribution(const T min = std::numeric_limits<T>::lowest(), const T max = std::numeric_limits<T>::max()) : NodeRNG<T, NodeUniformRealDistribution<T>>(min, max) {}
 };
 
-/// \brief uint8_t type (will use uint16_t for distribution)
+/// \brief Integer types, including int8_t/uint8_t
 template <typename T>
-class NodeRNGUniformDistribution<T, std::enable_if_t<std::is_integral<T>::value
-                                                && std::is_same<uint8_t, T>::value>> : public NodeRNG<T, std::uniform_int_distribution<uint16_t>>
+class NodeRNGUniformDistribution<T, std::enable_if_t<std::is_integral<T>::value>> : public NodeRNG<T, NodeUniformIntDistribution<T>>
 {
 public:
-    NodeRNGUniformDistribution(const T min = std::numeric_limits<T>::min(), const T max = std::numeric_limits<T>::max()) : NodeRNG<T, std::uniform_int_distribution<uint16_t>>(min, max) {}
+    NodeRNGUniformDistribution(const T min = std::numeric_limits<T>::min(), const T max = std::numeric_limits<T>::max()) : NodeRNG<T, NodeUniformIntDistribution<T>> (min, max) {}
 };
 
 /**
- * TODO: Other distributions
- *  
+ * Non-uniform distributions: see NodeDistributions.h
  */
 
 }
\ No newline at end of file
@@ -1,6 +1,17 @@
 #include "NodeRand.h"
 #include "NodeRandStream.h"
+#include "NodeRandFill.h"
+#include "NodeRandDistribution.h"
+#include "NodeRandAliasTable.h"
+#include "NodeRandRing.h"
+#include "NodeRandBatches.h"
+#include "NodeGeneratorPool.h"
+#include "NodeRandState.h"
+#include "NodeShuffle.h"
+#include "NodeRandTypes.h"
+#include "NodeDistributions.h"
 #include "NodeRNG.h"
+#include "NodeEngines.h"
 #include "napi_extensions.h"
 
 #include <node_api.h>
@@ -11,49 +22,62 @@
 #include <sstream>
 #include <thread>
 #include <chrono>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <tuple>
+#include <vector>
 
 using namespace node_rand;
 using namespace napi_extensions;
 
-// template<class GENERATOR>
-// napi_ref NodeRand<GENERATOR>::m_constructor;
-template<class GENERATOR>
-napi_ref NodeRand<GENERATOR>::m_readableCtor;
-
 template<class GENERATOR>
 napi_value NodeRand<GENERATOR>::SetReadable(napi_env env, napi_callback_info info)
 {
   size_t argc = 1;
   napi_value args[1];
   CheckStatus(napi_get_cb_info(env, info, &argc, args, nullptr, nullptr), env, "Failed to get callback info in SetReadable");
-  CheckStatus(napi_create_reference(env, args[0], 1, &m_readableCtor), env, "Failed to create NodeJS Readable reference");
-  std::cout << "SetReadable" << __FUNCTION__ << std::endl;
+  NapiEnvData::Get(env).SetRef(NapiEnvData::Key<ReadableTag>(), args[0]);
+  NODE_RAND_LOG("SetReadable" << __FUNCTION__);
   return nullptr;
 }
 
 template<class GENERATOR>
-NodeRand<GENERATOR>::NodeRand() : m_seedReset(false), m_GlobalBuffer(), m_generator(std::random_device{}()) {
-  std::cout << "new NodeRand" << std::endl;
+napi_ref NodeRand<GENERATOR>::ReadableCtor(napi_env env)
+{
+  return NapiEnvData::Get(env).GetRef(NapiEnvData::Key<ReadableTag>());
 }
 
 template<class GENERATOR>
-napi_value NodeRand<GENERATOR>::SetSeed(napi_env env, napi_callback_info info) {
-  NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+NodeRand<GENERATOR>::NodeRand() : m_seedReset(false), m_GlobalBuffer(), m_generator(NodeGlobalBuffer::RandomSeed()) {
+  NODE_RAND_LOG("new NodeRand");
+}
 
-  // Get seed if specified. If not use std::random_device()
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::SetSeed(napi_env env, napi_callback_info info) {
+  // Get seed if specified. If not use a random seed
   size_t argc = 1;
-  CheckStatus(napi_get_cb_info(env, info, &argc, nullptr, nullptr, nullptr), env, "SetSeed() get cb info");
+  napi_value argv[1];
+  napi_value jsthis;
+  CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "SetSeed() get cb info");
+
+  NodeRand<GENERATOR>* rSeed = nullptr;
+  CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&rSeed)), env, "SetSeed() unwrap");
+  if (rSeed == nullptr) {
+    return nullptr;
+  }
   rSeed->m_seedReset = true;
 
   if (argc == 0) {
-    std::cout << "Seed generator with random_device" << std::endl;
-    rSeed->m_GlobalBuffer.SetSeed(std::random_device{}());
+    NODE_RAND_LOG("Seed generator with random seed");
+    rSeed->m_GlobalBuffer.SetSeed(NodeGlobalBuffer::RandomSeed());
   } 
   else {
     NapiArgInt64 arg0;
-    GetArgs(env, info, arg0);
+    arg0.SetVal(env, argv[0]);
     int64_t seed = arg0.GetVal();
-    std::cout << "Seed generator with set seed: " << seed << std::endl;
+    NODE_RAND_LOG("Seed generator with set seed: " << seed);
     
     rSeed->m_GlobalBuffer.SetSeed(seed);
   }
@@ -62,86 +86,788 @@ napi_value NodeRand<GENERATOR>::SetSeed(napi_env env, napi_callback_info info) {
 }
 
 template<class GENERATOR>
-napi_value NodeRand<GENERATOR>::Generate(napi_env env, napi_callback_info info) {
+GENERATOR& NodeRand<GENERATOR>::Generator() {
+  if (m_seedReset) {
+    auto fakeSeed = NextSeed();
+    NODE_RAND_LOG("Setting fake seed: " << fakeSeed);
+    m_generator.seed(fakeSeed);
+    m_seedReset = false;
+  }
+  return m_generator;
+}
+
+template<class GENERATOR>
+int64_t NodeRand<GENERATOR>::StreamSeed(const StreamOptions& options) {
+  if (options.hasStreamId) {
+    // what Generator() of Fork(streamId) is seeded with
+    return NodeGlobalBuffer::PseudoSeed(m_GlobalBuffer.Fork(options.streamId), 0);
+  }
+  return NextSeed();
+}
+
+template<class GENERATOR>
+int64_t NodeRand<GENERATOR>::NextSeed() {
+  NODE_RAND_STAT(Stats(), AddSeedRefill());
+  return m_GlobalBuffer.Next();
+}
+
+template<class GENERATOR>
+const std::shared_ptr<NodeStats>& NodeRand<GENERATOR>::Stats() {
+  if (STATS_ENABLED && m_stats == nullptr) {
+    m_stats = std::make_shared<NodeStats>();
+  }
+  return m_stats;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Fork(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "Fork() get cb info");
+    assert(argc == 1 && "invalid number of arguments");
+
+    NodeRand<GENERATOR>* rSeed = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&rSeed)), env, "Fork() unwrap");
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    uint64_t streamId = 0;
+    if (!GetTypedValue(env, argv[0], streamId)) {
+      napi_throw_type_error(env, nullptr, "streamId must be an integer in [0, 2^64), number or BigInt");
+      return nullptr;
+    }
+
+    NodeRand<GENERATOR>* fork = nullptr;
+    napi_value result = NodeRand<GENERATOR>::NewInstance(env, &fork);
+    fork->m_GlobalBuffer.SetSeed(rSeed->m_GlobalBuffer.Fork(streamId));
+    fork->m_seedReset = true;
+    return result;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::GetState(napi_env env, napi_callback_info info) {
     NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
 
-    
+    NodeRandState state;
+    state.engine = EngineId<GENERATOR>::value;
+    state.seed = rSeed->m_GlobalBuffer.Seed();
+    state.index = rSeed->m_GlobalBuffer.Index();
+    state.flags = rSeed->m_seedReset ? STATE_SEED_RESET : 0;
+    state.words = EngineWords(rSeed->m_generator);
+    const std::vector<uint8_t> bytes = EncodeState(state);
 
-    // I have generator from template
-    // I need distribution from args
+    napi_value result = nullptr;
+    CheckStatus(napi_create_buffer_copy(env, bytes.size(), bytes.data(), nullptr, &result), env, "GetState() create buffer");
+    return result;
+}
 
-    // enum type Distribution - The distribution type to use
-    // enum type T - uint8_t, int8_t, ... bigint64_t
-    // int64_t arg0 min
-    // int64_t arg1 max
-    // validate arg0 and arg1 match type T bounds
-    // return int64_t
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::SetState(napi_env env, napi_callback_info info) {
+    NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
 
-    // If bigint64 or biguint64, same but return must match and no validation is needed
+    size_t argc = 1;
+    napi_value argv[1];
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr), env, "SetState() get cb info");
+    assert(argc == 1 && "invalid number of arguments");
 
-    if (rSeed->m_seedReset) {
-      auto fakeSeed = rSeed->m_GlobalBuffer.Next();
-      std::cout << "Setting fake seed: " << fakeSeed << std::endl;
-      rSeed->m_generator.seed(fakeSeed);
-      rSeed->m_seedReset = false;
+    // Buffer is a Uint8Array
+    NapiArgTypedArray arg0;
+    arg0.SetVal(env, argv[0]);
+    NapiTypedArrayInfo array = arg0.GetVal();
+    if (array.type != napi_uint8_array) {
+      napi_throw_type_error(env, nullptr, "Expecting the Buffer returned by GetState()");
+      return nullptr;
     }
 
-    NapiArgInt64 arg0, arg1;
-    GetArgs(env, info, arg0, arg1);
+    NodeRandState state;
+    std::string error = DecodeState(static_cast<const uint8_t*>(array.data), array.length, state);
+    if (error.empty() && state.engine != EngineId<GENERATOR>::value) {
+      std::stringstream ss;
+      ss << "State of engine " << state.engine << " cannot be restored into engine " << EngineId<GENERATOR>::value;
+      error = ss.str();
+    }
+
+    // restore into a copy, a corrupt state leaves the instance untouched
+    GENERATOR generator(rSeed->m_generator);
+    if (error.empty() && !SetEngineWords(generator, state.words)) {
+      error = "Corrupt engine state";
+    }
+    if (!error.empty()) {
+      napi_throw_type_error(env, nullptr, error.c_str());
+      return nullptr;
+    }
+
+    rSeed->m_generator = generator;
+    rSeed->m_GlobalBuffer.SetState(state.seed, state.index);
+    rSeed->m_seedReset = (state.flags & STATE_SEED_RESET) != 0;
+    return nullptr;
+}
+
+/// \brief Set a number property of object
+static void SetNumber(napi_env env, napi_value object, const char* name, double number) {
+  napi_value value = nullptr;
+  CheckStatus(napi_create_double(env, number, &value), env, "Failed to create double");
+  CheckStatus(napi_set_named_property(env, object, name, value), env, "Failed to set stats property");
+}
+
+/// \brief { count, min, max, mean, p50, p90, p99, p999 } in ns
+static napi_value CreateLatencyObject(napi_env env, const LatencySummary& summary) {
+  napi_value object = nullptr;
+  CheckStatus(napi_create_object(env, &object), env, "Failed to create latency object");
+  SetNumber(env, object, "count", static_cast<double>(summary.count));
+  SetNumber(env, object, "min", static_cast<double>(summary.min));
+  SetNumber(env, object, "max", static_cast<double>(summary.max));
+  SetNumber(env, object, "mean", summary.mean);
+  SetNumber(env, object, "p50", static_cast<double>(summary.p50));
+  SetNumber(env, object, "p90", static_cast<double>(summary.p90));
+  SetNumber(env, object, "p99", static_cast<double>(summary.p99));
+  SetNumber(env, object, "p999", static_cast<double>(summary.p999));
+  return object;
+}
 
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::GetStats(napi_env env, napi_callback_info info) {
+    NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    NodeStatsSnapshot snapshot;
+    if (rSeed->m_stats != nullptr) {
+      snapshot = rSeed->m_stats->Snapshot();
+    }
+
+    napi_value result = nullptr, enabled = nullptr;
+    CheckStatus(napi_create_object(env, &result), env, "Failed to create stats object");
+    CheckStatus(napi_get_boolean(env, STATS_ENABLED, &enabled), env, "Failed to create boolean");
+    CheckStatus(napi_set_named_property(env, result, "enabled", enabled), env, "Failed to set stats property");
+    SetNumber(env, result, "valuesGenerated", static_cast<double>(snapshot.valuesGenerated));
+    SetNumber(env, result, "chunksPushed", static_cast<double>(snapshot.chunksPushed));
+    SetNumber(env, result, "queueDepth", static_cast<double>(snapshot.queueDepth));
+    SetNumber(env, result, "maxQueueDepth", static_cast<double>(snapshot.maxQueueDepth));
+    SetNumber(env, result, "backpressureStalls", static_cast<double>(snapshot.backpressureStalls));
+    SetNumber(env, result, "queueFullStalls", static_cast<double>(snapshot.queueFullStalls));
+    SetNumber(env, result, "seedRefills", static_cast<double>(snapshot.seedRefills));
+    CheckStatus(napi_set_named_property(env, result, "chunkGenerateNs", CreateLatencyObject(env, snapshot.chunkGenerate)),
+      env, "Failed to set stats property");
+    CheckStatus(napi_set_named_property(env, result, "chunkPushNs", CreateLatencyObject(env, snapshot.chunkPush)),
+      env, "Failed to set stats property");
+    return result;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Generate(napi_env env, napi_callback_info info) {
+    // min, max, (optional) type
+    size_t argc = 3;
+    napi_value argv[3];
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "Generate() get cb info");
+    assert((argc == 2 || argc == 3) && "invalid number of arguments");
+
+    NodeRand<GENERATOR>* rSeed = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&rSeed)), env, "Generate() unwrap");
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    if (argc == 3) {
+      NapiArgUint32 arg2;
+      arg2.SetVal(env, argv[2]);
+      return GenerateTyped(env, rSeed, argv[0], argv[1], static_cast<napi_typedarray_type>(arg2.GetVal()));
+    }
+
+    NapiArgInt64 arg0, arg1;
+    arg0.SetVal(env, argv[0]);
+    arg1.SetVal(env, argv[1]);
     int64_t min =  arg0.GetVal();
     int64_t max =  arg1.GetVal();
 
     if (max < min) {
-      // TODO: Replace all errors with this call
       std::stringstream ss;
       ss << "Max < Min. Min: " << min << ", Max: " << max << std::endl;
         napi_throw_type_error(env, nullptr, ss.str().c_str());
         return nullptr;
     }
     
-    // TODO: Need to grab this from Args
-    NodeRNGUniformDistribution distribution(min, max);
+    // Cheap to build per call, no divisions unless a rejection happens
+    NodeRNGUniformDistribution<int64_t> distribution(min, max);
+    NODE_RAND_STAT(rSeed->Stats(), AddValues(1));
 
     napi_value result;
-    CheckStatus(napi_create_int64(env, distribution(rSeed->m_generator), &result), 
+    CheckStatus(napi_create_int64(env, distribution(rSeed->Generator()), &result), 
       env, "Failed to create int64");
 
     return result;
 }
 
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::GenerateTyped(napi_env env, NodeRand<GENERATOR>* rSeed, napi_value minValue, napi_value maxValue,
+  napi_typedarray_type type) {
+    napi_value result = nullptr;
+    const bool supported = VisitType(type, [&] (auto tag) {
+      typedef typename decltype(tag)::type T;
+      T min{}, max{};
+      if (!GetTypedRange(env, minValue, maxValue, type, min, max)) {
+        return;
+      }
+      NodeRNGUniformDistribution<T> distribution(min, max);
+      NODE_RAND_STAT(rSeed->Stats(), AddValues(1));
+      result = CreateTypedValue(env, distribution(rSeed->Generator()));
+    });
+
+    if (!supported) {
+      std::stringstream ss;
+      ss << "Unsupported type. Expecting a Type enum value. type: " << type << std::endl;
+      napi_throw_type_error(env, nullptr, ss.str().c_str());
+    }
+    return result;
+}
+
 // TODO: Change to async function so that push can be called after return
 template<class GENERATOR>
 napi_value NodeRand<GENERATOR>::GenerateSequenceStream(napi_env env, napi_callback_info info) {
     NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    // min, max, count, (optional) options
+    size_t argc = 4;
+    napi_value argv[4];
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr), env, "GenerateSequenceStream() get cb info");
+    assert((argc == 3 || argc == 4) && "invalid number of arguments");
+
+    NapiArgUint32 arg2;
+    arg2.SetVal(env, argv[2]);
+    uint32_t count = arg2.GetVal();
+
+    StreamOptions options;
+    if (!GetStreamOptions(env, argc == 4 ? argv[3] : nullptr, options)) {
+      return nullptr;
+    }
+
+    napi_value result = nullptr;
+    VisitType(options.type, [&] (auto tag) {
+      typedef typename decltype(tag)::type T;
+      T min{}, max{};
+      if (!GetTypedRange(env, argv[0], argv[1], options.type, min, max)) {
+        return;
+      }
+
+      // get thread-safe seed off global, or the stream's fork
+      int64_t seed = rSeed->StreamSeed(options);
+
+      // Return new instance of NodeRandStream
+      NODE_RAND_LOG("GenerateSequenceStream seed: " << seed);
+
+      NodeRNGUniformDistribution<T> d(min, max);
+      result = NodeRandStream<T, GENERATOR, NodeRNGUniformDistribution<T>>::NewInstance(env, ReadableCtor(env), seed, d, count, options,
+        rSeed->Stats());
+    });
+    return result;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::GenerateInto(napi_env env, napi_callback_info info) {
+    NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    FillTarget target;
+    if (!NodeRandFill<GENERATOR>::GetTarget(env, info, target)) {
+      return nullptr;
+    }
+    NODE_RAND_STAT(rSeed->Stats(), AddValues(target.length));
+
+    if (target.threads > 0) {
+      // parallel sequence, same numbers as GenerateIntoAsync and GenerateSequenceStream with threads set
+      NodeRandFill<GENERATOR>::FillParallel(rSeed->NextSeed(), target);
+    }
+    else {
+      NodeRandFill<GENERATOR>::Fill(rSeed->Generator(), target);
+    }
+
+    size_t argc = 1;
+    napi_value typed_array;
+    CheckStatus(napi_get_cb_info(env, info, &argc, &typed_array, nullptr, nullptr), env, "GenerateInto() get cb info");
+    return typed_array;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::GenerateIntoAsync(napi_env env, napi_callback_info info) {
+    NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    FillTarget target;
+    if (!NodeRandFill<GENERATOR>::GetTarget(env, info, target)) {
+      return nullptr;
+    }
+    // counted when requested
+    NODE_RAND_STAT(rSeed->Stats(), AddValues(target.length));
+
+    size_t argc = 1;
+    napi_value typed_array;
+    CheckStatus(napi_get_cb_info(env, info, &argc, &typed_array, nullptr, nullptr), env, "GenerateIntoAsync() get cb info");
+
+    // get thread-safe seed off global
+    return NodeRandFill<GENERATOR>::FillAsync(env, typed_array, target, rSeed->NextSeed());
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::SharedRing(napi_env env, napi_callback_info info) {
+    NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    // min, max, (optional) options
+    size_t argc = 3;
+    napi_value argv[3];
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr), env, "SharedRing() get cb info");
+    assert((argc == 2 || argc == 3) && "invalid number of arguments");
+
+    RingOptions options;
+    if (!GetRingOptions(env, argc == 3 ? argv[2] : nullptr, options)) {
+      return nullptr;
+    }
+
+    napi_value result = nullptr;
+    VisitType(options.stream.type, [&] (auto tag) {
+      typedef typename decltype(tag)::type T;
+      T min{}, max{};
+      if (!GetTypedRange(env, argv[0], argv[1], options.stream.type, min, max)) {
+        return;
+      }
+
+      // same seed as GenerateSequenceStream, slots in position order hold the numbers it would emit
+      GENERATOR generator(static_cast<uint64_t>(rSeed->StreamSeed(options.stream)));
+      NodeRNGUniformDistribution<T> distribution(min, max);
+      std::shared_ptr<NodeStats> stats = rSeed->Stats();
+      result = NodeRandRing::Create(env, options, sizeof(T), [generator, distribution, stats] (void* out, size_t count) mutable {
+        const StatsClock::time_point start = StatsNow();
+        distribution.Fill(generator, static_cast<T*>(out), count);
+        NODE_RAND_STAT(stats, ChunkGenerated(count, ElapsedNs(start)));
+      });
+    });
+    return result;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::GenerateBatches(napi_env env, napi_callback_info info) {
+    NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    // min, max, count, (optional) options
+    size_t argc = 4;
+    napi_value argv[4];
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr), env, "GenerateBatches() get cb info");
+    assert((argc == 3 || argc == 4) && "invalid number of arguments");
 
-    NapiArgInt64 arg0, arg1;
     NapiArgUint32 arg2;
-    GetArgs(env, info, arg0, arg1, arg2);
+    arg2.SetVal(env, argv[2]);
+    uint32_t count = arg2.GetVal();
+
+    StreamOptions options;
+    if (!GetStreamOptions(env, argc == 4 ? argv[3] : nullptr, options)) {
+      return nullptr;
+    }
+    if (options.threads > 0) {
+      napi_throw_range_error(env, nullptr, "GenerateBatches does not support threads, use GenerateIntoAsync with threads instead");
+      return nullptr;
+    }
+
+    napi_value result = nullptr;
+    VisitType(options.type, [&] (auto tag) {
+      typedef typename decltype(tag)::type T;
+      T min{}, max{};
+      if (!GetTypedRange(env, argv[0], argv[1], options.type, min, max)) {
+        return;
+      }
+
+      // same seed as GenerateSequenceStream, batches in order hold the numbers it would emit
+      GENERATOR generator(static_cast<uint64_t>(rSeed->StreamSeed(options)));
+      NodeRNGUniformDistribution<T> distribution(min, max);
+      std::shared_ptr<NodeStats> stats = rSeed->Stats();
+      result = NodeRandBatches::Create(env, count, options, sizeof(T), [generator, distribution, stats] (void* out, size_t n) mutable {
+        const StatsClock::time_point start = StatsNow();
+        distribution.Fill(generator, static_cast<T*>(out), n);
+        NODE_RAND_STAT(stats, ChunkGenerated(n, ElapsedNs(start)));
+      });
+    });
+    return result;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Jump(napi_env env, napi_callback_info info) {
+    NodeRand<GENERATOR>* rSeed = GetSelf<NodeRand<GENERATOR>>(env, info);
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+    rSeed->Generator().jump();
+    return nullptr;
+}
 
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Advance(napi_env env, napi_callback_info info) {
+    NapiArgInt64 arg0;
+    NodeRand<GENERATOR>* rSeed = GetSelfArgs<NodeRand<GENERATOR>>(env, info, arg0);
+    int64_t n = arg0.GetVal();
+
+    if (n < 0) {
+      std::stringstream ss;
+      ss << "Advance count must be >= 0. Count: " << n << std::endl;
+      napi_throw_range_error(env, nullptr, ss.str().c_str());
+      return nullptr;
+    }
+
+    rSeed->Generator().advance(static_cast<uint64_t>(n));
+    return nullptr;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::UniformInt(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "UniformInt() get cb info");
+    assert(argc == 2 && "invalid number of arguments");
+
+    NodeRand<GENERATOR>* rSeed = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&rSeed)), env, "UniformInt() unwrap");
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    NapiArgInt64 arg0, arg1;
+    arg0.SetVal(env, argv[0]);
+    arg1.SetVal(env, argv[1]);
     int64_t min = arg0.GetVal();
     int64_t max = arg1.GetVal();
-    uint32_t count = arg2.GetVal();
 
-    // get thread-safe seed off global
-    int64_t seed = rSeed->m_GlobalBuffer.Next();
+    if (max < min) {
+      std::stringstream ss;
+      ss << "Max < Min. Min: " << min << ", Max: " << max << std::endl;
+      napi_throw_type_error(env, nullptr, ss.str().c_str());
+      return nullptr;
+    }
+
+    return NodeRandDistribution<GENERATOR, NodeRNGUniformDistribution<int64_t>>::Create(env, jsthis, rSeed,
+      NodeRNGUniformDistribution<int64_t>(min, max));
+}
+
+template<class GENERATOR>
+template<class DISTRIBUTION, size_t N>
+napi_value NodeRand<GENERATOR>::NewDistribution(napi_env env, napi_callback_info info) {
+    size_t argc = N;
+    napi_value argv[N];
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "NewDistribution() get cb info");
+    assert(argc == N && "invalid number of arguments");
+
+    NodeRand<GENERATOR>* rSeed = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&rSeed)), env, "NewDistribution() unwrap");
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    std::array<double, N> params;
+    for (size_t i = 0; i < N; i++) {
+      NapiArgDouble arg;
+      arg.SetVal(env, argv[i]);
+      params[i] = arg.GetVal();
+    }
+
+    const char* error = std::apply(DISTRIBUTION::Check, params);
+    if (error != nullptr) {
+      std::stringstream ss;
+      ss << error << ". Got:";
+      for (double param : params) {
+        ss << " " << param;
+      }
+      ss << std::endl;
+      napi_throw_range_error(env, nullptr, ss.str().c_str());
+      return nullptr;
+    }
+
+    return NodeRandDistribution<GENERATOR, DISTRIBUTION>::Create(env, jsthis, rSeed, std::make_from_tuple<DISTRIBUTION>(params));
+}
 
-    // Return new instance of NodeRandStream
-    std::cout << "GenerateSequenceStream seed: " << seed << std::endl;
-    GENERATOR g(seed);
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Normal(napi_env env, napi_callback_info info) {
+    return NewDistribution<NodeNormalDistribution, 2>(env, info);
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::LogNormal(napi_env env, napi_callback_info info) {
+    return NewDistribution<NodeLogNormalDistribution, 2>(env, info);
+}
 
-    // TODO: Switch this to use NodeRNGUniformDistribution based off min/max in NewInstance
-    std::uniform_int_distribution<int64_t> d(min, max);
-    return NodeRandStream<int64_t, GENERATOR, std::uniform_int_distribution<int64_t>>::NewInstance(env, rSeed->m_readableCtor, g, d, count);
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Exponential(napi_env env, napi_callback_info info) {
+    return NewDistribution<NodeExponentialDistribution, 1>(env, info);
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Gamma(napi_env env, napi_callback_info info) {
+    return NewDistribution<NodeGammaDistribution, 2>(env, info);
 }
 
-/* Register this as an ES Module */
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Poisson(napi_env env, napi_callback_info info) {
+    return NewDistribution<NodePoissonDistribution, 1>(env, info);
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Binomial(napi_env env, napi_callback_info info) {
+    return NewDistribution<NodeBinomialDistribution, 2>(env, info);
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Discrete(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "Discrete() get cb info");
+    assert(argc == 1 && "invalid number of arguments");
+
+    NodeRand<GENERATOR>* rSeed = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&rSeed)), env, "Discrete() unwrap");
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    // shares a prebuilt AliasTable, or builds an unregistered table from weights
+    std::shared_ptr<const NodeAliasTable> table = NodeRandAliasTable::GetTable(env, argv[0]);
+    if (table == nullptr) {
+      return nullptr;
+    }
+
+    return NodeRandDistribution<GENERATOR, NodeDiscreteDistribution>::Create(env, jsthis, rSeed, NodeDiscreteDistribution(std::move(table)));
+}
+
+/// \brief Read an integer count in [0, max]. Throws a JS RangeError and returns false otherwise.
+static bool GetCount(napi_env env, napi_value value, const char* name, uint64_t max, uint64_t& count) {
+  NapiArgDouble arg;
+  arg.SetVal(env, value);
+  const double d = arg.GetVal();
+  if (!(d >= 0 && d <= static_cast<double>(max) && d == std::floor(d))) {
+    std::stringstream ss;
+    ss << name << " must be an integer between 0 and " << max << ". " << name << ": " << d << std::endl;
+    napi_throw_range_error(env, nullptr, ss.str().c_str());
+    return false;
+  }
+  count = static_cast<uint64_t>(d);
+  return true;
+}
+
+/// \brief New Uint32Array of length elements
+/// \return nullptr with the JS error pending if the arraybuffer could not be allocated
+static napi_value CreateUint32Array(napi_env env, size_t length, uint32_t** data) {
+  napi_value buffer, array;
+  if (napi_create_arraybuffer(env, length * sizeof(uint32_t), reinterpret_cast<void**>(data), &buffer) != napi_ok) {
+    // allocation failed, the JS error is pending
+    return nullptr;
+  }
+  CheckStatus(napi_create_typedarray(env, napi_uint32_array, length, buffer, 0, &array), env, "Failed to create Uint32Array");
+  return array;
+}
+
+template<class GENERATOR>
+void NodeRand<GENERATOR>::ShuffleData(napi_typedarray_type type, void* data, size_t length, uint32_t threads) {
+    // elements are only moved, shuffle them as unsigned integers of the same width
+    VisitElementWidth(type, [&] (auto tag) {
+      typedef typename decltype(tag)::type U;
+      if (threads > 0) {
+        ParallelShuffle<U, GENERATOR>(NextSeed(), threads, static_cast<U*>(data), length);
+      }
+      else {
+        node_rand::Shuffle(Generator(), static_cast<U*>(data), length);
+      }
+    });
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Shuffle(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "Shuffle() get cb info");
+    assert((argc == 1 || argc == 2) && "invalid number of arguments");
+
+    NodeRand<GENERATOR>* rSeed = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&rSeed)), env, "Shuffle() unwrap");
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    NapiArgTypedArray arg0;
+    arg0.SetVal(env, argv[0]);
+    NapiTypedArrayInfo array = arg0.GetVal();
+
+    uint32_t threads = 0;
+    if (!GetThreadsOption(env, NapiOptions(env, argc == 2 ? argv[1] : nullptr), threads)) {
+      return nullptr;
+    }
+
+    rSeed->ShuffleData(array.type, array.data, array.length, threads);
+    return array.value;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::Permutation(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "Permutation() get cb info");
+    assert((argc == 1 || argc == 2) && "invalid number of arguments");
+
+    NodeRand<GENERATOR>* rSeed = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&rSeed)), env, "Permutation() unwrap");
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    uint64_t n = 0;
+    uint32_t threads = 0;
+    if (!GetCount(env, argv[0], "n", MAX_SAMPLE_POPULATION, n)
+        || !GetThreadsOption(env, NapiOptions(env, argc == 2 ? argv[1] : nullptr), threads)) {
+      return nullptr;
+    }
+
+    uint32_t* data = nullptr;
+    napi_value result = CreateUint32Array(env, static_cast<size_t>(n), &data);
+    if (result == nullptr) {
+        return nullptr;
+    }
+    std::iota(data, data + n, uint32_t(0));
+    rSeed->ShuffleData(napi_uint32_array, data, static_cast<size_t>(n), threads);
+    return result;
+}
+
+template<class GENERATOR>
+napi_value NodeRand<GENERATOR>::SampleWithoutReplacement(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "SampleWithoutReplacement() get cb info");
+    assert(argc == 2 && "invalid number of arguments");
+
+    NodeRand<GENERATOR>* rSeed = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&rSeed)), env, "SampleWithoutReplacement() unwrap");
+    if (rSeed == nullptr) {
+        return nullptr;
+    }
+
+    uint64_t n = 0, k = 0;
+    if (!GetCount(env, argv[0], "n", MAX_SAMPLE_POPULATION, n) || !GetCount(env, argv[1], "k", n, k)) {
+      return nullptr;
+    }
+
+    uint32_t* data = nullptr;
+    napi_value result = CreateUint32Array(env, static_cast<size_t>(k), &data);
+    if (result == nullptr) {
+        return nullptr;
+    }
+    node_rand::SampleWithoutReplacement(rSeed->Generator(), n, data, static_cast<size_t>(k));
+    return result;
+}
+
+/// \brief Register NodeRand<GENERATOR> as className, and its distribution handle classes (not exported)
+template<class GENERATOR>
+static void InitEngine(const std::string& className, napi_env env, napi_value exports) {
+  NodeRand<GENERATOR>::Init(className, env, exports);
+  NodeRandDistribution<GENERATOR, NodeRNGUniformDistribution<int64_t>>::Init(className + "_UniformInt", env, nullptr);
+  NodeRandDistribution<GENERATOR, NodeNormalDistribution>::Init(className + "_Normal", env, nullptr);
+  NodeRandDistribution<GENERATOR, NodeLogNormalDistribution>::Init(className + "_LogNormal", env, nullptr);
+  NodeRandDistribution<GENERATOR, NodeExponentialDistribution>::Init(className + "_Exponential", env, nullptr);
+  NodeRandDistribution<GENERATOR, NodeGammaDistribution>::Init(className + "_Gamma", env, nullptr);
+  NodeRandDistribution<GENERATOR, NodePoissonDistribution>::Init(className + "_Poisson", env, nullptr);
+  NodeRandDistribution<GENERATOR, NodeBinomialDistribution>::Init(className + "_Binomial", env, nullptr);
+  NodeRandDistribution<GENERATOR, NodeDiscreteDistribution>::Init(className + "_Discrete", env, nullptr);
+}
+
+/// \brief Export the Type enum, { Int8: napi_int8_array, ... }. See NodeRandTypes.h
+static void InitTypes(napi_env env, napi_value exports) {
+  napi_value types = nullptr;
+  CheckStatus(napi_create_object(env, &types), env, "Failed to create Type enum");
+  for (const NodeRandTypeInfo& info : SUPPORTED_TYPES) {
+    napi_value value = nullptr;
+    CheckStatus(napi_create_uint32(env, info.type, &value), env, "Failed to create Type enum value");
+    CheckStatus(napi_set_named_property(env, types, info.name, value), env, "Failed to set Type enum value");
+  }
+  CheckStatus(napi_set_named_property(env, exports, "Type", types), env, "Failed to export Type enum");
+}
+
+/// \brief SetGeneratorThreads(threads). Streams created afterwards produce on a dedicated pool of threads instead of
+///        the libuv threadpool, 0 goes back to the libuv threadpool. See NodeGeneratorPool.h
+static napi_value SetGeneratorThreads(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  CheckStatus(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr), env, "SetGeneratorThreads get cb info");
+  assert(argc == 1 && "invalid number of arguments");
+
+  NapiArgUint32 arg0;
+  arg0.SetVal(env, argv[0]);
+  const uint32_t threads = arg0.GetVal();
+  if (threads > MAX_GENERATOR_THREADS) {
+    std::stringstream ss;
+    ss << "threads must be between 0 and " << MAX_GENERATOR_THREADS << ". threads: " << threads << std::endl;
+    napi_throw_range_error(env, nullptr, ss.str().c_str());
+    return nullptr;
+  }
+  NodeGeneratorPool::Instance().SetThreads(threads);
+  return nullptr;
+}
+
+/// \brief GetGeneratorThreads(). Threads of the generator pool, 0 while streams use the libuv threadpool.
+static napi_value GetGeneratorThreads(napi_env env, napi_callback_info info) {
+  napi_value result;
+  CheckStatus(napi_create_uint32(env, NodeGeneratorPool::Instance().Threads(), &result), env, "Failed to create uint32");
+  return result;
+}
+
+/// \brief Export the process wide generator pool settings
+static void InitGeneratorPool(napi_env env, napi_value exports) {
+  napi_property_descriptor props[] = {
+    { "SetGeneratorThreads", 0, SetGeneratorThreads, 0, 0, 0, napi_default, 0 },
+    { "GetGeneratorThreads", 0, GetGeneratorThreads, 0, 0, 0, napi_default, 0 }
+  };
+  CheckStatus(napi_define_properties(env, exports, 2, props), env, "Failed to export generator pool functions");
+}
+
+/* Register this as an ES Module. Runs once per env (main thread, every worker_thread), all JS state is per env, see NapiEnvData */
 napi_value Init(napi_env env, napi_value exports) {
-  NodeRand<std::mt19937>::Init("NodeRand_mt19937", env, exports);
-  NodeRand<std::mt19937_64>::Init("NodeRand_mt19937_64", env, exports);
-  std::cout << "done" << std::endl;
+  InitTypes(env, exports);
+  InitGeneratorPool(env, exports);
+  NodeRandAliasTable::Init("AliasTable", env, exports);
+  NodeRandRing::Init("RandomRing", env, nullptr);
+  // exported for index.js to make handles async iterable
+  NodeRandBatches::Init("RandomBatches", env, exports);
+  InitEngine<std::mt19937>("NodeRand_mt19937", env, exports);
+  InitEngine<std::mt19937_64>("NodeRand_mt19937_64", env, exports);
+  InitEngine<philox4x32>("NodeRand_philox4x32", env, exports);
+  InitEngine<threefry4x64>("NodeRand_threefry4x64", env, exports);
+  InitEngine<xoshiro256ss>("NodeRand_xoshiro256ss", env, exports);
+  InitEngine<pcg64>("NodeRand_pcg64", env, exports);
+  InitEngine<splitmix64>("NodeRand_splitmix64", env, exports);
+  NODE_RAND_LOG("done");
   return exports;
 }
 
-/* Register this as an ES Module */
-NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
+/* Context aware, can be loaded by several envs of the process at once */
+NAPI_MODULE_INIT() {
+  return Init(env, exports);
+}
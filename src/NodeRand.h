@@ -6,17 +6,28 @@
 #include <memory>
 #include <iostream>
 #include "NodeGlobalBuffer.h"
+#include "NodeEngines.h"
+#include "NodeStats.h"
 #include "napi_extensions.h"
 
 namespace node_rand {
 
+template<class GENERATOR, class DISTRIBUTION>
+class NodeRandDistribution;
+
+struct StreamOptions;
+
 /// \class NodeRand
 /// \brief c++ addon to generate reproducible random number sequences based off a seed
 template<class GENERATOR>
 class NodeRand : public napi_extensions::NapiObjectWrap<NodeRand<GENERATOR>> {
 
-    // reference for NodeJS Readable ctor
-    static napi_ref m_readableCtor;
+    // distribution handles draw from m_generator
+    template<class G, class D>
+    friend class NodeRandDistribution;
+
+    // key of the NodeJS Readable ctor in NapiEnvData
+    struct ReadableTag {};
 
     // signal seed reset
     bool m_seedReset;
@@ -24,12 +35,17 @@ class NodeRand : public napi_extensions::NapiObjectWrap<NodeRand<GENERATOR>> {
     NodeGlobalBuffer m_GlobalBuffer;
     // rng
     GENERATOR m_generator;
+    // hot path counters, created on first use, shared with streams and rings. See NodeStats.h
+    std::shared_ptr<NodeStats> m_stats;
 
-    /// \brief Used to set m_readableCtor. Must call before using class.
+    /// \brief Used to set the Readable ctor of this env. Must call before using class, in every env (main thread, worker) loading it.
     /// \param arg0 - Node JS Readable Function
     /// \return null
     static napi_value SetReadable(napi_env env, napi_callback_info info);
 
+    /// \brief Readable ctor reference of env, set by SetReadable
+    static napi_ref ReadableCtor(napi_env env);
+
     /// \brief Set the seed of the RNG
     /// \param (Optional) arg0 int64_t seed. Default is random seed
     /// \return null
@@ -38,24 +54,203 @@ class NodeRand : public napi_extensions::NapiObjectWrap<NodeRand<GENERATOR>> {
     /// \brief Synchronous function to generate a single random number between a min <-> max
     /// \param arg0 int64_t min
     /// \param arg1 int64_t max
-    /// \return int64_t random number
+    /// \param arg2 (Optional) Type of the number, min and max must fit in it. See NodeRandTypes.h
+    /// \return int64_t random number. With a type: number, or BigInt for BigInt64/BigUint64
     static napi_value Generate(napi_env env, napi_callback_info info);
 
+    /// \brief Generate with a type selector. Throws a JS error and returns nullptr if type or range are invalid.
+    static napi_value GenerateTyped(napi_env env, NodeRand<GENERATOR>* rSeed, napi_value minValue, napi_value maxValue,
+        napi_typedarray_type type);
+
     /// \brief Asynchronous function to generate a stream of random numbers between a min <-> max
     /// \param arg0 int64_t min
     /// \param arg1 int64_t max
     /// \param arg2 int64_t count - how many to generate
-    /// \return Readable instance that will write random numbers to buffer. See class rand_seed_stream
+    /// \param arg3 (Optional) { chunkSize, highWaterMark, adaptive, threads, type, streamId } see StreamOptions
+    /// \return Readable instance that will write random numbers to buffer, packed as options.type (default BigInt64)
     static napi_value GenerateSequenceStream(napi_env env, napi_callback_info info);
 
+    /// \brief Synchronous function to fill a TypedArray in place with random numbers between a min <-> max
+    /// \param arg0 TypedArray to fill, any integer array, Float32Array, Float64Array, BigInt64Array or BigUint64Array.
+    ///        Float arrays are filled in [min, max)
+    /// \param arg1 min, number or BigInt within the element type
+    /// \param arg2 max, number or BigInt within the element type
+    /// \param arg3 (Optional) { threads } fill the parallel sequence of the next pseudo seed on this many threads
+    /// \return the filled TypedArray
+    static napi_value GenerateInto(napi_env env, napi_callback_info info);
+
+    /// \brief Asynchronous GenerateInto. Uses a pseudo seed like GenerateSequenceStream.
+    /// \note TypedArray must not be touched until the promise resolves
+    /// \return Promise resolved with the filled TypedArray
+    static napi_value GenerateIntoAsync(napi_env env, napi_callback_info info);
+
+    /// \brief Shared ring of random numbers between a min <-> max kept filled by a producer thread, see NodeRandRing.h
+    /// \param arg0 min, number or BigInt within options.type
+    /// \param arg1 max, number or BigInt within options.type
+    /// \param arg2 (Optional) { slots, sliceSize, lowWater, type, streamId } see RingOptions. Seeded like GenerateSequenceStream
+    /// \return RandomRing, read it from any thread with new RingReader(ring.Buffer())
+    static napi_value SharedRing(napi_env env, napi_callback_info info);
+
+    /// \brief Promise based batches of a sequence between a min <-> max, see NodeRandBatches.h
+    /// \param arg0 min, number or BigInt within options.type
+    /// \param arg1 max, number or BigInt within options.type
+    /// \param arg2 uint32_t count - how many to generate
+    /// \param arg3 (Optional) { chunkSize, type, streamId } see StreamOptions. chunkSize is the default batch size.
+    ///        Seeded like GenerateSequenceStream
+    /// \return RandomBatches with NextBatch(n), async iterable of TypedArrays of options.type
+    static napi_value GenerateBatches(napi_env env, napi_callback_info info);
+
+    /// \brief Skip the generator a fixed large distance (2^128 for xoshiro256**, 2^64 for pcg64) in O(1).
+    /// \note Only registered for engines with jump(). Seed two instances the same and Jump() one to split a sequence.
+    /// \return null
+    static napi_value Jump(napi_env env, napi_callback_info info);
+
+    /// \brief Skip the next n raw engine outputs without generating them. Generate consumes one output per number
+    /// unless its rejection sampling retries, which happens rarely and only for ranges that are not a power of two.
+    /// \note Only registered for engines with advance(n)
+    /// \param arg0 int64_t n >= 0
+    /// \return null
+    static napi_value Advance(napi_env env, napi_callback_info info);
+
+    /// \brief New instance seeded with the real seed of stream streamId, a hash of this instance's real seed and streamId.
+    ///        Same as new instance + SetSeed(ForkSeed(seed, streamId)), see NodeGlobalBuffer. Forks of forks hash the path.
+    /// \note Does not draw from this instance, forks depend on the seed and streamId only, not on call order
+    /// \param arg0 streamId, integer in [0, 2^64), number or BigInt
+    /// \return instance of the same engine
+    static napi_value Fork(napi_env env, napi_callback_info info);
+
+    /// \brief Snapshot of the generator and pseudo seed state, see NodeRandState.h. O(state size), no numbers are replayed.
+    /// \note Distribution handles keep no state of their own, they continue from the restored generator
+    /// \return Buffer, restore it into an instance of the same engine with SetState
+    static napi_value GetState(napi_env env, napi_callback_info info);
+
+    /// \brief Restore a GetState() snapshot. The instance continues exactly where the snapshot was taken.
+    /// \param arg0 Buffer or Uint8Array returned by GetState() of the same engine
+    /// \return null, throws a TypeError if the state is corrupt or of another engine
+    static napi_value SetState(napi_env env, napi_callback_info info);
+
+    /// \brief Counters and latency histograms of this instance and the streams and rings it created, see NodeStats.h
+    /// \return { enabled, valuesGenerated, chunksPushed, queueDepth, maxQueueDepth, backpressureStalls, queueFullStalls,
+    ///          seedRefills, chunkGenerateNs, chunkPushNs }, histograms as { count, min, max, mean, p50, p90, p99, p999 }
+    static napi_value GetStats(napi_env env, napi_callback_info info);
+
+    /// \brief Uniform integer distribution handle bound to this generator, see NodeRandDistribution
+    /// \param arg0 int64_t min
+    /// \param arg1 int64_t max
+    /// \return handle with Next(), Fill(typedArray) and Stream(count, options?)
+    static napi_value UniformInt(napi_env env, napi_callback_info info);
+
+    /// \brief Normal distribution handle, see NodeDistributions.h
+    /// \param arg0 double mean
+    /// \param arg1 double stddev > 0
+    /// \return handle, Next() returns doubles
+    static napi_value Normal(napi_env env, napi_callback_info info);
+
+    /// \brief Log-normal distribution handle, exp(Normal(mean, stddev))
+    /// \param arg0 double mean of the underlying normal
+    /// \param arg1 double stddev > 0 of the underlying normal
+    /// \return handle, Next() returns doubles
+    static napi_value LogNormal(napi_env env, napi_callback_info info);
+
+    /// \brief Exponential distribution handle
+    /// \param arg0 double lambda > 0, the rate
+    /// \return handle, Next() returns doubles
+    static napi_value Exponential(napi_env env, napi_callback_info info);
+
+    /// \brief Gamma distribution handle
+    /// \param arg0 double shape > 0
+    /// \param arg1 double scale > 0
+    /// \return handle, Next() returns doubles
+    static napi_value Gamma(napi_env env, napi_callback_info info);
+
+    /// \brief Poisson distribution handle
+    /// \param arg0 double mean, 0 <= mean <= 2^53
+    /// \return handle, Next() returns integers
+    static napi_value Poisson(napi_env env, napi_callback_info info);
+
+    /// \brief Binomial distribution handle
+    /// \param arg0 integer n trials, 0 <= n <= 2^53
+    /// \param arg1 double p, probability of success in [0, 1]
+    /// \return handle, Next() returns integers in [0, n]
+    static napi_value Binomial(napi_env env, napi_callback_info info);
+
+    /// \brief Discrete distribution handle, index i is drawn with probability weights[i] / sum(weights)
+    /// \param arg0 AliasTable, shared without rebuilding, or an Array or TypedArray of weights >= 0
+    /// \return handle, Next() returns integers in [0, weights.length), Fill takes Uint32Array
+    static napi_value Discrete(napi_env env, napi_callback_info info);
+
+    /// \brief Shuffle a TypedArray in place (Fisher-Yates), see NodeShuffle.h
+    /// \param arg0 any TypedArray
+    /// \param arg1 (Optional) { threads } scatter shuffle the parallel sequence of the next pseudo seed on this many threads
+    /// \return the shuffled TypedArray
+    static napi_value Shuffle(napi_env env, napi_callback_info info);
+
+    /// \brief Random permutation of 0..n-1, same as Shuffle of a Uint32Array holding 0..n-1
+    /// \param arg0 integer n, 0 <= n <= 2^32
+    /// \param arg1 (Optional) { threads } same as Shuffle
+    /// \return Uint32Array
+    static napi_value Permutation(napi_env env, napi_callback_info info);
+
+    /// \brief k distinct integers of [0, n) in random order
+    /// \param arg0 integer n, 0 <= n <= 2^32
+    /// \param arg1 integer k, 0 <= k <= n
+    /// \return Uint32Array
+    static napi_value SampleWithoutReplacement(napi_env env, napi_callback_info info);
+
+    /// \brief Shuffle length elements of a TypedArray of type, sequentially or in parallel when threads > 0
+    void ShuffleData(napi_typedarray_type type, void* data, size_t length, uint32_t threads);
+
+    /// \brief Parse N double parameters, validate them with DISTRIBUTION::Check and create a handle bound to this.
+    ///        Throws a JS RangeError and returns nullptr if the parameters are invalid.
+    template<class DISTRIBUTION, size_t N>
+    static napi_value NewDistribution(napi_env env, napi_callback_info info);
+
+    /// \brief Reseed m_generator with the next pseudo seed if SetSeed was called
+    GENERATOR& Generator();
+
+    /// \brief Take the next pseudo seed of m_GlobalBuffer, counted as a seed refill
+    int64_t NextSeed();
+
+    /// \brief Stats of this instance, created on first use. Null when stats are compiled out.
+    const std::shared_ptr<NodeStats>& Stats();
+
+    /// \brief Seed of a stream. The first pseudo seed of Fork(streamId) when the streamId option is set,
+    ///        otherwise the next pseudo seed
+    int64_t StreamSeed(const StreamOptions& options);
+
 public:
     static std::vector<napi_property_descriptor> GetClassProps() {
         std::vector<napi_property_descriptor> props{
             {"SetSeed", 0, SetSeed, 0, 0, 0, napi_default, 0},
             { "Generate", 0, Generate, 0, 0, 0, napi_default, 0 },
             { "GenerateSequenceStream", 0, GenerateSequenceStream, 0, 0, 0, napi_default, 0 },
+            { "GenerateInto", 0, GenerateInto, 0, 0, 0, napi_default, 0 },
+            { "GenerateIntoAsync", 0, GenerateIntoAsync, 0, 0, 0, napi_default, 0 },
+            { "SharedRing", 0, SharedRing, 0, 0, 0, napi_default, 0 },
+            { "GenerateBatches", 0, GenerateBatches, 0, 0, 0, napi_default, 0 },
+            { "Fork", 0, Fork, 0, 0, 0, napi_default, 0 },
+            { "GetState", 0, GetState, 0, 0, 0, napi_default, 0 },
+            { "SetState", 0, SetState, 0, 0, 0, napi_default, 0 },
+            { "GetStats", 0, GetStats, 0, 0, 0, napi_default, 0 },
+            { "UniformInt", 0, UniformInt, 0, 0, 0, napi_default, 0 },
+            { "Normal", 0, Normal, 0, 0, 0, napi_default, 0 },
+            { "LogNormal", 0, LogNormal, 0, 0, 0, napi_default, 0 },
+            { "Exponential", 0, Exponential, 0, 0, 0, napi_default, 0 },
+            { "Gamma", 0, Gamma, 0, 0, 0, napi_default, 0 },
+            { "Poisson", 0, Poisson, 0, 0, 0, napi_default, 0 },
+            { "Binomial", 0, Binomial, 0, 0, 0, napi_default, 0 },
+            { "Discrete", 0, Discrete, 0, 0, 0, napi_default, 0 },
+            { "Shuffle", 0, Shuffle, 0, 0, 0, napi_default, 0 },
+            { "Permutation", 0, Permutation, 0, 0, 0, napi_default, 0 },
+            { "SampleWithoutReplacement", 0, SampleWithoutReplacement, 0, 0, 0, napi_default, 0 },
             { "SetReadable", 0, SetReadable, 0, 0, 0, napi_static, 0 }
         };
+        if constexpr (engine_traits::HasJump<GENERATOR>::value) {
+            props.push_back({ "Jump", 0, Jump, 0, 0, 0, napi_default, 0 });
+        }
+        if constexpr (engine_traits::HasAdvance<GENERATOR>::value) {
+            props.push_back({ "Advance", 0, Advance, 0, 0, 0, napi_default, 0 });
+        }
         return props;
     }
 
@@ -63,7 +258,7 @@ public:
     NodeRand();
 
     /// \brief dtor
-    ~NodeRand() { std::cout << "~NodeRand" << std::endl; };
+    ~NodeRand() { NODE_RAND_LOG("~NodeRand"); };
 };
 
 }
\ No newline at end of file
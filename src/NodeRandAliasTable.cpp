@@ -0,0 +1,153 @@
+#include "NodeRandAliasTable.h"
+#include "NodeRandTypes.h"
+
+#include <assert.h>
+#include <sstream>
+
+using namespace node_rand;
+using namespace napi_extensions;
+
+napi_value NodeRandAliasTable::Create(napi_env env, std::shared_ptr<const NodeAliasTable> table, uint32_t id)
+{
+    NodeRandAliasTable* handle = nullptr;
+    napi_value jsthis = NewInstance(env, &handle);
+    handle->m_table = std::move(table);
+    handle->m_id = id;
+    return jsthis;
+}
+
+NodeRandAliasTable* NodeRandAliasTable::GetHandle(napi_env env, napi_callback_info info)
+{
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr), env, "NodeRandAliasTable get cb info");
+
+    NodeRandAliasTable* handle = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&handle)), env, "NodeRandAliasTable unwrap");
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    if (handle->m_table == nullptr) {
+        napi_throw_error(env, nullptr, "AliasTable has no table. Create it with AliasTable.Build(weights)");
+        return nullptr;
+    }
+    return handle;
+}
+
+std::vector<double> NodeRandAliasTable::GetWeights(napi_env env, napi_value value)
+{
+    std::vector<double> weights;
+
+    bool isTypedArray = false;
+    CheckStatus(napi_is_typedarray(env, value, &isTypedArray), env, "Failed to check typedarray");
+    if (isTypedArray) {
+        NapiArgTypedArray arg;
+        arg.SetVal(env, value);
+        NapiTypedArrayInfo array = arg.GetVal();
+        VisitType(array.type, [&] (auto tag) {
+            typedef typename decltype(tag)::type T;
+            const T* data = static_cast<const T*>(array.data);
+            weights.assign(data, data + array.length);
+        });
+        return weights;
+    }
+
+    bool isArray = false;
+    CheckStatus(napi_is_array(env, value, &isArray), env, "Failed to check array");
+    assert(isArray && "Argument invalid. Expecting Array or TypedArray of weights!");
+
+    uint32_t length = 0;
+    CheckStatus(napi_get_array_length(env, value, &length), env, "Failed to get array length");
+    weights.resize(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        CheckStatus(napi_get_element(env, value, i, &element), env, "Failed to get array element");
+        NapiArgDouble arg;
+        arg.SetVal(env, element);
+        weights[i] = arg.GetVal();
+    }
+    return weights;
+}
+
+std::shared_ptr<const NodeAliasTable> NodeRandAliasTable::GetTable(napi_env env, napi_value value)
+{
+    if (IsInstance(env, value)) {
+        NodeRandAliasTable* handle = nullptr;
+        CheckStatus(napi_unwrap(env, value, reinterpret_cast<void**>(&handle)), env, "NodeRandAliasTable unwrap");
+        if (handle == nullptr) {
+            return nullptr;
+        }
+        if (handle->m_table == nullptr) {
+            napi_throw_error(env, nullptr, "AliasTable has no table. Create it with AliasTable.Build(weights)");
+        }
+        return handle->m_table;
+    }
+
+    std::vector<double> weights = GetWeights(env, value);
+    const char* error = NodeAliasTable::Check(weights);
+    if (error != nullptr) {
+        std::stringstream ss;
+        ss << error << ". Weights: " << weights.size() << std::endl;
+        napi_throw_range_error(env, nullptr, ss.str().c_str());
+        return nullptr;
+    }
+    return std::make_shared<const NodeAliasTable>(weights);
+}
+
+napi_value NodeRandAliasTable::Build(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr), env, "AliasTable.Build get cb info");
+    assert(argc == 1 && "invalid number of arguments");
+
+    std::shared_ptr<const NodeAliasTable> table = GetTable(env, argv[0]);
+    if (table == nullptr) {
+        return nullptr;
+    }
+    const uint32_t id = NodeAliasTableRegistry::Instance().Add(table);
+    return Create(env, std::move(table), id);
+}
+
+napi_value NodeRandAliasTable::FromId(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr), env, "AliasTable.FromId get cb info");
+    assert(argc == 1 && "invalid number of arguments");
+
+    NapiArgUint32 arg0;
+    arg0.SetVal(env, argv[0]);
+    const uint32_t id = arg0.GetVal();
+
+    std::shared_ptr<const NodeAliasTable> table = NodeAliasTableRegistry::Instance().Find(id);
+    if (table == nullptr) {
+        std::stringstream ss;
+        ss << "Unknown AliasTable id, or its table was freed. id: " << id << std::endl;
+        napi_throw_range_error(env, nullptr, ss.str().c_str());
+        return nullptr;
+    }
+    return Create(env, std::move(table), id);
+}
+
+napi_value NodeRandAliasTable::Id(napi_env env, napi_callback_info info)
+{
+    NodeRandAliasTable* handle = GetHandle(env, info);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    napi_value result;
+    CheckStatus(napi_create_uint32(env, handle->m_id, &result), env, "Failed to create uint32");
+    return result;
+}
+
+napi_value NodeRandAliasTable::Size(napi_env env, napi_callback_info info)
+{
+    NodeRandAliasTable* handle = GetHandle(env, info);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    napi_value result;
+    CheckStatus(napi_create_uint32(env, static_cast<uint32_t>(handle->m_table->size()), &result), env, "Failed to create uint32");
+    return result;
+}
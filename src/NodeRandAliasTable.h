@@ -0,0 +1,67 @@
+#pragma once
+
+#include "napi_extensions.h"
+#include "NodeAliasTable.h"
+
+#include <node_api.h>
+#include <memory>
+#include <vector>
+
+namespace node_rand {
+
+/// \class NodeRandAliasTable
+/// \brief JS handle of a prebuilt alias table, exported as AliasTable. Build it once, sample it from any NodeRand
+///        instance with rng.Discrete(table) without rebuilding or copying it.
+/// \note Built tables are registered in NodeAliasTableRegistry. A worker_threads Worker attaches with
+///       AliasTable.FromId(table.Id()) while a handle to the table is still alive.
+class NodeRandAliasTable : public napi_extensions::NapiObjectWrap<NodeRandAliasTable> {
+    // null if constructed from JS
+    std::shared_ptr<const NodeAliasTable> m_table;
+    // registry id
+    uint32_t m_id{0};
+
+    /// \brief Wrap table as a new AliasTable
+    static napi_value Create(napi_env env, std::shared_ptr<const NodeAliasTable> table, uint32_t id);
+
+    /// \brief Unwrap this. Throws a JS error and returns nullptr if the handle has no table.
+    static NodeRandAliasTable* GetHandle(napi_env env, napi_callback_info info);
+
+    /// \brief Build and register a table
+    /// \param arg0 Array or TypedArray of weights >= 0
+    /// \return AliasTable
+    static napi_value Build(napi_env env, napi_callback_info info);
+
+    /// \brief Attach to a table built by any thread of this process
+    /// \param arg0 uint32_t id returned by Id()
+    /// \return AliasTable, throws a RangeError if the id is unknown or its table was freed
+    static napi_value FromId(napi_env env, napi_callback_info info);
+
+    /// \brief Registry id of the table
+    /// \return number
+    static napi_value Id(napi_env env, napi_callback_info info);
+
+    /// \brief Number of weights
+    /// \return number
+    static napi_value Size(napi_env env, napi_callback_info info);
+
+public:
+    static std::vector<napi_property_descriptor> GetClassProps() {
+        std::vector<napi_property_descriptor> props{
+            { "Build", 0, Build, 0, 0, 0, napi_static, 0 },
+            { "FromId", 0, FromId, 0, 0, 0, napi_static, 0 },
+            { "Id", 0, Id, 0, 0, 0, napi_default, 0 },
+            { "Size", 0, Size, 0, 0, 0, napi_default, 0 }
+        };
+        return props;
+    }
+
+    /// \brief Copy weights out of a JS Array of numbers or a supported TypedArray. Asserts on anything else.
+    /// \note Unsupported TypedArrays give no weights, rejected by NodeAliasTable::Check
+    static std::vector<double> GetWeights(napi_env env, napi_value value);
+
+    /// \brief Table of an AliasTable, or a new unregistered table built from an Array or TypedArray of weights
+    /// \return table, nullptr after throwing a JS error if the weights are invalid
+    static std::shared_ptr<const NodeAliasTable> GetTable(napi_env env, napi_value value);
+};
+
+}
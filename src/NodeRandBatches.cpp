@@ -0,0 +1,212 @@
+#include "NodeRandBatches.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace node_rand;
+using namespace napi_extensions;
+
+napi_value NodeRandBatches::Create(napi_env env, uint64_t count, const StreamOptions& options, size_t elementSize, FillFunction fill)
+{
+    NodeRandBatches* handle = nullptr;
+    napi_value jsthis = NewInstance(env, &handle);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    handle->m_state = std::make_shared<BatchState>();
+    handle->m_state->fill = std::move(fill);
+    handle->m_state->type = options.type;
+    handle->m_state->elementSize = elementSize;
+    handle->m_state->remaining = count;
+    handle->m_batchSize = options.chunkSize;
+    return jsthis;
+}
+
+NodeRandBatches* NodeRandBatches::GetHandle(napi_env env, napi_callback_info info, size_t& argc, napi_value* argv)
+{
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "NodeRandBatches get cb info");
+
+    NodeRandBatches* handle = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&handle)), env, "NodeRandBatches unwrap");
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    if (handle->m_state == nullptr) {
+        napi_throw_error(env, nullptr, "RandomBatches has no sequence. Create it with rng.GenerateBatches(min, max, count, options)");
+        return nullptr;
+    }
+    return handle;
+}
+
+void NodeRandBatches::Resolve(napi_env env, BatchRequest& request)
+{
+    napi_value array = nullptr;
+    if (napi_get_reference_value(env, request.array_ref, &array) == napi_ok) {
+        napi_resolve_deferred(env, request.deferred, array);
+    }
+    napi_delete_reference(env, request.array_ref);
+    request.array_ref = nullptr;
+}
+
+void NodeRandBatches::RejectAll(napi_env env, BatchState& state, const char* message)
+{
+    // settling fails when the env is stopping, the promises go away with it
+    for (BatchRequest& request : state.queue) {
+        napi_value text = nullptr, error = nullptr;
+        napi_status s = napi_create_string_utf8(env, message, NAPI_AUTO_LENGTH, &text);
+        if (s == napi_ok) {
+            s = napi_create_error(env, nullptr, text, &error);
+        }
+        if (s == napi_ok) {
+            napi_reject_deferred(env, request.deferred, error);
+        }
+        napi_delete_reference(env, request.array_ref);
+    }
+    state.queue.clear();
+}
+
+napi_value NodeRandBatches::NextBatch(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    NodeRandBatches* handle = GetHandle(env, info, argc, argv);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    uint32_t n = handle->m_batchSize;
+    if (argc == 1) {
+        NapiArgUint32 arg0;
+        arg0.SetVal(env, argv[0]);
+        n = arg0.GetVal();
+        if (n < 1 || n > MAX_CHUNK_SIZE) {
+            std::stringstream ss;
+            ss << "Batch size must be between 1 and " << MAX_CHUNK_SIZE << ". n: " << n << std::endl;
+            napi_throw_range_error(env, nullptr, ss.str().c_str());
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<BatchState> state = handle->m_state;
+    BatchRequest request;
+    napi_value promise;
+    CheckStatus(napi_create_promise(env, &request.deferred, &promise), env, "NextBatch() create promise");
+
+    request.count = static_cast<uint32_t>(std::min<uint64_t>(n, state->remaining));
+    if (request.count == 0) {
+        // exhausted
+        napi_value null_value;
+        CheckStatus(napi_get_null(env, &null_value), env, "Failed to get null");
+        napi_resolve_deferred(env, request.deferred, null_value);
+        return promise;
+    }
+
+    napi_value buffer = nullptr, array = nullptr;
+    if (napi_create_arraybuffer(env, request.count * state->elementSize, &request.data, &buffer) != napi_ok) {
+        // allocation failed, the JS error is pending
+        return nullptr;
+    }
+    CheckStatus(napi_create_typedarray(env, state->type, request.count, buffer, 0, &array), env, "NextBatch() create TypedArray");
+    state->remaining -= request.count;
+
+    if (state->queue.empty() && request.count <= SYNC_BATCH_SIZE) {
+        // cheaper than a round trip through the thread pool
+        state->fill(request.data, request.count);
+        napi_resolve_deferred(env, request.deferred, array);
+        return promise;
+    }
+
+    CheckStatus(napi_create_reference(env, array, 1, &request.array_ref), env, "NextBatch() create reference");
+    state->queue.push_back(request);
+    if (state->queue.size() == 1) {
+        Start(env, state);
+    }
+    return promise;
+}
+
+bool NodeRandBatches::Start(napi_env env, const std::shared_ptr<BatchState>& state)
+{
+    // keeps the state alive until CompleteAsyncFunction
+    AsyncFunctionData* async_data = new AsyncFunctionData();
+    async_data->state = state;
+    async_data->data = state->queue.front().data;
+    async_data->count = state->queue.front().count;
+
+    napi_value async_name;
+    napi_status status = napi_create_string_utf8(env, "generate_batch", NAPI_AUTO_LENGTH, &async_name);
+    if (status == napi_ok) {
+        status = napi_create_async_work(env, nullptr, async_name, ExecuteAsyncFunction, CompleteAsyncFunction, async_data, &state->work);
+    }
+    if (status == napi_ok) {
+        status = napi_queue_async_work(env, state->work);
+    }
+    if (status != napi_ok) {
+        if (state->work != nullptr) {
+            napi_delete_async_work(env, state->work);
+            state->work = nullptr;
+        }
+        delete async_data;
+        RejectAll(env, *state, "GenerateBatches cancelled");
+        return false;
+    }
+    return true;
+}
+
+// NOTE: CANNOT EXECUTE JS IN THIS BLOCK!
+void NodeRandBatches::ExecuteAsyncFunction(napi_env env, void* data)
+{
+    AsyncFunctionData* async_data = static_cast<AsyncFunctionData*>(data);
+    async_data->state->fill(async_data->data, async_data->count);
+}
+
+void NodeRandBatches::CompleteAsyncFunction(napi_env env, napi_status status, void* data)
+{
+    AsyncFunctionData* async_data = static_cast<AsyncFunctionData*>(data);
+    std::shared_ptr<BatchState> state = async_data->state;
+    delete async_data;
+
+    napi_delete_async_work(env, state->work);
+    state->work = nullptr;
+
+    if (status != napi_ok) {
+        RejectAll(env, *state, "GenerateBatches cancelled");
+        return;
+    }
+
+    Resolve(env, state->queue.front());
+    state->queue.pop_front();
+
+    // resolving runs no JS, later NextBatch calls are still queued behind this one
+    if (!state->queue.empty()) {
+        Start(env, state);
+    }
+}
+
+napi_value NodeRandBatches::Remaining(napi_env env, napi_callback_info info)
+{
+    size_t argc = 0;
+    NodeRandBatches* handle = GetHandle(env, info, argc, nullptr);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    napi_value result;
+    CheckStatus(napi_create_double(env, static_cast<double>(handle->m_state->remaining), &result), env, "Failed to create double");
+    return result;
+}
+
+napi_value NodeRandBatches::BatchSize(napi_env env, napi_callback_info info)
+{
+    size_t argc = 0;
+    NodeRandBatches* handle = GetHandle(env, info, argc, nullptr);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    napi_value result;
+    CheckStatus(napi_create_uint32(env, handle->m_batchSize, &result), env, "Failed to create uint32");
+    return result;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "napi_extensions.h"
+#include "NodeRandStream.h"
+
+#include <node_api.h>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace node_rand {
+
+/**
+ * Batches
+ *
+ * rng.GenerateBatches(min, max, count, options) returns a RandomBatches handle. NextBatch(n) resolves with a TypedArray
+ * of options.type holding the next n numbers, no Readable and no reinterpreting Uint8Array chunks. index.js makes the
+ * handle an async iterable of batches of options.chunkSize.
+ *
+ * Batches are filled in call order on libuv workers, one at a time, straight into the ArrayBuffer that is resolved.
+ * A batch of at most SYNC_BATCH_SIZE numbers requested while no batch is pending is filled on the JS thread, the promise
+ * is resolved before NextBatch returns. In order the batches hold the numbers GenerateSequenceStream emits for the same
+ * seed, range, count and type.
+ */
+
+/// \brief Largest batch filled on the JS thread. About as long as queueing the work to a libuv worker takes.
+static const uint32_t SYNC_BATCH_SIZE = 4096;
+
+/// \class NodeRandBatches
+/// \brief Pull based batches of one sequence, returned by rng.GenerateBatches(min, max, count, options)
+class NodeRandBatches : public napi_extensions::NapiObjectWrap<NodeRandBatches> {
+public:
+    /// \brief Writes count numbers to out, called by one thread at a time, in batch order
+    typedef std::function<void(void* out, size_t count)> FillFunction;
+
+private:
+    /// \brief A NextBatch call waiting for its numbers
+    struct BatchRequest {
+        // resolved with array
+        napi_deferred deferred{nullptr};
+        // the TypedArray, keeps its ArrayBuffer alive while a worker fills it
+        napi_ref array_ref{nullptr};
+        // first element
+        void* data{nullptr};
+        uint32_t count{0};
+    };
+
+    /// \brief state shared by the handle and the pending batch, touched on the JS thread only except for fill
+    struct BatchState {
+        FillFunction fill;
+        napi_typedarray_type type{napi_bigint64_array};
+        size_t elementSize{0};
+        // numbers not requested yet
+        uint64_t remaining{0};
+        // requests in call order, the front one is being filled while work is set
+        std::deque<BatchRequest> queue;
+        // async work of the front request
+        napi_async_work work{nullptr};
+    };
+
+    /// \brief data needed during async function queue, one per filled request
+    struct AsyncFunctionData {
+        std::shared_ptr<BatchState> state;
+        // copy of the front request's buffer, the queue may grow while the worker fills it
+        void* data{nullptr};
+        uint32_t count{0};
+    };
+
+    std::shared_ptr<BatchState> m_state;
+    // default batch size, options.chunkSize
+    uint32_t m_batchSize{DEFAULT_CHUNK_SIZE};
+
+    /// \brief Queue async work filling the front request
+    /// \return false if the env is stopping, pending requests are rejected
+    static bool Start(napi_env env, const std::shared_ptr<BatchState>& state);
+
+    /// \brief Reject every pending request
+    static void RejectAll(napi_env env, BatchState& state, const char* message);
+
+    /// \brief Resolve a filled request and free its reference
+    static void Resolve(napi_env env, BatchRequest& request);
+
+    static void ExecuteAsyncFunction(napi_env env, void* data);
+    static void CompleteAsyncFunction(napi_env env, napi_status status, void* data);
+
+    /// \brief Unwrap this. Throws a JS error and returns nullptr if the handle has no sequence.
+    static NodeRandBatches* GetHandle(napi_env env, napi_callback_info info, size_t& argc, napi_value* argv);
+
+    /// \brief Next n numbers of the sequence
+    /// \param arg0 (Optional) n, 1 to MAX_CHUNK_SIZE. Default options.chunkSize
+    /// \return Promise resolved with a TypedArray of options.type, shorter at the end of the sequence,
+    ///         or with null once the sequence is exhausted
+    static napi_value NextBatch(napi_env env, napi_callback_info info);
+
+    /// \brief Numbers not requested yet
+    /// \return number
+    static napi_value Remaining(napi_env env, napi_callback_info info);
+
+    /// \brief Default batch size, options.chunkSize. Batch size of the async iterator.
+    /// \return number
+    static napi_value BatchSize(napi_env env, napi_callback_info info);
+
+public:
+    static std::vector<napi_property_descriptor> GetClassProps() {
+        std::vector<napi_property_descriptor> props{
+            { "NextBatch", 0, NextBatch, 0, 0, 0, napi_default, 0 },
+            { "Remaining", 0, Remaining, 0, 0, 0, napi_default, 0 },
+            { "BatchSize", 0, BatchSize, 0, 0, 0, napi_default, 0 }
+        };
+        return props;
+    }
+
+    /// \brief New handle
+    /// \param count numbers in the sequence
+    /// \param options.chunkSize default batch size, options.type element type. Other options are not used.
+    /// \param elementSize bytes per number of options.type
+    static napi_value Create(napi_env env, uint64_t count, const StreamOptions& options, size_t elementSize, FillFunction fill);
+};
+
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "napi_extensions.h"
+#include "NodeRand.h"
+#include "NodeRandStream.h"
+#include "NodeRandTypes.h"
+
+#include <node_api.h>
+#include <assert.h>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+
+namespace node_rand {
+
+/// \class NodeRandDistribution
+/// \brief JS handle binding a distribution to the generator of a NodeRand instance, eg: rng.UniformInt(min, max).
+///        Parameters are validated and precomputed once, Next/Fill/Stream only draw numbers.
+/// \note Draws from the parent's generator, so handle.Next() continues the same sequence as rng.Generate().
+///       Holds a reference to the parent so it stays alive as long as the handle.
+template<class GENERATOR, class DISTRIBUTION>
+class NodeRandDistribution : public napi_extensions::NapiObjectWrap<NodeRandDistribution<GENERATOR, DISTRIBUTION>> {
+    typedef typename DISTRIBUTION::result_type T;
+
+    // max numbers staged per Fill call when the TypedArray element type differs from T
+    static const size_t StageSize = 256;
+
+    // instance the handle was created from, null if constructed from JS
+    NodeRand<GENERATOR>* m_parent{nullptr};
+    // keeps the parent alive
+    napi_ref m_parentRef{nullptr};
+    // bound distribution
+    DISTRIBUTION m_distribution;
+
+    /// \brief Unwrap this and argc arguments. Throws a JS error and returns nullptr if the handle has no parent.
+    static NodeRandDistribution* GetHandle(napi_env env, napi_callback_info info, size_t& argc, napi_value* argv);
+
+    /// \brief n numbers into out, converted to E if needed. Same sequence as n calls to Next().
+    template<class E>
+    void FillAs(E* out, size_t n);
+
+    /// \brief Next number of the distribution
+    /// \return number
+    static napi_value Next(napi_env env, napi_callback_info info);
+
+    /// \brief Fill a TypedArray in place. Any integer array the range fits in for integer distributions,
+    ///        Float32Array/Float64Array for any distribution.
+    /// \param arg0 TypedArray
+    /// \return the filled TypedArray
+    static napi_value Fill(napi_env env, napi_callback_info info);
+
+    /// \brief Same as GenerateSequenceStream with the bound distribution
+    /// \param arg0 uint32_t count - how many to generate
+    /// \param arg1 (Optional) StreamOptions. type defaults to the distribution's type (BigInt64 for integers, Float64 for reals)
+    ///        and cannot be changed
+    /// \return Readable
+    static napi_value Stream(napi_env env, napi_callback_info info);
+
+public:
+    static std::vector<napi_property_descriptor> GetClassProps() {
+        std::vector<napi_property_descriptor> props{
+            { "Next", 0, Next, 0, 0, 0, napi_default, 0 },
+            { "Fill", 0, Fill, 0, 0, 0, napi_default, 0 },
+            { "Stream", 0, Stream, 0, 0, 0, napi_default, 0 }
+        };
+        return props;
+    }
+
+    /// \brief Create a handle bound to parent
+    /// \param parentThis JS object of parent
+    /// \return handle
+    static napi_value Create(napi_env env, napi_value parentThis, NodeRand<GENERATOR>* parent, const DISTRIBUTION& distribution);
+
+    ~NodeRandDistribution() {
+        if (m_parentRef != nullptr) {
+            napi_delete_reference(this->m_env, m_parentRef);
+        }
+    }
+};
+
+template<class GENERATOR, class DISTRIBUTION>
+napi_value NodeRandDistribution<GENERATOR, DISTRIBUTION>::Create(napi_env env, napi_value parentThis, NodeRand<GENERATOR>* parent,
+    const DISTRIBUTION& distribution)
+{
+    NodeRandDistribution* handle = nullptr;
+    napi_value jsthis = NodeRandDistribution::NewInstance(env, &handle);
+
+    handle->m_parent = parent;
+    handle->m_distribution = distribution;
+    napi_extensions::CheckStatus(napi_create_reference(env, parentThis, 1, &handle->m_parentRef), env, "NodeRandDistribution::Create parent reference");
+    return jsthis;
+}
+
+template<class GENERATOR, class DISTRIBUTION>
+NodeRandDistribution<GENERATOR, DISTRIBUTION>* NodeRandDistribution<GENERATOR, DISTRIBUTION>::GetHandle(napi_env env, napi_callback_info info,
+    size_t& argc, napi_value* argv)
+{
+    napi_value jsthis;
+    napi_extensions::CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "NodeRandDistribution get cb info");
+
+    NodeRandDistribution* handle = nullptr;
+    napi_extensions::CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&handle)), env, "NodeRandDistribution unwrap");
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    if (handle->m_parent == nullptr) {
+        napi_throw_error(env, nullptr, "Distribution is not bound to a generator. Create it with eg: rng.UniformInt(min, max)");
+        return nullptr;
+    }
+    return handle;
+}
+
+template<class GENERATOR, class DISTRIBUTION>
+template<class E>
+void NodeRandDistribution<GENERATOR, DISTRIBUTION>::FillAs(E* out, size_t n)
+{
+    GENERATOR& generator = m_parent->Generator();
+    if constexpr (std::is_same<E, T>::value) {
+        m_distribution.Fill(generator, out, n);
+    }
+    else {
+        T staged[StageSize];
+        while (n > 0) {
+            const size_t k = std::min(n, StageSize);
+            m_distribution.Fill(generator, staged, k);
+            std::transform(staged, staged + k, out, [] (T value) { return static_cast<E>(value); });
+            out += k;
+            n -= k;
+        }
+    }
+}
+
+template<class GENERATOR, class DISTRIBUTION>
+napi_value NodeRandDistribution<GENERATOR, DISTRIBUTION>::Next(napi_env env, napi_callback_info info)
+{
+    size_t argc = 0;
+    NodeRandDistribution* handle = GetHandle(env, info, argc, nullptr);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    const T value = handle->m_distribution(handle->m_parent->Generator());
+    NODE_RAND_STAT(handle->m_parent->Stats(), AddValues(1));
+
+    napi_value result;
+    if constexpr (std::is_floating_point<T>::value) {
+        napi_extensions::CheckStatus(napi_create_double(env, value, &result), env, "Failed to create double");
+    }
+    else {
+        napi_extensions::CheckStatus(napi_create_int64(env, value, &result), env, "Failed to create int64");
+    }
+    return result;
+}
+
+template<class GENERATOR, class DISTRIBUTION>
+napi_value NodeRandDistribution<GENERATOR, DISTRIBUTION>::Fill(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    NodeRandDistribution* handle = GetHandle(env, info, argc, argv);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    assert(argc == 1 && "invalid number of arguments");
+
+    napi_extensions::NapiArgTypedArray arg0;
+    arg0.SetVal(env, argv[0]);
+    napi_extensions::NapiTypedArrayInfo array = arg0.GetVal();
+
+    const T min = handle->m_distribution.min();
+    const T max = handle->m_distribution.max();
+
+    bool supported = false;
+    VisitType(array.type, [&] (auto tag) {
+        typedef typename decltype(tag)::type E;
+        if constexpr (std::is_integral<E>::value && std::is_integral<T>::value) {
+            supported = InRange<E>(min) && InRange<E>(max);
+        }
+        else {
+            supported = std::is_floating_point<E>::value;
+        }
+        if (supported) {
+            handle->FillAs(static_cast<E*>(array.data), array.length);
+            NODE_RAND_STAT(handle->m_parent->Stats(), AddValues(array.length));
+        }
+    });
+
+    if (!supported) {
+        std::stringstream ss;
+        ss << "Unsupported TypedArray for distribution. Min: " << min << ", Max: " << max
+           << ". Expecting an integer array the range fits in for integers, or Float32Array/Float64Array" << std::endl;
+        napi_throw_type_error(env, nullptr, ss.str().c_str());
+        return nullptr;
+    }
+    return array.value;
+}
+
+template<class GENERATOR, class DISTRIBUTION>
+napi_value NodeRandDistribution<GENERATOR, DISTRIBUTION>::Stream(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value argv[2];
+    NodeRandDistribution* handle = GetHandle(env, info, argc, argv);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    assert((argc == 1 || argc == 2) && "invalid number of arguments");
+
+    napi_extensions::NapiArgUint32 arg0;
+    arg0.SetVal(env, argv[0]);
+    uint32_t count = arg0.GetVal();
+
+    StreamOptions options;
+    options.type = TypeOf<T>();
+    if (!GetStreamOptions(env, argc == 2 ? argv[1] : nullptr, options)) {
+        return nullptr;
+    }
+
+    if (options.type != TypeOf<T>()) {
+        std::stringstream ss;
+        ss << "Stream type must match the distribution. type: " << TypeName(options.type) << std::endl;
+        napi_throw_type_error(env, nullptr, ss.str().c_str());
+        return nullptr;
+    }
+
+    // get thread-safe seed off global or the stream's fork, same as GenerateSequenceStream
+    NodeRand<GENERATOR>* parent = handle->m_parent;
+    return NodeRandStream<T, GENERATOR, DISTRIBUTION>::NewInstance(env, NodeRand<GENERATOR>::ReadableCtor(env), parent->StreamSeed(options),
+        handle->m_distribution, count, options, parent->Stats());
+}
+
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "napi_extensions.h"
+#include "NodeRNG.h"
+#include "NodeParallelOptions.h"
+#include "NodeRandTypes.h"
+
+#include <node_api.h>
+#include <assert.h>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace node_rand {
+
+/// \brief Caller-owned TypedArray to fill with random numbers between [min, max]
+struct FillTarget {
+    // TypedArray type, any of SUPPORTED_TYPES
+    napi_typedarray_type type{napi_int32_array};
+    // pointer to first element (owned by JS)
+    void* data{nullptr};
+    // number of elements
+    size_t length{0};
+    // bounds for integer arrays. BigUint64Array bounds are stored as their two's complement bits
+    int64_t min{0};
+    int64_t max{0};
+    // bounds for floating point arrays
+    double real_min{0};
+    double real_max{0};
+    // parallel mode thread count, 0 fills sequentially from one generator
+    uint32_t threads{0};
+
+    /// \brief Uniform distribution over [min, max] for element type T
+    template<class T>
+    NodeRNGUniformDistribution<T> Distribution() const {
+        if constexpr (std::is_floating_point<T>::value) {
+            return NodeRNGUniformDistribution<T>(real_min, real_max);
+        }
+        else {
+            return NodeRNGUniformDistribution<T>(static_cast<T>(min), static_cast<T>(max));
+        }
+    }
+};
+
+/// \class NodeRandFill
+/// \brief Fills caller-owned TypedArrays in place, synchronously or on a libuv worker.
+template<class GENERATOR>
+class NodeRandFill {
+private:
+
+    /// \brief data needed during async function queue
+    struct AsyncFunctionData {
+        // seed of the rng, or of the parallel sequence
+        uint64_t seed;
+        // what to fill
+        FillTarget target;
+        // async work item
+        napi_async_work work{nullptr};
+        // promise to resolve once filled
+        napi_deferred deferred{nullptr};
+        // reference to the TypedArray, keeps it alive while the worker writes to it
+        napi_ref array_ref{nullptr};
+    };
+
+    template<class T, class DISTRIBUTION>
+    static void FillWith(GENERATOR& generator, DISTRIBUTION distribution, T* out, size_t length) {
+        distribution.Fill(generator, out, length);
+    }
+
+    template<class T, class DISTRIBUTION>
+    static void FillWith(uint64_t seed, uint32_t threads, const DISTRIBUTION& distribution, T* out, size_t length) {
+        ParallelFill<T, GENERATOR>(seed, threads, distribution, out, length);
+    }
+
+    static void ExecuteAsyncFunction(napi_env env, void* data);
+    static void CompleteAsyncFunction(napi_env env, napi_status status, void* data);
+
+public:
+    NodeRandFill() = delete;
+
+    /// \brief Parse (TypedArray, min, max, options?) arguments. Throws a JS error and returns false if invalid.
+    static bool GetTarget(napi_env env, napi_callback_info info, FillTarget& target);
+
+    /// \brief Fill target with random numbers on the calling thread
+    static void Fill(GENERATOR& generator, const FillTarget& target);
+
+    /// \brief Fill target with the parallel sequence of seed, using target.threads threads. See NodeParallel.h
+    static void FillParallel(uint64_t seed, const FillTarget& target);
+
+    /// \brief Fill target on a libuv worker, from GENERATOR(seed) or the parallel sequence of seed if target.threads is set
+    /// \return Promise resolved with the filled TypedArray
+    static napi_value FillAsync(napi_env env, napi_value typedArray, const FillTarget& target, uint64_t seed);
+};
+
+template<class GENERATOR>
+bool NodeRandFill<GENERATOR>::GetTarget(napi_env env, napi_callback_info info, FillTarget& target)
+{
+    size_t argc = 4;
+    napi_value argv[4];
+    napi_extensions::CheckStatus(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr), env, "Failed to get cb info. NodeRandFill::GetTarget");
+    assert((argc == 3 || argc == 4) && "invalid number of arguments");
+
+    napi_extensions::NapiArgTypedArray arg0;
+    arg0.SetVal(env, argv[0]);
+    napi_extensions::NapiTypedArrayInfo array = arg0.GetVal();
+
+    target.type = array.type;
+    target.data = array.data;
+    target.length = array.length;
+
+    bool valid = false;
+    const bool supported = VisitType(target.type, [&] (auto tag) {
+        typedef typename decltype(tag)::type T;
+        T min{}, max{};
+        valid = GetTypedRange(env, argv[1], argv[2], target.type, min, max);
+        if constexpr (std::is_floating_point<T>::value) {
+            target.real_min = min;
+            target.real_max = max;
+        }
+        else {
+            target.min = static_cast<int64_t>(min);
+            target.max = static_cast<int64_t>(max);
+        }
+    });
+
+    if (!supported) {
+        std::stringstream ss;
+        ss << "Unsupported TypedArray. Expecting an integer array, Float32Array, Float64Array, BigInt64Array or BigUint64Array" << std::endl;
+        napi_throw_type_error(env, nullptr, ss.str().c_str());
+        return false;
+    }
+    if (!valid) {
+        return false;
+    }
+
+    napi_extensions::NapiOptions options(env, argc == 4 ? argv[3] : nullptr);
+    return GetThreadsOption(env, options, target.threads);
+}
+
+template<class GENERATOR>
+void NodeRandFill<GENERATOR>::Fill(GENERATOR& generator, const FillTarget& target)
+{
+    const bool supported = VisitType(target.type, [&] (auto tag) {
+        typedef typename decltype(tag)::type T;
+        FillWith(generator, target.Distribution<T>(), static_cast<T*>(target.data), target.length);
+    });
+    if (!supported) {
+        assert(false && "Unsupported TypedArray");
+    }
+}
+
+template<class GENERATOR>
+void NodeRandFill<GENERATOR>::FillParallel(uint64_t seed, const FillTarget& target)
+{
+    const bool supported = VisitType(target.type, [&] (auto tag) {
+        typedef typename decltype(tag)::type T;
+        FillWith(seed, target.threads, target.Distribution<T>(), static_cast<T*>(target.data), target.length);
+    });
+    if (!supported) {
+        assert(false && "Unsupported TypedArray");
+    }
+}
+
+// NOTE: CANNOT EXECUTE JS IN THIS BLOCK!
+template<class GENERATOR>
+void NodeRandFill<GENERATOR>::ExecuteAsyncFunction(napi_env env, void* data)
+{
+    AsyncFunctionData* async_data = (AsyncFunctionData*)data;
+    if (async_data->target.threads > 0) {
+        FillParallel(async_data->seed, async_data->target);
+    }
+    else {
+        GENERATOR generator(async_data->seed);
+        Fill(generator, async_data->target);
+    }
+}
+
+template<class GENERATOR>
+void NodeRandFill<GENERATOR>::CompleteAsyncFunction(napi_env env, napi_status status, void* data)
+{
+    AsyncFunctionData* async_data = (AsyncFunctionData*)data;
+
+    napi_value typed_array = nullptr;
+    napi_status s = napi_get_reference_value(env, async_data->array_ref, &typed_array);
+    assert(s == napi_ok);
+
+    // settling fails when the env is stopping (worker terminated), the promise goes away with it
+    if (status == napi_ok) {
+        napi_resolve_deferred(env, async_data->deferred, typed_array);
+    }
+    else {
+        napi_value message = nullptr, error = nullptr;
+        s = napi_create_string_utf8(env, "GenerateIntoAsync cancelled", NAPI_AUTO_LENGTH, &message);
+        if (s == napi_ok) {
+            s = napi_create_error(env, nullptr, message, &error);
+        }
+        if (s == napi_ok) {
+            napi_reject_deferred(env, async_data->deferred, error);
+        }
+    }
+
+    napi_delete_reference(env, async_data->array_ref);
+    async_data->array_ref = nullptr;
+
+    napi_delete_async_work(env, async_data->work);
+    async_data->work = nullptr;
+
+    delete async_data;
+    async_data = nullptr;
+}
+
+template<class GENERATOR>
+napi_value NodeRandFill<GENERATOR>::FillAsync(napi_env env, napi_value typedArray, const FillTarget& target, uint64_t seed)
+{
+    AsyncFunctionData* async_data = new AsyncFunctionData({seed, target});
+
+    napi_value promise;
+    napi_status status = napi_create_promise(env, &async_data->deferred, &promise);
+    assert(status == napi_ok);
+
+    status = napi_create_reference(env, typedArray, 1, &async_data->array_ref);
+    assert(status == napi_ok);
+
+    napi_value async_name;
+    status = napi_create_string_utf8(env, "generate_into_async", NAPI_AUTO_LENGTH, &async_name);
+    assert(status == napi_ok);
+
+    status = napi_create_async_work(env, nullptr, async_name, ExecuteAsyncFunction, CompleteAsyncFunction, async_data, &(async_data->work));
+    assert(status == napi_ok);
+
+    status = napi_queue_async_work(env, async_data->work);
+    assert(status == napi_ok);
+
+    return promise;
+}
+
+}
@@ -0,0 +1,229 @@
+#include "NodeRandRing.h"
+#include "NodeRandTypes.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace node_rand;
+using namespace napi_extensions;
+
+// the header is accessed as Int32Array by Atomics in JS
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t) && std::atomic<int32_t>::is_always_lock_free,
+    "ring header needs lock free int32 atomics");
+
+bool node_rand::GetRingOptions(napi_env env, napi_value value, RingOptions& options)
+{
+    NapiOptions opts(env, value);
+    options.slots = opts.GetUint32("slots", options.slots);
+    options.sliceSize = opts.GetUint32("sliceSize", options.sliceSize);
+    options.lowWater = opts.GetUint32("lowWater", options.slots / 2);
+
+    if (!GetTypeOption(env, opts, options.stream.type) || !GetStreamIdOption(env, opts, options.stream)) {
+        return false;
+    }
+
+    std::stringstream ss;
+    if (options.slots < 2 || options.slots > MAX_RING_SLOTS || (options.slots & (options.slots - 1)) != 0) {
+        ss << "slots must be a power of two between 2 and " << MAX_RING_SLOTS << ". slots: " << options.slots << std::endl;
+    }
+    else if (options.sliceSize < 1 || options.sliceSize > MAX_RING_SLICE_SIZE) {
+        ss << "sliceSize must be between 1 and " << MAX_RING_SLICE_SIZE << ". sliceSize: " << options.sliceSize << std::endl;
+    }
+    else if (options.lowWater >= options.slots) {
+        ss << "lowWater must be less than slots. lowWater: " << options.lowWater << ", slots: " << options.slots << std::endl;
+    }
+
+    if (!ss.str().empty()) {
+        napi_throw_range_error(env, nullptr, ss.str().c_str());
+        return false;
+    }
+    return true;
+}
+
+napi_value NodeRandRing::Create(napi_env env, const RingOptions& options, size_t elementSize, FillFunction fill)
+{
+    const uint64_t dataOffset = (uint64_t(RingSequence + options.slots) * sizeof(int32_t) + 63) / 64 * 64;
+    const uint64_t byteLength = dataOffset + uint64_t(options.slots) * options.sliceSize * elementSize;
+    if (byteLength > MAX_RING_BYTES) {
+        std::stringstream ss;
+        ss << "Ring too large, slots * sliceSize * element size must be at most " << MAX_RING_BYTES << " bytes" << std::endl;
+        napi_throw_range_error(env, nullptr, ss.str().c_str());
+        return nullptr;
+    }
+
+    // no napi call creates a SharedArrayBuffer, construct it and a Uint8Array view to get its data
+    napi_value global = nullptr, sharedCtor = nullptr, viewCtor = nullptr;
+    CheckStatus(napi_get_global(env, &global), env, "NodeRandRing::Create get global");
+    CheckStatus(napi_get_named_property(env, global, "SharedArrayBuffer", &sharedCtor), env, "NodeRandRing::Create get SharedArrayBuffer");
+    napi_valuetype type = napi_undefined;
+    if (sharedCtor != nullptr) {
+        CheckStatus(napi_typeof(env, sharedCtor, &type), env, "Failed to get napi typeof");
+    }
+    if (type != napi_function) {
+        napi_throw_error(env, nullptr, "SharedArrayBuffer is not available");
+        return nullptr;
+    }
+
+    napi_value length = nullptr, buffer = nullptr, view = nullptr;
+    CheckStatus(napi_create_double(env, static_cast<double>(byteLength), &length), env, "Failed to create double");
+    if (napi_new_instance(env, sharedCtor, 1, &length, &buffer) != napi_ok) {
+        // allocation failed, the JS error is pending
+        return nullptr;
+    }
+    CheckStatus(napi_get_named_property(env, global, "Uint8Array", &viewCtor), env, "NodeRandRing::Create get Uint8Array");
+    CheckStatus(napi_new_instance(env, viewCtor, 1, &buffer, &view), env, "NodeRandRing::Create new Uint8Array");
+    void* data = nullptr;
+    CheckStatus(napi_get_typedarray_info(env, view, nullptr, nullptr, &data, nullptr, nullptr), env, "NodeRandRing::Create get data");
+    if (data == nullptr) {
+        return nullptr;
+    }
+
+    NodeRandRing* ring = nullptr;
+    napi_value jsthis = NewInstance(env, &ring);
+    if (ring == nullptr) {
+        return nullptr;
+    }
+    CheckStatus(napi_create_reference(env, buffer, 1, &ring->m_bufferRef), env, "NodeRandRing::Create buffer reference");
+
+    ring->m_header = static_cast<std::atomic<int32_t>*>(data);
+    ring->m_data = static_cast<uint8_t*>(data) + dataOffset;
+    ring->m_sliceBytes = options.sliceSize * elementSize;
+    ring->m_slots = options.slots;
+    ring->m_sliceSize = options.sliceSize;
+    ring->m_lowWater = options.lowWater;
+    ring->m_fill = std::move(fill);
+
+    std::atomic<int32_t>* header = ring->m_header;
+    header[RingHead].store(0);
+    header[RingClosed].store(0);
+    header[RingSlots].store(static_cast<int32_t>(options.slots));
+    header[RingSliceSize].store(static_cast<int32_t>(options.sliceSize));
+    header[RingType].store(static_cast<int32_t>(options.stream.type));
+    header[RingDataOffset].store(static_cast<int32_t>(dataOffset));
+    header[RingWait].store(0);
+    // every slot free for its first position
+    for (uint32_t i = 0; i < options.slots; i++) {
+        header[RingSequence + i].store(static_cast<int32_t>(i));
+    }
+
+    ring->m_thread = std::thread(&NodeRandRing::Produce, ring);
+    const napi_status hooked = napi_add_env_cleanup_hook(env, Cleanup, ring);
+    CheckStatus(hooked, env, "NodeRandRing::Create cleanup hook");
+    ring->m_hooked = hooked == napi_ok;
+    return jsthis;
+}
+
+void NodeRandRing::Produce()
+{
+    std::atomic<int32_t>& head = m_header[RingHead];
+    std::atomic<int32_t>* sequence = m_header + RingSequence;
+
+    uint32_t pos = 0;
+    bool refill = true;
+    std::chrono::microseconds idle = RING_MIN_POLL;
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        // filled slots not claimed yet
+        const int32_t filled = static_cast<int32_t>(pos - static_cast<uint32_t>(head.load(std::memory_order_acquire)));
+        refill = refill || filled <= static_cast<int32_t>(m_lowWater);
+
+        const uint32_t slot = pos & (m_slots - 1);
+        if (refill && sequence[slot].load(std::memory_order_acquire) == static_cast<int32_t>(pos)) {
+            m_fill(m_data + slot * m_sliceBytes, m_sliceSize);
+            sequence[slot].store(static_cast<int32_t>(pos + 1), std::memory_order_release);
+            m_produced.fetch_add(1, std::memory_order_relaxed);
+            pos++;
+            idle = RING_MIN_POLL;
+            continue;
+        }
+
+        // full, or its oldest slot is still being copied by a reader
+        refill = false;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait_for(lock, idle, [this] { return m_stop.load(); });
+        idle = std::min(idle * 2, RING_MAX_POLL);
+    }
+    m_header[RingClosed].store(1);
+}
+
+void NodeRandRing::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void NodeRandRing::Cleanup(void* arg)
+{
+    NodeRandRing* ring = static_cast<NodeRandRing*>(arg);
+    ring->Stop();
+    ring->m_hooked = false;
+}
+
+NodeRandRing::~NodeRandRing()
+{
+    Stop();
+    if (m_hooked) {
+        napi_remove_env_cleanup_hook(m_env, Cleanup, this);
+    }
+    if (m_bufferRef != nullptr) {
+        napi_delete_reference(m_env, m_bufferRef);
+    }
+}
+
+NodeRandRing* NodeRandRing::GetHandle(napi_env env, napi_callback_info info)
+{
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr), env, "NodeRandRing get cb info");
+
+    NodeRandRing* handle = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&handle)), env, "NodeRandRing unwrap");
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    if (handle->m_bufferRef == nullptr) {
+        napi_throw_error(env, nullptr, "RandomRing has no buffer. Create it with rng.SharedRing(min, max, options)");
+        return nullptr;
+    }
+    return handle;
+}
+
+napi_value NodeRandRing::Buffer(napi_env env, napi_callback_info info)
+{
+    NodeRandRing* handle = GetHandle(env, info);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    napi_value buffer = nullptr;
+    CheckStatus(napi_get_reference_value(env, handle->m_bufferRef, &buffer), env, "NodeRandRing::Buffer get reference");
+    return buffer;
+}
+
+napi_value NodeRandRing::Close(napi_env env, napi_callback_info info)
+{
+    NodeRandRing* handle = GetHandle(env, info);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    handle->Stop();
+    return nullptr;
+}
+
+napi_value NodeRandRing::Produced(napi_env env, napi_callback_info info)
+{
+    NodeRandRing* handle = GetHandle(env, info);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    napi_value result;
+    const double produced = static_cast<double>(handle->m_produced.load()) * handle->m_sliceSize;
+    CheckStatus(napi_create_double(env, produced, &result), env, "Failed to create double");
+    return result;
+}
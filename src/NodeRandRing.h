@@ -0,0 +1,156 @@
+#pragma once
+
+#include "napi_extensions.h"
+#include "NodeRandStream.h"
+
+#include <node_api.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace node_rand {
+
+/**
+ * Shared ring
+ *
+ * A producer thread keeps a SharedArrayBuffer filled with random numbers. Any thread holding the buffer reads
+ * them with RingReader (ring.js), claiming whole slots with Atomics, without calling into the addon.
+ *
+ *   Int32 [0, RING_SEQUENCE)                  header, see RingHeader
+ *   Int32 [RING_SEQUENCE, + slots)            sequence number of every slot
+ *   bytes [header[RingDataOffset], ...)       slots * sliceSize elements of type
+ *
+ * The slots are a bounded queue with one sequence number per slot (Vyukov). Position pos lives in slot
+ * pos & (slots - 1), which the producer may fill when its sequence is pos and a reader may claim when it is
+ * pos + 1. A reader claims position head with a CAS of head to head + 1, copies the slot and stores
+ * pos + slots to hand it back. Positions are int32 and wrap, so slots is a power of two.
+ *
+ * The producer fills slots until the ring is full, then sleeps until lowWater filled slots or fewer are left.
+ * Readers cannot wake it, it polls with a backoff from RING_MIN_POLL to RING_MAX_POLL while idle.
+ * In position order the slots hold the numbers GenerateSequenceStream emits for the same seed, range and type.
+ */
+
+/// \brief Int32 fields of the ring header. Same indices in ring.js
+enum RingHeader {
+    // next position to claim, CAS by readers
+    RingHead = 0,
+    // 1 once the producer stopped
+    RingClosed = 1,
+    RingSlots = 2,
+    RingSliceSize = 3,
+    // napi_typedarray_type of the elements
+    RingType = 4,
+    // byte offset of slot 0
+    RingDataOffset = 5,
+    // always 0, readers of worker threads Atomics.wait on it to back off
+    RingWait = 6,
+    // first slot sequence number, the header is one cache line
+    RingSequence = 16
+};
+
+/// \brief Upper bound of the slots option
+static const uint32_t MAX_RING_SLOTS = 1 << 16;
+
+/// \brief Upper bound of the sliceSize option, in numbers
+static const uint32_t MAX_RING_SLICE_SIZE = 1 << 20;
+
+/// \brief Upper bound of the buffer size in bytes
+static const size_t MAX_RING_BYTES = size_t(1) << 30;
+
+/// \brief Producer poll interval while idle, doubled up to RING_MAX_POLL
+static const std::chrono::microseconds RING_MIN_POLL{50};
+static const std::chrono::microseconds RING_MAX_POLL{2000};
+
+/// \brief SharedRing options
+struct RingOptions {
+    // slots in the ring, power of two
+    uint32_t slots{16};
+    // numbers per slot, what readers claim at once
+    uint32_t sliceSize{4096};
+    // refill once this many filled slots or fewer are left, < slots
+    uint32_t lowWater{8};
+    // type and streamId, see StreamOptions. Other stream options are not used
+    StreamOptions stream;
+};
+
+/// \brief Parse optional { slots, sliceSize, lowWater, type, streamId } object. Throws a JS error and returns false if invalid.
+bool GetRingOptions(napi_env env, napi_value value, RingOptions& options);
+
+/// \class NodeRandRing
+/// \brief Producer of a shared ring, returned by rng.SharedRing(min, max, options). Buffer() is what readers attach to.
+/// \note The producer stops on Close(), when the handle is garbage collected, or when its env shuts down.
+///       Readers get an error once a closed ring is drained, keep the handle alive while they read.
+class NodeRandRing : public napi_extensions::NapiObjectWrap<NodeRandRing> {
+public:
+    /// \brief Writes count numbers to out, called on the producer thread only
+    typedef std::function<void(void* out, size_t count)> FillFunction;
+
+private:
+    // keeps the SharedArrayBuffer alive while the producer writes to it
+    napi_ref m_bufferRef{nullptr};
+    // start of the SharedArrayBuffer, header and sequence numbers
+    std::atomic<int32_t>* m_header{nullptr};
+    // slot 0
+    uint8_t* m_data{nullptr};
+    size_t m_sliceBytes{0};
+    uint32_t m_slots{0};
+    uint32_t m_sliceSize{0};
+    uint32_t m_lowWater{0};
+    FillFunction m_fill;
+
+    // slots produced
+    std::atomic<uint64_t> m_produced{0};
+    std::atomic<bool> m_stop{false};
+    // the env cleanup hook is registered
+    bool m_hooked{false};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+
+    /// \brief Producer thread body
+    void Produce();
+
+    /// \brief Stop and join the producer. Idempotent.
+    void Stop();
+
+    /// \brief Env cleanup hook, stops the producer before the env frees the buffer
+    static void Cleanup(void* arg);
+
+    /// \brief Unwrap this. Throws a JS error and returns nullptr if the handle has no ring.
+    static NodeRandRing* GetHandle(napi_env env, napi_callback_info info);
+
+    /// \brief Buffer readers attach to with new RingReader(buffer), may be posted to workers
+    /// \return SharedArrayBuffer
+    static napi_value Buffer(napi_env env, napi_callback_info info);
+
+    /// \brief Stop the producer. Readers drain the filled slots, then get an error.
+    /// \return null
+    static napi_value Close(napi_env env, napi_callback_info info);
+
+    /// \brief Numbers produced so far
+    /// \return number
+    static napi_value Produced(napi_env env, napi_callback_info info);
+
+public:
+    static std::vector<napi_property_descriptor> GetClassProps() {
+        std::vector<napi_property_descriptor> props{
+            { "Buffer", 0, Buffer, 0, 0, 0, napi_default, 0 },
+            { "Close", 0, Close, 0, 0, 0, napi_default, 0 },
+            { "Produced", 0, Produced, 0, 0, 0, napi_default, 0 }
+        };
+        return props;
+    }
+
+    /// \brief Allocate the SharedArrayBuffer, lay out the header and start the producer
+    /// \param elementSize bytes per number of options.stream.type
+    /// \return handle, nullptr after throwing a JS error if the ring is too large or SharedArrayBuffer is unavailable
+    static napi_value Create(napi_env env, const RingOptions& options, size_t elementSize, FillFunction fill);
+
+    ~NodeRandRing();
+};
+
+}
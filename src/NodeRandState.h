@@ -0,0 +1,266 @@
+#pragma once
+
+#include "NodeEngines.h"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace node_rand {
+
+/**
+ * Generator state
+ *
+ * GetState/SetState snapshot an instance in a compact binary format, little endian on every platform:
+ *
+ *   0   char[4]   "NRST"
+ *   4   uint16    STATE_VERSION
+ *   6   uint16    engine id, EngineId<GENERATOR>
+ *   8   uint64    real seed of the instance's NodeGlobalBuffer
+ *  16   uint64    index of its next pseudo seed
+ *  24   uint32    flags, STATE_SEED_RESET: the generator is reseeded with the next pseudo seed before its next use
+ *  28   uint32    n, number of engine words
+ *  32   uint64[n] engine words
+ *
+ * Engine words are the numbers of the engine's textual state for the engines of NodeEngines.h: key words and
+ * output position for counter engines, the state words for xoshiro256**, pcg64 and splitmix64.
+ * Mersenne twisters store X(i-n)..X(i-1), the standard's textual state. Standard libraries lay it out and print it
+ * differently, so it is rebuilt from the next n outputs on save and loaded through seed(seq) on restore, which
+ * the standard defines exactly. Only the top bit of X(i-n) takes part in later outputs, its other bits are 0.
+ */
+
+/// \brief "NRST" read as a little endian uint32
+static const uint32_t STATE_MAGIC = 0x5453524E;
+
+/// \brief Format version, bumped on any layout change
+static const uint16_t STATE_VERSION = 1;
+
+/// \brief Header bytes before the engine words
+static const size_t STATE_HEADER_SIZE = 32;
+
+/// \brief Flag of a state taken between SetSeed and the next draw
+static const uint32_t STATE_SEED_RESET = 1;
+
+/// \brief Upper bound of engine words, std::mt19937 has the most with 624
+static const uint32_t MAX_STATE_WORDS = 1024;
+
+/// \brief Stable id of an engine in the state format. Never reuse or renumber.
+template<class GENERATOR>
+struct EngineId;
+
+template<> struct EngineId<std::mt19937> : std::integral_constant<uint16_t, 1> {};
+template<> struct EngineId<std::mt19937_64> : std::integral_constant<uint16_t, 2> {};
+template<> struct EngineId<philox4x32> : std::integral_constant<uint16_t, 3> {};
+template<> struct EngineId<threefry4x64> : std::integral_constant<uint16_t, 4> {};
+template<> struct EngineId<xoshiro256ss> : std::integral_constant<uint16_t, 5> {};
+template<> struct EngineId<pcg64> : std::integral_constant<uint16_t, 6> {};
+template<> struct EngineId<splitmix64> : std::integral_constant<uint16_t, 7> {};
+
+/// \brief Decoded state, see the format above
+struct NodeRandState {
+    uint16_t engine{0};
+    uint64_t seed{0};
+    uint64_t index{0};
+    uint32_t flags{0};
+    std::vector<uint64_t> words;
+};
+
+namespace state_detail {
+
+inline void Put(std::vector<uint8_t>& out, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+inline uint64_t Get(const uint8_t* in, size_t bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+/// \brief Seed sequence writing fixed words, 32 bits at a time as mersenne_twister_engine::seed(q) reads them
+class WordSeedSeq {
+    const std::vector<uint64_t>& m_words;
+    size_t m_wordBits;
+
+public:
+    typedef uint32_t result_type;
+
+    WordSeedSeq(const std::vector<uint64_t>& words, size_t wordBits) : m_words(words), m_wordBits(wordBits) {}
+
+    template<class IT>
+    void generate(IT begin, IT end) const {
+        // each word is ceil(w / 32) values, low half first
+        const size_t perWord = (m_wordBits + 31) / 32;
+        for (size_t k = 0; begin != end; ++begin, ++k) {
+            const size_t word = k / perWord;
+            *begin = word < m_words.size() ? static_cast<uint32_t>(m_words[word] >> (32 * (k % perWord))) : 0;
+        }
+    }
+
+    size_t size() const { return 0; }
+
+    template<class IT>
+    void param(IT) const {}
+};
+
+}
+
+/// \brief Engine words of an engine of NodeEngines.h, the numbers of its textual state
+template<class GENERATOR>
+std::vector<uint64_t> EngineWords(const GENERATOR& generator)
+{
+    std::stringstream ss;
+    ss << generator;
+    std::vector<uint64_t> words;
+    uint64_t word = 0;
+    while (ss >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+/// \brief Restore an engine of NodeEngines.h from its words
+/// \return false if words is not a state of GENERATOR
+template<class GENERATOR>
+bool SetEngineWords(GENERATOR& generator, const std::vector<uint64_t>& words)
+{
+    if (words.size() != EngineWords(generator).size()) {
+        return false;
+    }
+    std::stringstream ss;
+    for (uint64_t word : words) {
+        ss << word << ' ';
+    }
+    GENERATOR restored;
+    // words out of range of the engine's fields do not read back the same
+    if (!(ss >> restored) || EngineWords(restored) != words) {
+        return false;
+    }
+    generator = restored;
+    return true;
+}
+
+/// \brief X(i-n)..X(i-1) of a mersenne twister, rebuilt from its next n outputs
+template<class UINT, size_t W, size_t N, size_t M, size_t R, UINT A, size_t U, UINT D, size_t S, UINT B, size_t T, UINT C, size_t L, UINT F>
+std::vector<uint64_t> EngineWords(const std::mersenne_twister_engine<UINT, W, N, M, R, A, U, D, S, B, T, C, L, F>& generator)
+{
+    static_assert(W <= 64 && (A >> (W - 1)) == 1, "A must have its top bit set to invert the twist");
+    const UINT all = W == std::numeric_limits<UINT>::digits ? ~UINT(0) : (UINT(1) << W) - 1;
+    const UINT upper = (all << R) & all;
+    const UINT lower = all & ~upper;
+    const UINT top = UINT(1) << (W - 1);
+
+    // inverse of y ^= (y >> shift) & mask and y ^= (y << shift) & mask, shift bits are settled per round
+    auto unshiftRight = [] (UINT y, size_t shift, UINT mask) {
+        UINT x = y;
+        for (size_t settled = shift; settled < W; settled += shift) {
+            x = y ^ ((x >> shift) & mask);
+        }
+        return x;
+    };
+    auto unshiftLeft = [all] (UINT y, size_t shift, UINT mask) {
+        UINT x = y;
+        for (size_t settled = shift; settled < W; settled += shift) {
+            x = y ^ ((x << shift) & mask & all);
+        }
+        return x;
+    };
+
+    // x[k] is X(i - n + k), x[n, 2n) the untempered next n outputs
+    std::vector<UINT> x(2 * N);
+    std::mersenne_twister_engine<UINT, W, N, M, R, A, U, D, S, B, T, C, L, F> ahead(generator);
+    for (size_t k = N; k < 2 * N; k++) {
+        UINT y = ahead();
+        y = unshiftRight(y, L, all);
+        y = unshiftLeft(y, T, C);
+        y = unshiftLeft(y, S, B);
+        x[k] = unshiftRight(y, U, D);
+    }
+
+    // X(j + n) = X(j + m) ^ twist(upper(X(j)) | lower(X(j + 1))), backwards from j = i - 1
+    for (size_t j = N; j-- > 0;) {
+        const UINT t = x[j + N] ^ x[j + M];
+        const UINT y = ((t & top) ? (((t ^ A) << 1) | 1) : (t << 1)) & all;
+        x[j] = (x[j] & lower) | (y & upper);
+        x[j + 1] = (x[j + 1] & upper) | (y & lower);
+    }
+    x[0] &= upper;
+    return std::vector<uint64_t>(x.begin(), x.begin() + N);
+}
+
+/// \brief Restore a mersenne twister from X(i-n)..X(i-1)
+template<class UINT, size_t W, size_t N, size_t M, size_t R, UINT A, size_t U, UINT D, size_t S, UINT B, size_t T, UINT C, size_t L, UINT F>
+bool SetEngineWords(std::mersenne_twister_engine<UINT, W, N, M, R, A, U, D, S, B, T, C, L, F>& generator, const std::vector<uint64_t>& words)
+{
+    if (words.size() != N) {
+        return false;
+    }
+    if constexpr (W < 64) {
+        for (uint64_t word : words) {
+            if ((word >> W) != 0) {
+                return false;
+            }
+        }
+    }
+    state_detail::WordSeedSeq seq(words, W);
+    generator.seed(seq);
+    return true;
+}
+
+/// \brief Encode state, see the format above
+inline std::vector<uint8_t> EncodeState(const NodeRandState& state)
+{
+    std::vector<uint8_t> out;
+    out.reserve(STATE_HEADER_SIZE + state.words.size() * sizeof(uint64_t));
+    state_detail::Put(out, STATE_MAGIC, 4);
+    state_detail::Put(out, STATE_VERSION, 2);
+    state_detail::Put(out, state.engine, 2);
+    state_detail::Put(out, state.seed, 8);
+    state_detail::Put(out, state.index, 8);
+    state_detail::Put(out, state.flags, 4);
+    state_detail::Put(out, state.words.size(), 4);
+    for (uint64_t word : state.words) {
+        state_detail::Put(out, word, 8);
+    }
+    return out;
+}
+
+/// \brief Decode state, see the format above
+/// \return error message, empty on success
+inline std::string DecodeState(const uint8_t* data, size_t length, NodeRandState& state)
+{
+    if (length < STATE_HEADER_SIZE || state_detail::Get(data, 4) != STATE_MAGIC) {
+        return "Not a generator state, expecting a Buffer returned by GetState()";
+    }
+    const uint64_t version = state_detail::Get(data + 4, 2);
+    if (version != STATE_VERSION) {
+        std::stringstream ss;
+        ss << "Unsupported state version " << version << ", expecting " << STATE_VERSION;
+        return ss.str();
+    }
+    state.engine = static_cast<uint16_t>(state_detail::Get(data + 6, 2));
+    state.seed = state_detail::Get(data + 8, 8);
+    state.index = state_detail::Get(data + 16, 8);
+    state.flags = static_cast<uint32_t>(state_detail::Get(data + 24, 4));
+    const uint64_t count = state_detail::Get(data + 28, 4);
+    if (count > MAX_STATE_WORDS || length != STATE_HEADER_SIZE + count * sizeof(uint64_t)) {
+        return "Truncated or corrupt generator state";
+    }
+    state.words.resize(static_cast<size_t>(count));
+    for (size_t i = 0; i < state.words.size(); i++) {
+        state.words[i] = state_detail::Get(data + STATE_HEADER_SIZE + i * sizeof(uint64_t), 8);
+    }
+    return std::string();
+}
+
+}
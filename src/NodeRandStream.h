@@ -1,8 +1,14 @@
 #pragma once
 
 #include "napi_extensions.h"
+#include "NodeBufferPool.h"
+#include "NodeGeneratorPool.h"
+#include "NodeParallelOptions.h"
+#include "NodeRandTypes.h"
+#include "NodeStats.h"
 
 #include <node_api.h>
+#include <atomic>
 #include <memory>
 #include <assert.h>
 #include <random>
@@ -11,117 +17,406 @@
 #include <string>
 #include <thread>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <cstring>
+#include <mutex>
+#include <sstream>
 
 namespace node_rand {
 
+/// \brief Default chunk size. 16kb is the default highWaterMark of a Node JS Readable stream. 16kb -> 2000 int64_t
+///        Chunks are tightly packed, so narrower types make smaller chunks for the same count.
+static const uint32_t DEFAULT_CHUNK_SIZE = 2000;
+
+/// \brief Bounds for chunk size (numbers per chunk). Adaptive chunks stay within them.
+static const uint32_t MIN_CHUNK_SIZE = 64;
+static const uint32_t MAX_CHUNK_SIZE = 1 << 20;
+
+/// \brief Default Readable highWaterMark of adaptive streams. Adaptive chunks grow up to half the highWaterMark, so
+///        one chunk alone never makes push() return false.
+static const uint32_t ADAPTIVE_HIGH_WATER_MARK = 2 * 1024 * 1024;
+
+/// \brief Max chunks waiting on the tsfn queue. Worker blocks once reached.
+static const size_t MAX_QUEUED_CHUNKS = 2;
+
+/// \brief GenerateSequenceStream options
+struct StreamOptions {
+    // numbers per chunk, initial size when adaptive
+    uint32_t chunkSize{DEFAULT_CHUNK_SIZE};
+    // Readable highWaterMark in bytes. 0 uses the Readable default (ADAPTIVE_HIGH_WATER_MARK when adaptive), raised to
+    // fit at least one chunk
+    uint32_t highWaterMark{0};
+    // double chunk size while push() returns true, up to half the highWaterMark, halve it when push() returns false
+    bool adaptive{false};
+    // generate PARALLEL_BLOCK_SIZE chunks on this many threads, 0 is sequential. chunkSize and adaptive are ignored.
+    uint32_t threads{0};
+    // element type of the chunks, see NodeRandTypes.h
+    napi_typedarray_type type{napi_bigint64_array};
+    // seed the stream from Fork(streamId) instead of the next pseudo seed
+    bool hasStreamId{false};
+    uint64_t streamId{0};
+};
+
+/// \brief Parse optional type option into type. Throws a JS TypeError and returns false if unsupported.
+inline bool GetTypeOption(napi_env env, const napi_extensions::NapiOptions& opts, napi_typedarray_type& type)
+{
+    type = static_cast<napi_typedarray_type>(opts.GetUint32("type", type));
+    if (!VisitType(type, [] (auto) {})) {
+        std::stringstream ss;
+        ss << "Unsupported type. Expecting a Type enum value. type: " << type << std::endl;
+        napi_throw_type_error(env, nullptr, ss.str().c_str());
+        return false;
+    }
+    return true;
+}
+
+/// \brief Parse optional streamId option. Throws a JS TypeError and returns false if invalid.
+inline bool GetStreamIdOption(napi_env env, const napi_extensions::NapiOptions& opts, StreamOptions& options)
+{
+    napi_value streamId;
+    if (opts.GetValue("streamId", streamId)) {
+        if (!GetTypedValue(env, streamId, options.streamId)) {
+            napi_throw_type_error(env, nullptr, "streamId must be an integer in [0, 2^64), number or BigInt");
+            return false;
+        }
+        options.hasStreamId = true;
+    }
+    return true;
+}
+
+/// \brief Parse optional { chunkSize, highWaterMark, adaptive, threads, type, streamId } object. Throws a JS error and returns false if invalid.
+inline bool GetStreamOptions(napi_env env, napi_value value, StreamOptions& options)
+{
+    napi_extensions::NapiOptions opts(env, value);
+    options.chunkSize = opts.GetUint32("chunkSize", options.chunkSize);
+    options.highWaterMark = opts.GetUint32("highWaterMark", options.highWaterMark);
+    options.adaptive = opts.GetBool("adaptive", options.adaptive);
+
+    if (!GetTypeOption(env, opts, options.type)) {
+        return false;
+    }
+
+    if (options.chunkSize < 1 || options.chunkSize > MAX_CHUNK_SIZE) {
+        std::stringstream ss;
+        ss << "chunkSize must be between 1 and " << MAX_CHUNK_SIZE << ". chunkSize: " << options.chunkSize << std::endl;
+        napi_throw_range_error(env, nullptr, ss.str().c_str());
+        return false;
+    }
+
+    if (!GetStreamIdOption(env, opts, options)) {
+        return false;
+    }
+    return GetThreadsOption(env, opts, options.threads);
+}
+
+/// \class NodeRandStream
+/// \brief Pull driven Readable. _read() starts a production run on a libuv worker, the run
+///        stops once Readable.push() returns false and resumes on the next _read().
+///        destroy() cancels the stream: the running production run stops after its current chunk, queued chunks
+///        are freed without being pushed, and the tsfn is aborted so the Readable and its state can be collected.
+///        The Readable is only held while it has demand, collecting an unread or paused stream cancels it the same way.
+///        While NodeGeneratorPool is enabled new streams produce on it instead, one chunk per PoolStep.
 template<class T, class GENERATOR, class DISTRIBUTION>
 class NodeRandStream /* extends Node JS Readable */ {
 private:
 
-    /// \brief data needed during async function queue
-    struct AsyncFunctionData {
-        // rng instance
+    /// \brief data needed during tsfn function call
+    struct ThreadSafeFunctionData {
+        // signal this is the last call
+        bool final{false};
+        // numbers to write to buffer, acquired from NodeBufferPool. Ownership passes to JS.
+        T* buffer{nullptr};
+        // how many numbers are in buffer
+        uint32_t count{0};
+        // when the worker queued it, for the chunk push histogram
+        StatsClock::time_point queued;
+    };
+
+    /// \brief state shared by the Readable, production runs and tsfn
+    struct StreamState : std::enable_shared_from_this<StreamState> {
+        // seed of generator, or of the parallel sequence
+        uint64_t seed;
+        // rng instance, sequential mode
         GENERATOR generator;
         // distribution instance
         DISTRIBUTION distribution;
-        // async work item
-        napi_async_work work{nullptr};
         // threadsafe function instance
         napi_threadsafe_function tsfn{nullptr};
-        // reference to node js Readable
+        // weak reference to node js Readable, strong while held (see HoldReadable). Deleted in ThreadSafeFunctionFinalized.
         napi_ref readable_ref{nullptr};
-        // how many random numbers to generate
-        uint32_t count{0};
+
+        // guards everything below
+        std::mutex mutex;
+        // how many random numbers left to generate
+        uint32_t remaining{0};
+        // numbers per chunk
+        uint32_t chunkSize{DEFAULT_CHUNK_SIZE};
+        // resize chunks based on push() result
+        bool adaptive{false};
+        // adaptive chunks stay at or below this size
+        uint32_t maxChunkSize{MAX_CHUNK_SIZE};
+        // parallel mode thread count, 0 is sequential
+        uint32_t threads{0};
+        // next parallel block to generate
+        uint64_t block{0};
+        // Readable wants more data. Set by _read, cleared when push() returns false
+        bool demand{false};
+        // readable_ref is strong. JS thread only.
+        bool held{false};
+        // number of _read() calls, to detect a _read() made during push()
+        uint64_t reads{0};
+        // a production run is queued or executing, or a PoolStep is submitted or executing
+        bool running{false};
+        // final chunk was queued and tsfn released, or the stream was cancelled and tsfn aborted
+        bool released{false};
+        // Readable was destroyed. Read without the mutex between chunks and by the tsfn.
+        std::atomic<bool> cancelled{false};
+        // production runs are PoolSteps on NodeGeneratorPool instead of libuv async work
+        bool pooled{false};
+        // pooled mode, chunks generated while the tsfn queue was full. Queued before anything else.
+        std::deque<ThreadSafeFunctionData*> parked;
+        // pooled mode, signaled when running is cleared
+        std::condition_variable idle;
+
+        // stats of the NodeRand instance, null when compiled out
+        std::shared_ptr<NodeStats> stats;
+
+        StreamState(uint64_t s, const DISTRIBUTION& d, uint32_t count, const StreamOptions& options, std::shared_ptr<NodeStats> st)
+            : seed(s), generator(s), distribution(d), remaining(count),
+              chunkSize(options.threads > 0 ? PARALLEL_BLOCK_SIZE : options.chunkSize), adaptive(options.adaptive && options.threads == 0),
+              threads(options.threads), stats(std::move(st)) {}
     };
 
-    /// \brief data needed during tsfn function call
-    struct ThreadSafeFunctionData {
-        // signal this is the last call
-        bool final{false};
-        // numbers to write to buffer
-        std::vector<T> buffer;
-        // threadsafe function instance
-        napi_threadsafe_function tsfn{nullptr};
-        // reference to node js Readable
-        napi_ref readable_ref{nullptr};
+    /// \brief data needed during async function queue, one per production run
+    struct AsyncFunctionData {
+        // shared stream state
+        std::shared_ptr<StreamState> state;
+        // async work item
+        napi_async_work work{nullptr};
     };
-    
+
     static void ExecuteThreadSafeFunction(napi_env env, napi_value js_cb, void* context, void* data);
     static void ThreadSafeFunctionFinalized(napi_env env, void* finalize_data, void* finalize_hint);
     static void ExecuteAsyncFunction(napi_env env, void* data);
     static void CompleteAsyncFunction(napi_env env, napi_status status, void* data);
 
-    /// \brief Required to implement _read for Node JS Readable. No-op
-    static napi_value _read(napi_env env, napi_callback_info info) { return nullptr; }
+    /// \brief Parallel mode production run. Generates up to threads blocks at once, queues them in order. The threads
+    ///        are a ParallelTeam started once per run and reused by every round.
+    static void ExecuteParallel(StreamState& state);
+
+    /// \brief Hand a chunk to the JS thread, releases the tsfn after the final chunk. Must not hold state.mutex.
+    /// \return false if the env is torn down (worker terminated, process exiting), the chunk is freed and the run must stop
+    static bool QueueChunk(StreamState& state, T* buffer, uint32_t count, bool final);
+
+    /// \brief napi_finalize for the std::shared_ptr<StreamState> wrapped in the Readable. The Readable was collected
+    ///        without being read to the end or destroyed, cancel the stream like _destroy.
+    static void StateFinalized(napi_env env, void* finalize_data, void* finalize_hint);
+
+    /// \brief Hold the Readable strongly while it has demand, like the pending I/O of a core stream: a flowing stream
+    ///        referenced only by its listeners must not be collected mid run. Idle streams are held weakly so unread
+    ///        and paused streams can be collected, see StateFinalized. JS thread, must hold state.mutex.
+    static void HoldReadable(napi_env env, StreamState& state, bool hold);
+
+    /// \brief Flag demand and queue a production run if none is active. Must hold state->mutex.
+    static void Demand(napi_env env, const std::shared_ptr<StreamState>& state);
+
+    /// \brief Implements Readable._read(size). Asks the worker for more data.
+    static napi_value _read(napi_env env, napi_callback_info info);
+
+    /// \brief Implements Readable._destroy(err, callback). Cancels production, see Cancelled.
+    static napi_value _destroy(napi_env env, napi_callback_info info);
+
+    /// \brief Abort the tsfn of a cancelled stream unless it was released, and end the production run. Must hold state.mutex.
+    /// \note Called by the production run, or by _destroy while none is running, so the tsfn is never used after the abort
+    static void Cancelled(StreamState& state);
+
+    /// \brief Submit a PoolStep to NodeGeneratorPool. Must hold state.mutex.
+    static void Schedule(StreamState& state);
+
+    /// \brief Pooled mode production run: flush parked chunks, then generate and queue one chunk, or one block per
+    ///        thread in parallel mode. Never blocks, chunks the full tsfn queue does not take are parked.
+    /// \return true to run again. false ends the run, ExecuteThreadSafeFunction or Demand schedule the next one.
+    static bool PoolStep(StreamState& state);
+
+    /// \brief Queue a chunk without blocking, releases the tsfn after the final chunk. Must hold state.mutex.
+    /// \return false if the tsfn queue is full and tsfn_data is still owned by the caller
+    static bool TryQueue(StreamState& state, ThreadSafeFunctionData* tsfn_data);
+
+    /// \brief napi_add_env_cleanup_hook of pooled streams. Env teardown closes the tsfn, pool threads do not stop
+    ///        with the env like libuv async work, so cancel the stream and wait for the running step.
+    static void EnvCleanup(void* arg);
 
 public:
     NodeRandStream() = delete;
 
     /// \brief Instantiate class either using new or function() syntax
+    /// \param seed seeds GENERATOR, or the parallel sequence if options.threads is set
+    /// \param stats counters of the NodeRand instance, see NodeStats.h
     /// \return this
-    static napi_value NewInstance(napi_env env, napi_ref readableCtorRef, GENERATOR& g, DISTRIBUTION& d, uint32_t count);
+    static napi_value NewInstance(napi_env env, napi_ref readableCtorRef, uint64_t seed, DISTRIBUTION& d, uint32_t count,
+        const StreamOptions& options = StreamOptions(), std::shared_ptr<NodeStats> stats = nullptr);
 };
 
-/// \brief 16kb is max buffer size for Node JS Readable stream. 16kb -> 2000 bytes to represent int64_t
-static const uint32_t MAX_BUFFER_SIZE = 2000;
+template<class T, class GENERATOR, class DISTRIBUTION>
+void NodeRandStream<T, GENERATOR, DISTRIBUTION>::StateFinalized(napi_env env, void* finalize_data, void* finalize_hint)
+{
+    std::shared_ptr<StreamState>* state = reinterpret_cast<std::shared_ptr<StreamState>*>(finalize_data);
+    {
+        std::lock_guard<std::mutex> lock((*state)->mutex);
+        (*state)->cancelled = true;
+        (*state)->demand = false;
+        (*state)->remaining = 0;
+        // a running production run aborts the tsfn after its current chunk, the tsfn keeps the state alive until then
+        if (!(*state)->running) {
+            Cancelled(**state);
+        }
+    }
+    delete state;
+}
+
+template<class T, class GENERATOR, class DISTRIBUTION>
+void NodeRandStream<T, GENERATOR, DISTRIBUTION>::HoldReadable(napi_env env, StreamState& state, bool hold)
+{
+    if (state.held == hold || state.readable_ref == nullptr) {
+        return;
+    }
+    state.held = hold;
+    if (hold) {
+        napi_reference_ref(env, state.readable_ref, nullptr);
+    }
+    else {
+        napi_reference_unref(env, state.readable_ref, nullptr);
+    }
+}
 
 template<class T, class GENERATOR, class DISTRIBUTION>
 void NodeRandStream<T, GENERATOR, DISTRIBUTION>::ThreadSafeFunctionFinalized(napi_env env, void* finalize_data, void* finalize_hint)
 {
-    std::cout << "ThreadSafeFunctionFinalized" << std::endl;
+    NODE_RAND_LOG("ThreadSafeFunctionFinalized");
+    std::shared_ptr<StreamState>* state = reinterpret_cast<std::shared_ptr<StreamState>*>(finalize_data);
+
+    if ((*state)->pooled) {
+        napi_remove_env_cleanup_hook(env, EnvCleanup, state->get());
+    }
+
+    // Every queued call has run, safe to let go of the Readable
+    napi_delete_reference(env, (*state)->readable_ref);
+    (*state)->readable_ref = nullptr;
+    {
+        // env teardown finalizes the tsfn before the Readable, StateFinalized must not abort it then
+        std::lock_guard<std::mutex> lock((*state)->mutex);
+        (*state)->released = true;
+        (*state)->tsfn = nullptr;
+    }
+
+    delete state;
 }
 
 template<class T, class GENERATOR, class DISTRIBUTION>
 void NodeRandStream<T, GENERATOR, DISTRIBUTION>::ExecuteThreadSafeFunction(napi_env env, napi_value js_cb, void* context, void* data)
 {
-    std::cout << "ExecuteThreadSafeFunction" << std::endl;
-    (void)context; // not used
+    NODE_RAND_LOG("ExecuteThreadSafeFunction");
     ThreadSafeFunctionData* tsfn_data = (ThreadSafeFunctionData*)data;
+    const size_t buff_size_in_bytes = tsfn_data->count * sizeof(T);
 
-    napi_value readable_instance;
-    napi_status status = napi_get_reference_value(env, tsfn_data->readable_ref, &readable_instance);
-    assert(status == napi_ok);
+    // kept alive by the tsfn finalize_data
+    StreamState* state = (StreamState*)context;
+    NODE_RAND_STAT(state->stats, ChunkDequeued());
+
+    // env is null when tsfn is torn down with calls still queued, the Readable is gone when cancelled. Only free the chunk.
+    if (env == nullptr || state->cancelled.load()) {
+        NodeBufferPool::Instance().Release(tsfn_data->buffer, buff_size_in_bytes);
+        delete tsfn_data;
+        return;
+    }
 
-    // Create new arraybuffer int64_t
-    const size_t buff_size_in_bytes = tsfn_data->buffer.size()*8; // (for int64_t random numbers)
-    int64_t* buff = nullptr;
+    napi_value readable_instance = nullptr;
+    napi_status status = napi_get_reference_value(env, state->readable_ref, &readable_instance);
+    if (status != napi_ok || readable_instance == nullptr) {
+        // Readable was collected while idle, StateFinalized cancels the stream
+        NodeBufferPool::Instance().Release(tsfn_data->buffer, buff_size_in_bytes);
+        delete tsfn_data;
+        return;
+    }
 
+    // Hand buffer to JS without copying. Memory goes back to the pool once the ArrayBuffer is collected.
     napi_value res;
-    status = napi_create_arraybuffer(env, buff_size_in_bytes, (void**)&buff, &res);
-    assert(status == napi_ok);
+    status = napi_create_external_arraybuffer(env, tsfn_data->buffer, buff_size_in_bytes,
+        NodeBufferPool::Finalize, reinterpret_cast<void*>(buff_size_in_bytes), &res);
+    if (status != napi_ok) {
+        // Runtime does not allow external buffers, fall back to a copy
+        void* copy = nullptr;
+        status = napi_create_arraybuffer(env, buff_size_in_bytes, &copy, &res);
+        if (status == napi_ok) {
+            std::memcpy(copy, tsfn_data->buffer, buff_size_in_bytes);
+        }
+        NodeBufferPool::Instance().Release(tsfn_data->buffer, buff_size_in_bytes);
+    }
+    tsfn_data->buffer = nullptr;
 
-    for (size_t i = 0; i < tsfn_data->buffer.size(); i++) {
-        buff[i] = tsfn_data->buffer.at(i);
+    // Readable.push expects Buffer | Uint8Array | string
+    napi_value res2;
+    if (status == napi_ok) {
+        status = napi_create_typedarray(env, napi_typedarray_type::napi_uint8_array, buff_size_in_bytes, res, 0, &res2);
     }
 
-    // TODO: Can this work?
-    //status = napi_create_buffer_copy(env, int8_buff_size, (void*)(tsfn_data->buffer), 
+    uint64_t reads = 0;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        reads = state->reads;
+    }
 
-    // TODO: This will not work. Readable.push expects Buffer | Uint8Array | string. Might need to create a buffer instead or only support unsigned
-    napi_value res2;
-    status = napi_create_typedarray(env, napi_typedarray_type::napi_uint8_array, buff_size_in_bytes, res, 0, &res2);
-    assert(status == napi_ok);
+    napi_value push_result;
+    if (status == napi_ok) {
+        status = napi_call_function(env, readable_instance, js_cb, 1, &res2, &push_result);
+    }
+    if (status != napi_ok) {
+        // env is stopping (worker terminated) and cannot run JS anymore. Drop the chunk and stop producing:
+        // teardown waits for the running production run before it closes the tsfn.
+        NODE_RAND_LOG("tsfn env stopping");
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->demand = false;
+        state->remaining = 0;
+        delete tsfn_data;
+        return;
+    }
+
+    NODE_RAND_STAT(state->stats, ChunkPushed(ElapsedNs(tsfn_data->queued)));
 
-    status = napi_call_function(env, readable_instance, js_cb, 1, &res2, nullptr);
+    bool more = false;
+    status = napi_get_value_bool(env, push_result, &more);
     assert(status == napi_ok);
 
     if (tsfn_data->final) {
-        std::cout << "tsfn final" << std::endl;
+        NODE_RAND_LOG("tsfn final");
         napi_value null_value;
         status = napi_get_null(env, &null_value);
         assert(status == napi_ok);
 
         status = napi_call_function(env, readable_instance, js_cb, 1, &null_value, nullptr);
         assert(status == napi_ok);
-
-        napi_reference_unref(env, tsfn_data->readable_ref, nullptr);
-        tsfn_data->readable_ref = nullptr;
-        tsfn_data->buffer.clear();
-
-        // Final call
-        assert(napi_release_threadsafe_function(tsfn_data->tsfn,
-                                          napi_tsfn_abort) == napi_ok);
-        tsfn_data->tsfn = nullptr;
+    }
+    else {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!more && state->reads == reads) {
+            // Readable buffer is above highWaterMark, stop producing until next _read()
+            state->demand = false;
+            HoldReadable(env, *state, false);
+            NODE_RAND_STAT(state->stats, Backpressure());
+            if (state->pooled) {
+                // no async work to unref it once the run ends, idle streams must not keep the event loop alive
+                napi_unref_threadsafe_function(env, state->tsfn);
+            }
+        }
+        if (state->adaptive) {
+            // Grow while the consumer keeps up, shrink under backpressure
+            state->chunkSize = more ? std::min(state->chunkSize * 2, state->maxChunkSize) : std::max(state->chunkSize / 2, MIN_CHUNK_SIZE);
+        }
+        if (state->pooled && !state->running && !state->parked.empty()) {
+            // this chunk freed a slot of the tsfn queue
+            Schedule(*state);
+        }
     }
 
     delete tsfn_data;
@@ -132,115 +427,567 @@ void NodeRandStream<T, GENERATOR, DISTRIBUTION>::ExecuteThreadSafeFunction(napi_
 template<class T, class GENERATOR, class DISTRIBUTION>
 void NodeRandStream<T, GENERATOR, DISTRIBUTION>::ExecuteAsyncFunction(napi_env env, void* data)
 {
-    std::cout << "ExecuteAsyncFunction" << std::endl;
+    NODE_RAND_LOG("ExecuteAsyncFunction");
     AsyncFunctionData* async_data = (AsyncFunctionData*)data;
+    StreamState& state = *async_data->state;
 
-    GENERATOR& generator = async_data->generator;
-    DISTRIBUTION& distribution = async_data->distribution;
+    if (state.threads > 0) {
+        ExecuteParallel(state);
+        return;
+    }
 
-    assert(napi_acquire_threadsafe_function(async_data->tsfn) == napi_ok);
+    GENERATOR& generator = state.generator;
+    DISTRIBUTION& distribution = state.distribution;
+
+    while (true) {
+        uint32_t count = 0;
+        bool final = false;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.cancelled.load()) {
+                Cancelled(state);
+                return;
+            }
+            if (!state.demand || state.remaining == 0) {
+                // Consumer is full, next _read() queues a new run
+                state.running = false;
+                return;
+            }
+            count = std::min(state.remaining, state.chunkSize);
+            state.remaining -= count;
+            final = state.remaining == 0;
+        }
 
-    uint32_t remaining = async_data->count;
-    do {
-        uint32_t count = std::min(remaining, MAX_BUFFER_SIZE);
-        remaining -= count;
+        T* buffer = static_cast<T*>(NodeBufferPool::Instance().Acquire(count * sizeof(T)));
+        const StatsClock::time_point start = StatsNow();
+        distribution.Fill(generator, buffer, count);
+        NODE_RAND_STAT(state.stats, ChunkGenerated(count, ElapsedNs(start)));
 
-        if (count > 0) {
+        if (!QueueChunk(state, buffer, count, final) || final) {
+            return;
+        }
+    }
+}
 
-            ThreadSafeFunctionData* tsfn_data = new ThreadSafeFunctionData();
-            tsfn_data->readable_ref = async_data->readable_ref;
-            tsfn_data->tsfn = async_data->tsfn;
-            tsfn_data->final = remaining < 1;
-            tsfn_data->buffer.resize(count);
+template<class T, class GENERATOR, class DISTRIBUTION>
+void NodeRandStream<T, GENERATOR, DISTRIBUTION>::ExecuteParallel(StreamState& state)
+{
+    std::vector<T*> buffers;
+    std::vector<uint32_t> counts;
+    ParallelTeam team(state.threads);
+
+    while (true) {
+        uint64_t first = 0;
+        uint32_t remaining = 0;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.cancelled.load()) {
+                Cancelled(state);
+                return;
+            }
+            if (!state.demand || state.remaining == 0) {
+                state.running = false;
+                return;
+            }
+            // one block per thread, the last block may be short
+            const uint64_t blocks = std::min<uint64_t>(state.threads, (state.remaining + PARALLEL_BLOCK_SIZE - 1) / PARALLEL_BLOCK_SIZE);
+            const uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(state.remaining, blocks * PARALLEL_BLOCK_SIZE));
+            first = state.block;
+            state.block += blocks;
+            state.remaining -= count;
+            remaining = state.remaining;
+
+            counts.clear();
+            for (uint32_t left = count; left > 0; left -= counts.back()) {
+                counts.push_back(std::min(left, PARALLEL_BLOCK_SIZE));
+            }
+        }
 
-            auto next = [&distribution, &generator] () -> T { return distribution(generator); };
-            std::generate(tsfn_data->buffer.begin(), tsfn_data->buffer.end(), next);
+        buffers.resize(counts.size());
+        for (size_t b = 0; b < counts.size(); b++) {
+            buffers[b] = static_cast<T*>(NodeBufferPool::Instance().Acquire(counts[b] * sizeof(T)));
+        }
 
-            assert(napi_call_threadsafe_function(async_data->tsfn,
-                                                (void*)tsfn_data,
-                                                napi_tsfn_blocking) == napi_ok);
+        const uint64_t seed = state.seed;
+        const DISTRIBUTION& distribution = state.distribution;
+        NodeStats* stats = state.stats.get();
+        team.For(counts.size(), [seed, first, stats, &distribution, &buffers, &counts] (size_t b) {
+            const StatsClock::time_point start = StatsNow();
+            GenerateBlock<T, GENERATOR>(seed, first + b, distribution, buffers[b], counts[b]);
+            NODE_RAND_STAT(stats, ChunkGenerated(counts[b], ElapsedNs(start)));
+        });
+
+        // Reassemble in block order, drop the rest once cancelled
+        for (size_t b = 0; b < counts.size(); b++) {
+            const bool final = remaining == 0 && b + 1 == counts.size();
+            // loaded once, a failed QueueChunk already released buffers[b]
+            const bool cancelled = state.cancelled.load();
+            if (cancelled || !QueueChunk(state, buffers[b], counts[b], final)) {
+                const size_t first = cancelled ? b : b + 1;
+                for (size_t rest = first; rest < counts.size(); rest++) {
+                    NodeBufferPool::Instance().Release(buffers[rest], counts[rest] * sizeof(T));
+                }
+                bool released = false;
+                {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    released = state.released;
+                }
+                if (released) {
+                    return;
+                }
+                // cancelled, the next iteration aborts the tsfn
+                break;
+            }
+            if (final) {
+                return;
+            }
         }
+    }
+}
 
-    } while(remaining > 0);
+template<class T, class GENERATOR, class DISTRIBUTION>
+bool NodeRandStream<T, GENERATOR, DISTRIBUTION>::QueueChunk(StreamState& state, T* buffer, uint32_t count, bool final)
+{
+    ThreadSafeFunctionData* tsfn_data = new ThreadSafeFunctionData();
+    tsfn_data->final = final;
+    tsfn_data->count = count;
+    tsfn_data->buffer = buffer;
+    tsfn_data->queued = StatsNow();
+    NODE_RAND_STAT(state.stats, ChunkQueued());
+
+    // Blocks while MAX_QUEUED_CHUNKS are waiting on the JS thread. With stats, try without blocking first to count the stall.
+    napi_status status = napi_queue_full;
+    if (STATS_ENABLED && state.stats) {
+        status = napi_call_threadsafe_function(state.tsfn, (void*)tsfn_data, napi_tsfn_nonblocking);
+        if (status == napi_queue_full) {
+            NODE_RAND_STAT(state.stats, QueueFull());
+        }
+    }
+    if (status == napi_queue_full) {
+        status = napi_call_threadsafe_function(state.tsfn, (void*)tsfn_data, napi_tsfn_blocking);
+    }
+    if (status == napi_closing) {
+        // env teardown aborted the tsfn, it must not be called or released again
+        NODE_RAND_LOG("tsfn closing");
+        NODE_RAND_STAT(state.stats, ChunkDequeued());
+        NodeBufferPool::Instance().Release(buffer, count * sizeof(T));
+        delete tsfn_data;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.released = true;
+        state.running = false;
+        return false;
+    }
+    assert(status == napi_ok);
 
-    std::cout << "release tsfn" << std::endl;
-    assert(napi_release_threadsafe_function(async_data->tsfn,
-                                            napi_tsfn_release) == napi_ok);
+    if (final) {
+        // Last thread using tsfn, it finalizes once all queued calls have run
+        NODE_RAND_LOG("release tsfn");
+        std::lock_guard<std::mutex> lock(state.mutex);
+        status = napi_release_threadsafe_function(state.tsfn, napi_tsfn_release);
+        assert(status == napi_ok);
+        state.released = true;
+        state.running = false;
+    }
+    return true;
 }
 
 template<class T, class GENERATOR, class DISTRIBUTION>
 void NodeRandStream<T, GENERATOR, DISTRIBUTION>::CompleteAsyncFunction(napi_env env, napi_status status, void* data)
 {
     AsyncFunctionData* async_data = (AsyncFunctionData*)data;
-    std::cout << "CompleteAsyncFunction" << std::endl;
+    NODE_RAND_LOG("CompleteAsyncFunction");
 
     napi_delete_async_work(env, async_data->work);
     async_data->work = nullptr;
 
-    napi_reference_unref(env, async_data->readable_ref, nullptr);
-    async_data->readable_ref = nullptr;
+    {
+        // Idle streams must not keep the event loop alive
+        StreamState& state = *async_data->state;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.running && !state.released) {
+            napi_unref_threadsafe_function(env, state.tsfn);
+        }
+    }
 
     delete async_data;
     async_data=nullptr;
 }
 
 template<class T, class GENERATOR, class DISTRIBUTION>
-napi_value NodeRandStream<T, GENERATOR, DISTRIBUTION>::NewInstance(napi_env env, napi_ref readableCtorRef, GENERATOR& g, DISTRIBUTION& d, uint32_t count) {
+void NodeRandStream<T, GENERATOR, DISTRIBUTION>::Demand(napi_env env, const std::shared_ptr<StreamState>& state)
+{
+    state->demand = true;
+    state->reads++;
+    if (!state->cancelled.load()) {
+        HoldReadable(env, *state, true);
+    }
+    if (state->pooled && !state->released) {
+        // pool threads do not keep the event loop alive, the tsfn does while there is demand
+        napi_ref_threadsafe_function(env, state->tsfn);
+    }
+    if (state->running || state->released || state->remaining == 0) {
+        return;
+    }
+    state->running = true;
+
+    if (state->pooled) {
+        Schedule(*state);
+        return;
+    }
+
+    napi_status status = napi_ref_threadsafe_function(env, state->tsfn);
+    assert(status == napi_ok);
+
+    AsyncFunctionData* async_data = new AsyncFunctionData();
+    async_data->state = state;
+
+    napi_value async_name;
+    status = napi_create_string_utf8(env, "generate_async", NAPI_AUTO_LENGTH, &async_name);
+    assert(status == napi_ok);
+
+    // Create async function
+    status = napi_create_async_work(env, nullptr, async_name, ExecuteAsyncFunction, CompleteAsyncFunction, async_data, &(async_data->work));
+    assert(status == napi_ok);
+
+    // Queue async function
+    status = napi_queue_async_work(env, async_data->work);
+    assert(status == napi_ok);
+}
+
+template<class T, class GENERATOR, class DISTRIBUTION>
+napi_value NodeRandStream<T, GENERATOR, DISTRIBUTION>::_read(napi_env env, napi_callback_info info)
+{
+    std::shared_ptr<StreamState>* state = napi_extensions::GetSelf<std::shared_ptr<StreamState>>(env, info);
+    if (state == nullptr) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock((*state)->mutex);
+    Demand(env, *state);
+    return nullptr;
+}
+
+template<class T, class GENERATOR, class DISTRIBUTION>
+void NodeRandStream<T, GENERATOR, DISTRIBUTION>::Cancelled(StreamState& state)
+{
+    for (ThreadSafeFunctionData* tsfn_data : state.parked) {
+        NODE_RAND_STAT(state.stats, ChunkDequeued());
+        NodeBufferPool::Instance().Release(tsfn_data->buffer, tsfn_data->count * sizeof(T));
+        delete tsfn_data;
+    }
+    state.parked.clear();
+
+    if (!state.released) {
+        // Queued chunks are freed by ExecuteThreadSafeFunction, then the tsfn finalizes and lets go of the Readable
+        NODE_RAND_LOG("abort tsfn");
+        napi_status status = napi_release_threadsafe_function(state.tsfn, napi_tsfn_abort);
+        assert(status == napi_ok);
+        state.released = true;
+    }
+    state.running = false;
+}
+
+template<class T, class GENERATOR, class DISTRIBUTION>
+void NodeRandStream<T, GENERATOR, DISTRIBUTION>::Schedule(StreamState& state)
+{
+    state.running = true;
+    std::shared_ptr<StreamState> self = state.shared_from_this();
+    NodeGeneratorPool::Instance().Submit([self] () {
+        if (PoolStep(*self)) {
+            return true;
+        }
+        self->idle.notify_all();
+        return false;
+    });
+}
+
+template<class T, class GENERATOR, class DISTRIBUTION>
+bool NodeRandStream<T, GENERATOR, DISTRIBUTION>::TryQueue(StreamState& state, ThreadSafeFunctionData* tsfn_data)
+{
+    napi_status status = napi_closing;
+    if (!state.released) {
+        status = napi_call_threadsafe_function(state.tsfn, (void*)tsfn_data, napi_tsfn_nonblocking);
+    }
+    if (status == napi_queue_full) {
+        return false;
+    }
+    if (status != napi_ok) {
+        // env teardown closed the tsfn, it must not be called or released again
+        NODE_RAND_STAT(state.stats, ChunkDequeued());
+        NodeBufferPool::Instance().Release(tsfn_data->buffer, tsfn_data->count * sizeof(T));
+        delete tsfn_data;
+        state.released = true;
+        return true;
+    }
+    if (tsfn_data->final) {
+        NODE_RAND_LOG("release tsfn");
+        status = napi_release_threadsafe_function(state.tsfn, napi_tsfn_release);
+        assert(status == napi_ok);
+        state.released = true;
+    }
+    return true;
+}
 
-    std::cout << "NodeRandStream::NewInstance()" << std::endl;
+template<class T, class GENERATOR, class DISTRIBUTION>
+bool NodeRandStream<T, GENERATOR, DISTRIBUTION>::PoolStep(StreamState& state)
+{
+    std::vector<uint32_t> counts;
+    uint64_t first = 0;
+    bool final = false;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.cancelled.load()) {
+            Cancelled(state);
+            return false;
+        }
+        while (!state.parked.empty()) {
+            if (!TryQueue(state, state.parked.front())) {
+                // ExecuteThreadSafeFunction schedules the next step once the JS thread took a chunk
+                state.running = false;
+                return false;
+            }
+            state.parked.pop_front();
+        }
+        if (state.released || !state.demand || state.remaining == 0) {
+            state.running = false;
+            return false;
+        }
 
-    // Start async work
-    napi_value readableCtor;
+        uint32_t count = std::min(state.remaining, state.chunkSize);
+        if (state.threads > 0) {
+            // one block per thread, the last block may be short
+            const uint64_t blocks = std::min<uint64_t>(state.threads, (state.remaining + PARALLEL_BLOCK_SIZE - 1) / PARALLEL_BLOCK_SIZE);
+            count = static_cast<uint32_t>(std::min<uint64_t>(state.remaining, blocks * PARALLEL_BLOCK_SIZE));
+            first = state.block;
+            state.block += blocks;
+        }
+        for (uint32_t left = count; left > 0; left -= counts.back()) {
+            counts.push_back(std::min(left, state.threads > 0 ? PARALLEL_BLOCK_SIZE : count));
+        }
+        state.remaining -= count;
+        final = state.remaining == 0;
+    }
+
+    std::vector<T*> buffers(counts.size());
+    for (size_t b = 0; b < counts.size(); b++) {
+        buffers[b] = static_cast<T*>(NodeBufferPool::Instance().Acquire(counts[b] * sizeof(T)));
+    }
+
+    NodeStats* stats = state.stats.get();
+    if (state.threads > 0) {
+        const uint64_t seed = state.seed;
+        const DISTRIBUTION& distribution = state.distribution;
+        // blocks as pool tasks, pooled streams never start threads of their own
+        NodeGeneratorPool::Instance().ParallelFor(state.threads, counts.size(), [seed, first, stats, &distribution, &buffers, &counts] (size_t b) {
+            const StatsClock::time_point start = StatsNow();
+            GenerateBlock<T, GENERATOR>(seed, first + b, distribution, buffers[b], counts[b]);
+            NODE_RAND_STAT(stats, ChunkGenerated(counts[b], ElapsedNs(start)));
+        });
+    }
+    else {
+        const StatsClock::time_point start = StatsNow();
+        state.distribution.Fill(state.generator, buffers[0], counts[0]);
+        NODE_RAND_STAT(stats, ChunkGenerated(counts[0], ElapsedNs(start)));
+    }
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.cancelled.load()) {
+        for (size_t b = 0; b < counts.size(); b++) {
+            NodeBufferPool::Instance().Release(buffers[b], counts[b] * sizeof(T));
+        }
+        Cancelled(state);
+        return false;
+    }
+
+    // in block order, behind any chunk already parked
+    for (size_t b = 0; b < counts.size(); b++) {
+        ThreadSafeFunctionData* tsfn_data = new ThreadSafeFunctionData();
+        tsfn_data->final = final && b + 1 == counts.size();
+        tsfn_data->count = counts[b];
+        tsfn_data->buffer = buffers[b];
+        tsfn_data->queued = StatsNow();
+        NODE_RAND_STAT(state.stats, ChunkQueued());
+        if (!state.parked.empty() || !TryQueue(state, tsfn_data)) {
+            if (state.parked.empty()) {
+                NODE_RAND_STAT(state.stats, QueueFull());
+            }
+            state.parked.push_back(tsfn_data);
+        }
+    }
+    if (!state.parked.empty() || state.released) {
+        state.running = false;
+        return false;
+    }
+    return true;
+}
+
+template<class T, class GENERATOR, class DISTRIBUTION>
+void NodeRandStream<T, GENERATOR, DISTRIBUTION>::EnvCleanup(void* arg)
+{
+    StreamState& state = *static_cast<StreamState*>(arg);
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cancelled = true;
+    state.demand = false;
+    state.remaining = 0;
+    // a submitted step finds the stream cancelled and aborts the tsfn itself
+    state.idle.wait(lock, [&state] { return !state.running; });
+    Cancelled(state);
+}
+
+template<class T, class GENERATOR, class DISTRIBUTION>
+napi_value NodeRandStream<T, GENERATOR, DISTRIBUTION>::_destroy(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value argv[2];
+    napi_value jsthis;
+    napi_status status = napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr);
+    if (status != napi_ok) {
+        return nullptr;
+    }
+
+    std::shared_ptr<StreamState>* state = nullptr;
+    status = napi_unwrap(env, jsthis, reinterpret_cast<void**>(&state));
+    if (status == napi_ok && state != nullptr) {
+        std::lock_guard<std::mutex> lock((*state)->mutex);
+        (*state)->cancelled = true;
+        (*state)->demand = false;
+        (*state)->remaining = 0;
+        HoldReadable(env, **state, false);
+        // a running production run aborts the tsfn after its current chunk, it may still be using it
+        if (!(*state)->running) {
+            Cancelled(**state);
+        }
+    }
+
+    // callback(err) finishes destroy()
+    if (argc == 2) {
+        napi_value undefined;
+        napi_get_undefined(env, &undefined);
+        napi_call_function(env, undefined, argv[1], 1, &argv[0], nullptr);
+    }
+    return nullptr;
+}
+
+template<class T, class GENERATOR, class DISTRIBUTION>
+napi_value NodeRandStream<T, GENERATOR, DISTRIBUTION>::NewInstance(napi_env env, napi_ref readableCtorRef, uint64_t seed, DISTRIBUTION& d, uint32_t count,
+    const StreamOptions& options, std::shared_ptr<NodeStats> stats) {
+
+    NODE_RAND_LOG("NodeRandStream::NewInstance()");
+
+    // napi calls below fail only when the env is stopping (worker terminated) mid call, nothing is created then
+    napi_value readableCtor = nullptr;
     napi_get_reference_value(env, readableCtorRef, &readableCtor);
 
     // create new NodeJS Readable
     napi_value readable_instance;
     napi_value readable_options;
     napi_status status = napi_create_object(env, &readable_options);
-    assert(status == napi_ok);
+    if (status != napi_ok) {
+        return nullptr;
+    }
+
+    // Readable must be able to hold at least one chunk
+    static const uint32_t READABLE_DEFAULT_HIGH_WATER_MARK = 16 * 1024;
+    const uint32_t chunkSize = options.threads > 0 ? PARALLEL_BLOCK_SIZE : options.chunkSize;
+    const uint32_t chunkBytes = static_cast<uint32_t>(std::min<size_t>(chunkSize * sizeof(T), UINT32_MAX));
+    // adaptive chunks only grow while push() returns true, the Readable must hold more than one of the larger chunks
+    const uint32_t defaultHighWaterMark = options.adaptive && options.threads == 0 ? ADAPTIVE_HIGH_WATER_MARK : READABLE_DEFAULT_HIGH_WATER_MARK;
+    const uint32_t highWaterMark = options.highWaterMark > 0 ? options.highWaterMark : std::max(defaultHighWaterMark, chunkBytes);
+    napi_value high_water_mark;
+    status = napi_create_uint32(env, highWaterMark, &high_water_mark);
+    if (status != napi_ok) {
+        return nullptr;
+    }
+    status = napi_set_named_property(env, readable_options, "highWaterMark", high_water_mark);
+    if (status != napi_ok) {
+        return nullptr;
+    }
+
     status = napi_new_instance(env, readableCtor, 1, &readable_options, &readable_instance);
-    assert(status == napi_ok);
+    if (status != napi_ok) {
+        return nullptr;
+    }
 
     // Make sure to implement _read()
     napi_value _readFn;
     status = napi_create_function(env, nullptr, 0, _read, nullptr, &_readFn);
-    assert(status == napi_ok);
+    if (status != napi_ok) {
+        return nullptr;
+    }
 
     status = napi_set_named_property(env, readable_instance, "_read", _readFn);
-    assert(status == napi_ok);
+    if (status != napi_ok) {
+        return nullptr;
+    }
 
-    AsyncFunctionData* async_data = new AsyncFunctionData({g, d});
-    async_data->count = count;
+    // destroy() stops production and frees the tsfn
+    napi_value _destroyFn;
+    status = napi_create_function(env, nullptr, 0, _destroy, nullptr, &_destroyFn);
+    if (status == napi_ok) {
+        status = napi_set_named_property(env, readable_instance, "_destroy", _destroyFn);
+    }
+    if (status != napi_ok) {
+        return nullptr;
+    }
 
-    napi_value async_name;
-    status = napi_create_string_utf8(env, "generate_async", NAPI_AUTO_LENGTH, &async_name);
-    assert(status == napi_ok);
+    std::shared_ptr<StreamState> state = std::make_shared<StreamState>(seed, d, count, options, std::move(stats));
+    state->maxChunkSize = std::max(state->chunkSize, std::min<uint32_t>(highWaterMark / sizeof(T) / 2, MAX_CHUNK_SIZE));
+
+    // Readable owns the state, _read() and _destroy() unwrap it
+    std::shared_ptr<StreamState>* owner = new std::shared_ptr<StreamState>(state);
+    status = napi_wrap(env, readable_instance, owner, StateFinalized, nullptr, nullptr);
+    if (status != napi_ok) {
+        delete owner;
+        return nullptr;
+    }
 
     napi_value tsfn_name;
+    napi_value push_func;
     status = napi_create_string_utf8(env, "generate_tsfn", NAPI_AUTO_LENGTH, &tsfn_name);
-    assert(status == napi_ok);
+    if (status == napi_ok) {
+        status = napi_get_named_property(env, readable_instance, "push", &push_func);
+    }
+    if (status == napi_ok) {
+        // weak until the first _read()
+        status = napi_create_reference(env, readable_instance, 0, &state->readable_ref);
+    }
+    if (status != napi_ok) {
+        return nullptr;
+    }
 
-    status = napi_create_reference(env, readable_instance, 1, &async_data->readable_ref);
-    assert(status == napi_ok);
-    
-    napi_value push_func;
-    status = napi_get_named_property(env, readable_instance, "push", &push_func);
-    assert(status == napi_ok);
+    // Create thread safe function. Bounded queue, production runs block once MAX_QUEUED_CHUNKS are pending.
+    std::shared_ptr<StreamState>* tsfnOwner = new std::shared_ptr<StreamState>(state);
+    status = napi_create_threadsafe_function(env, push_func, nullptr, tsfn_name, MAX_QUEUED_CHUNKS, 1,
+        tsfnOwner, ThreadSafeFunctionFinalized, state.get(), ExecuteThreadSafeFunction, &(state->tsfn));
+    if (status != napi_ok) {
+        napi_delete_reference(env, state->readable_ref);
+        delete tsfnOwner;
+        return nullptr;
+    }
 
-    // TODO: Put CallJS, executeFunc, completeFunc in NodeRandStream class
-    // Create thread safe function
-    status = napi_create_threadsafe_function(env, push_func, nullptr, tsfn_name, 0, 1, nullptr, ThreadSafeFunctionFinalized, nullptr, ExecuteThreadSafeFunction, &(async_data->tsfn));
+    // Nothing is produced until the first _read()
+    status = napi_unref_threadsafe_function(env, state->tsfn);
     assert(status == napi_ok);
 
-    // Create async function
-    status = napi_create_async_work(env, nullptr, async_name, ExecuteAsyncFunction, CompleteAsyncFunction, async_data, &(async_data->work));
-    assert(status == napi_ok);
+    if (NodeGeneratorPool::Instance().Enabled()) {
+        // registered after the tsfn, so it runs before teardown closes the tsfn. Removed in ThreadSafeFunctionFinalized.
+        state->pooled = napi_add_env_cleanup_hook(env, EnvCleanup, state.get()) == napi_ok;
+    }
 
-    // Queue async function
-    status = napi_queue_async_work(env, async_data->work);
-    assert(status == napi_ok);
+    if (count == 0) {
+        // Nothing to produce, end the stream right away
+        status = napi_release_threadsafe_function(state->tsfn, napi_tsfn_release);
+        assert(status == napi_ok);
+        state->released = true;
+
+        napi_value null_value;
+        status = napi_get_null(env, &null_value);
+        assert(status == napi_ok);
+        // fails only if the env is stopping
+        napi_call_function(env, readable_instance, push_func, 1, &null_value, nullptr);
+    }
 
     return readable_instance;
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "napi_extensions.h"
+
+#include <node_api.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+
+namespace node_rand {
+
+/**
+ * Type selector
+ *
+ * Output types are named by napi_typedarray_type, exported to JS as the Type enum. Generate(min, max, type)
+ * and the stream type option select one, GenerateInto takes it from the TypedArray it fills.
+ * Streams emit tightly packed elements of the type, eg: 1 byte per number for Type.Int8.
+ */
+
+/// \brief JS name of a supported type
+struct NodeRandTypeInfo {
+    const char* name;
+    napi_typedarray_type type;
+};
+
+/// \brief Supported types, exported as the Type enum
+static const NodeRandTypeInfo SUPPORTED_TYPES[] = {
+    { "Int8", napi_int8_array },
+    { "Uint8", napi_uint8_array },
+    { "Int16", napi_int16_array },
+    { "Uint16", napi_uint16_array },
+    { "Int32", napi_int32_array },
+    { "Uint32", napi_uint32_array },
+    { "Float32", napi_float32_array },
+    { "Float64", napi_float64_array },
+    { "BigInt64", napi_bigint64_array },
+    { "BigUint64", napi_biguint64_array }
+};
+
+/// \brief Element type T of a TypedArray type, passed to VisitType callbacks
+template<class T>
+struct TypeTag {
+    typedef T type;
+};
+
+/// \brief Call fn(TypeTag<T>()) with the element type T of type
+/// \return false if type is not supported, fn is not called
+template<class FN>
+bool VisitType(napi_typedarray_type type, FN&& fn)
+{
+    switch (type) {
+        case napi_int8_array: fn(TypeTag<int8_t>()); return true;
+        case napi_uint8_array: fn(TypeTag<uint8_t>()); return true;
+        case napi_uint8_clamped_array: fn(TypeTag<uint8_t>()); return true;
+        case napi_int16_array: fn(TypeTag<int16_t>()); return true;
+        case napi_uint16_array: fn(TypeTag<uint16_t>()); return true;
+        case napi_int32_array: fn(TypeTag<int32_t>()); return true;
+        case napi_uint32_array: fn(TypeTag<uint32_t>()); return true;
+        case napi_float32_array: fn(TypeTag<float>()); return true;
+        case napi_float64_array: fn(TypeTag<double>()); return true;
+        case napi_bigint64_array: fn(TypeTag<int64_t>()); return true;
+        case napi_biguint64_array: fn(TypeTag<uint64_t>()); return true;
+        default: return false;
+    }
+}
+
+/// \brief Call fn(TypeTag<U>()) with the unsigned integer type U as wide as the elements of type. Any TypedArray,
+///        for code that only moves elements around.
+template<class FN>
+void VisitElementWidth(napi_typedarray_type type, FN&& fn)
+{
+    switch (type) {
+        case napi_int8_array:
+        case napi_uint8_array:
+        case napi_uint8_clamped_array: fn(TypeTag<uint8_t>()); break;
+        case napi_int16_array:
+        case napi_uint16_array: fn(TypeTag<uint16_t>()); break;
+        case napi_int32_array:
+        case napi_uint32_array:
+        case napi_float32_array: fn(TypeTag<uint32_t>()); break;
+        default: fn(TypeTag<uint64_t>()); break;
+    }
+}
+
+/// \brief TypedArray type with element type T
+template<class T>
+constexpr napi_typedarray_type TypeOf()
+{
+    if constexpr (std::is_same<T, int8_t>::value) return napi_int8_array;
+    else if constexpr (std::is_same<T, uint8_t>::value) return napi_uint8_array;
+    else if constexpr (std::is_same<T, int16_t>::value) return napi_int16_array;
+    else if constexpr (std::is_same<T, uint16_t>::value) return napi_uint16_array;
+    else if constexpr (std::is_same<T, int32_t>::value) return napi_int32_array;
+    else if constexpr (std::is_same<T, uint32_t>::value) return napi_uint32_array;
+    else if constexpr (std::is_same<T, float>::value) return napi_float32_array;
+    else if constexpr (std::is_same<T, double>::value) return napi_float64_array;
+    else if constexpr (std::is_same<T, int64_t>::value) return napi_bigint64_array;
+    else {
+        static_assert(std::is_same<T, uint64_t>::value, "Unsupported type");
+        return napi_biguint64_array;
+    }
+}
+
+/// \brief JS name of type, eg: "Int8"
+inline const char* TypeName(napi_typedarray_type type)
+{
+    if (type == napi_uint8_clamped_array) {
+        return "Uint8Clamped";
+    }
+    for (const NodeRandTypeInfo& info : SUPPORTED_TYPES) {
+        if (info.type == type) {
+            return info.name;
+        }
+    }
+    return "Unsupported";
+}
+
+/// \brief value fits in E. Integer types only, any mix of signedness.
+template<class E, class T>
+constexpr bool InRange(T value)
+{
+    static_assert(std::is_integral<E>::value && std::is_integral<T>::value, "integer types only");
+    if constexpr (std::is_signed<T>::value && !std::is_signed<E>::value) {
+        return value >= 0 && static_cast<typename std::make_unsigned<T>::type>(value) <= std::numeric_limits<E>::max();
+    }
+    else if constexpr (!std::is_signed<T>::value && std::is_signed<E>::value) {
+        return value <= static_cast<typename std::make_unsigned<E>::type>(std::numeric_limits<E>::max());
+    }
+    else {
+        return value >= std::numeric_limits<E>::min() && value <= std::numeric_limits<E>::max();
+    }
+}
+
+/// \brief Read a number or BigInt as T. Numbers are truncated like napi_get_value_int64, BigInts must be exact.
+/// \return false if value is out of T's range, or a BigInt, NaN or infinity for a floating point T
+template<class T>
+bool GetTypedValue(napi_env env, napi_value value, T& out)
+{
+    napi_valuetype type;
+    napi_extensions::CheckStatus(napi_typeof(env, value, &type), env, "Failed to get napi typeof");
+
+    if constexpr (std::is_floating_point<T>::value) {
+        double d = 0;
+        if (type != napi_number) {
+            return false;
+        }
+        napi_extensions::CheckStatus(napi_get_value_double(env, value, &d), env, "Failed to get double value");
+        if (!std::isfinite(d) || std::fabs(d) > std::numeric_limits<T>::max()) {
+            return false;
+        }
+        out = static_cast<T>(d);
+        return true;
+    }
+    else {
+        if (type == napi_bigint) {
+            bool lossless = false;
+            if constexpr (std::is_signed<T>::value) {
+                int64_t v = 0;
+                napi_extensions::CheckStatus(napi_get_value_bigint_int64(env, value, &v, &lossless), env, "Failed to get bigint int64 value");
+                if (!lossless || !InRange<T>(v)) {
+                    return false;
+                }
+                out = static_cast<T>(v);
+            }
+            else {
+                uint64_t v = 0;
+                napi_extensions::CheckStatus(napi_get_value_bigint_uint64(env, value, &v, &lossless), env, "Failed to get bigint uint64 value");
+                if (!lossless || !InRange<T>(v)) {
+                    return false;
+                }
+                out = static_cast<T>(v);
+            }
+            return true;
+        }
+        if (type != napi_number) {
+            return false;
+        }
+        if constexpr (std::is_same<T, uint64_t>::value) {
+            // above int64 range, int64 would saturate
+            double d = 0;
+            napi_extensions::CheckStatus(napi_get_value_double(env, value, &d), env, "Failed to get double value");
+            if (!(d > -1.0 && d < 18446744073709551616.0)) {
+                return false;
+            }
+            out = static_cast<uint64_t>(d);
+            return true;
+        }
+        else {
+            int64_t v = 0;
+            napi_extensions::CheckStatus(napi_get_value_int64(env, value, &v), env, "Failed to get int64 value");
+            if (!InRange<T>(v)) {
+                return false;
+            }
+            out = static_cast<T>(v);
+            return true;
+        }
+    }
+}
+
+/// \brief Parse min/max of a type T range. Throws a JS TypeError and returns false if either is not a T or max < min.
+template<class T>
+bool GetTypedRange(napi_env env, napi_value minValue, napi_value maxValue, napi_typedarray_type type, T& min, T& max)
+{
+    std::stringstream ss;
+    if (!GetTypedValue(env, minValue, min) || !GetTypedValue(env, maxValue, max)) {
+        ss << "Min/Max out of " << TypeName(type) << " range" << std::endl;
+    }
+    else if (max < min) {
+        // unary + prints 8 bit types as numbers
+        ss << "Max < Min. Min: " << +min << ", Max: " << +max << std::endl;
+    }
+
+    if (!ss.str().empty()) {
+        napi_throw_type_error(env, nullptr, ss.str().c_str());
+        return false;
+    }
+    return true;
+}
+
+/// \brief JS value of a T. Number, or BigInt for 64 bit integers.
+template<class T>
+napi_value CreateTypedValue(napi_env env, T value)
+{
+    napi_value result;
+    if constexpr (std::is_floating_point<T>::value) {
+        napi_extensions::CheckStatus(napi_create_double(env, value, &result), env, "Failed to create double");
+    }
+    else if constexpr (std::is_same<T, int64_t>::value) {
+        napi_extensions::CheckStatus(napi_create_bigint_int64(env, value, &result), env, "Failed to create bigint int64");
+    }
+    else if constexpr (std::is_same<T, uint64_t>::value) {
+        napi_extensions::CheckStatus(napi_create_bigint_uint64(env, value, &result), env, "Failed to create bigint uint64");
+    }
+    else if constexpr (std::is_signed<T>::value) {
+        napi_extensions::CheckStatus(napi_create_int32(env, value, &result), env, "Failed to create int32");
+    }
+    else {
+        napi_extensions::CheckStatus(napi_create_uint32(env, value, &result), env, "Failed to create uint32");
+    }
+    return result;
+}
+
+}
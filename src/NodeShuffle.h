@@ -0,0 +1,229 @@
+#pragma once
+
+#include "NodeRNG.h"
+#include "NodeParallel.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace node_rand {
+
+/**
+ * Shuffles and samples without replacement
+ *
+ * Shuffle is Fisher-Yates: for i = n down to 2, element i - 1 is swapped with BoundedIndex(i).
+ * Indices of a block of swaps are drawn first and their elements prefetched, so arrays larger than the cache
+ * overlap their misses instead of stalling on every swap. Same swaps, same result as the plain loop.
+ *
+ * ParallelShuffle (threads option) is a scatter shuffle (Rao-Sandelius): every element is sent to one of
+ * ceil(n / SHUFFLE_BUCKET_SIZE) buckets uniformly at random, each bucket is Fisher-Yates shuffled in cache,
+ * and buckets are concatenated. Labels of chunk c come from BlockSeed(seed, c), bucket b is shuffled by
+ * BlockSeed(seed, chunks + b), so the result depends on the seed and n only, not on the thread count.
+ * This is a different permutation than the sequential (threads not set) one.
+ *
+ * SampleWithoutReplacement returns the first k elements of a partial Fisher-Yates shuffle of 0..n-1, where
+ * position i swaps with i + BoundedIndex(n - i). Dense samples run it on an array of n indices, sparse ones
+ * (k << n) keep only the displaced positions in a hash map. Both give the same output for a seed.
+ */
+
+/// \brief Elements per bucket of ParallelShuffle, about L2 sized for 8 byte elements
+static const size_t SHUFFLE_BUCKET_SIZE = 1 << 16;
+
+/// \brief Upper bound of ParallelShuffle chunks, keeps the chunk x bucket count table small
+static const size_t MAX_SHUFFLE_CHUNKS = MAX_PARALLEL_THREADS;
+
+/// \brief Swaps drawn ahead and prefetched per block of Shuffle
+static const size_t SHUFFLE_PREFETCH = 32;
+
+/// \brief Largest n for SampleWithoutReplacement and Permutation, indices are written as uint32
+static const uint64_t MAX_SAMPLE_POPULATION = uint64_t(1) << 32;
+
+/// \brief Uniform index in [0, s), s > 0. Lemire's nearly divisionless method with a bound that may change
+///        every call, the rejection threshold is only computed on the rare slow path.
+/// \note One Next32 below 2^32, one Next64 above, plus rare rejection retries
+template<class GENERATOR>
+uint64_t BoundedIndex(GENERATOR& generator, uint64_t s)
+{
+    assert(s > 0);
+    if (s <= 0xFFFFFFFFu) {
+        const uint32_t s32 = static_cast<uint32_t>(s);
+        uint64_t m = static_cast<uint64_t>(rng_bits::Next32(generator)) * s32;
+        if (static_cast<uint32_t>(m) < s32) {
+            const uint32_t t = (0u - s32) % s32;
+            while (static_cast<uint32_t>(m) < t) {
+                m = static_cast<uint64_t>(rng_bits::Next32(generator)) * s32;
+            }
+        }
+        return m >> 32;
+    }
+
+    uint64_t hi, l;
+    engine_detail::Mul64(rng_bits::Next64(generator), s, hi, l);
+    if (l < s) {
+        const uint64_t t = (0 - s) % s;
+        while (l < t) {
+            engine_detail::Mul64(rng_bits::Next64(generator), s, hi, l);
+        }
+    }
+    return hi;
+}
+
+/// \brief Fisher-Yates shuffle of data[0, n) in place
+template<class T, class GENERATOR>
+void Shuffle(GENERATOR& generator, T* data, size_t n)
+{
+    size_t swaps[SHUFFLE_PREFETCH];
+    for (size_t i = n; i > 1;) {
+        const size_t k = std::min(i - 1, SHUFFLE_PREFETCH);
+        for (size_t b = 0; b < k; b++) {
+            swaps[b] = static_cast<size_t>(BoundedIndex(generator, i - b));
+            engine_detail::Prefetch(data + swaps[b]);
+        }
+        for (size_t b = 0; b < k; b++) {
+            std::swap(data[i - b - 1], data[swaps[b]]);
+        }
+        i -= k;
+    }
+}
+
+/// \brief Scatter shuffle of data[0, n) in place on up to threads threads. Needs n elements of scratch memory.
+template<class T, class GENERATOR>
+void ParallelShuffle(uint64_t seed, uint32_t threads, T* data, size_t n)
+{
+    const size_t buckets = std::max<size_t>(1, (n + SHUFFLE_BUCKET_SIZE - 1) / SHUFFLE_BUCKET_SIZE);
+    const size_t chunkSize = std::max<size_t>(PARALLEL_BLOCK_SIZE, (n + MAX_SHUFFLE_CHUNKS - 1) / MAX_SHUFFLE_CHUNKS);
+    const size_t chunks = (n + chunkSize - 1) / chunkSize;
+
+    // bucket labels of chunk c, drawn twice: once to count, once to scatter
+    auto forEachLabel = [=] (size_t c, auto fn) {
+        GENERATOR generator(BlockSeed(seed, c));
+        const size_t last = std::min(n, (c + 1) * chunkSize);
+        for (size_t i = c * chunkSize; i < last; i++) {
+            fn(i, static_cast<size_t>(BoundedIndex(generator, buckets)));
+        }
+    };
+
+    // counts[c * buckets + b], turned into the scatter cursor of chunk c in bucket b
+    std::vector<size_t> counts(chunks * buckets, 0);
+    ParallelFor(threads, chunks, [&] (size_t c) {
+        size_t* count = counts.data() + c * buckets;
+        forEachLabel(c, [count] (size_t, size_t b) { count[b]++; });
+    });
+
+    // buckets are laid out in order, chunks in order within a bucket
+    std::vector<size_t> bucketStart(buckets + 1, 0);
+    size_t offset = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        bucketStart[b] = offset;
+        for (size_t c = 0; c < chunks; c++) {
+            const size_t count = counts[c * buckets + b];
+            counts[c * buckets + b] = offset;
+            offset += count;
+        }
+    }
+    bucketStart[buckets] = offset;
+    assert(offset == n);
+
+    std::unique_ptr<T[]> scratch(new T[n]);
+    ParallelFor(threads, chunks, [&] (size_t c) {
+        size_t* cursor = counts.data() + c * buckets;
+        T* out = scratch.get();
+        forEachLabel(c, [cursor, out, data] (size_t i, size_t b) { out[cursor[b]++] = data[i]; });
+    });
+
+    ParallelFor(threads, buckets, [&] (size_t b) {
+        const size_t first = bucketStart[b];
+        const size_t count = bucketStart[b + 1] - first;
+        std::memcpy(data + first, scratch.get() + first, count * sizeof(T));
+        GENERATOR generator(BlockSeed(seed, chunks + b));
+        Shuffle(generator, data + first, count);
+    });
+}
+
+namespace shuffle_detail {
+
+/// \brief Sparse view of a partially shuffled 0..n-1, only positions holding another index are stored.
+///        Open addressing with linear probing, sized for a fixed number of stores.
+class DisplacedIndices {
+    static const uint64_t Empty = ~uint64_t(0);
+
+    struct Entry {
+        uint64_t position;
+        uint32_t index;
+    };
+
+    std::vector<Entry> m_entries;
+    size_t m_mask;
+
+    size_t Home(uint64_t position) const {
+        return static_cast<size_t>((position * 0x9E3779B97F4A7C15ull) >> 32) & m_mask;
+    }
+
+public:
+    /// \param stores upper bound of Set calls
+    explicit DisplacedIndices(size_t stores) {
+        size_t capacity = 16;
+        while (capacity < 2 * stores) {
+            capacity <<= 1;
+        }
+        m_entries.assign(capacity, Entry{ Empty, 0 });
+        m_mask = capacity - 1;
+    }
+
+    /// \brief Index at position
+    uint32_t Get(uint64_t position) const {
+        for (size_t slot = Home(position);; slot = (slot + 1) & m_mask) {
+            if (m_entries[slot].position == position) {
+                return m_entries[slot].index;
+            }
+            if (m_entries[slot].position == Empty) {
+                return static_cast<uint32_t>(position);
+            }
+        }
+    }
+
+    /// \brief Store index at position
+    void Set(uint64_t position, uint32_t index) {
+        size_t slot = Home(position);
+        while (m_entries[slot].position != position && m_entries[slot].position != Empty) {
+            slot = (slot + 1) & m_mask;
+        }
+        m_entries[slot] = Entry{ position, index };
+    }
+};
+
+}
+
+/// \brief k distinct indices of [0, n) in random order into out. k <= n <= MAX_SAMPLE_POPULATION.
+/// \note O(k) time and memory when k << n, O(n) otherwise
+template<class GENERATOR>
+void SampleWithoutReplacement(GENERATOR& generator, uint64_t n, uint32_t* out, size_t k)
+{
+    assert(k <= n && n <= MAX_SAMPLE_POPULATION);
+
+    // the hash map costs about 16x more per index than the dense array
+    if (k < n / 16) {
+        shuffle_detail::DisplacedIndices displaced(k);
+        for (size_t i = 0; i < k; i++) {
+            const uint64_t j = i + BoundedIndex(generator, n - i);
+            out[i] = displaced.Get(j);
+            displaced.Set(j, displaced.Get(i));
+        }
+        return;
+    }
+
+    std::unique_ptr<uint32_t[]> indices(new uint32_t[n]);
+    std::iota(indices.get(), indices.get() + n, uint32_t(0));
+    for (size_t i = 0; i < k; i++) {
+        const size_t j = static_cast<size_t>(i + BoundedIndex(generator, n - i));
+        std::swap(indices[i], indices[j]);
+    }
+    std::memcpy(out, indices.get(), k * sizeof(uint32_t));
+}
+
+}
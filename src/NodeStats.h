@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+/**
+ * Hot path instrumentation, read with rng.GetStats()
+ *
+ * Relaxed atomic counters and log-linear latency histograms, safe to update from the JS thread, libuv workers,
+ * parallel fill threads and ring producers at once. Per NodeRand instance, allocated on first use. Streams and
+ * rings share the stats of the instance that created them and keep them alive.
+ *
+ * Compiled in by default. node-gyp rebuild -- -Dnode_rand_stats=0 defines NODE_RAND_STATS=0, which compiles every
+ * NODE_RAND_STAT and StatsNow() call out and GetStats() reports { enabled: false } with zeros.
+ */
+#ifndef NODE_RAND_STATS
+#define NODE_RAND_STATS 1
+#endif
+
+#if NODE_RAND_STATS
+#define NODE_RAND_STAT(stats, call) do { if (stats) { (stats)->call; } } while (0)
+#else
+// still type checked, never evaluated
+#define NODE_RAND_STAT(stats, call) do { if (false) { (stats)->call; } } while (0)
+#endif
+
+namespace node_rand {
+
+/// \brief Stats are compiled in
+static const bool STATS_ENABLED = NODE_RAND_STATS != 0;
+
+typedef std::chrono::steady_clock StatsClock;
+
+/// \brief Start of a timed section, the epoch when stats are compiled out
+inline StatsClock::time_point StatsNow()
+{
+#if NODE_RAND_STATS
+    return StatsClock::now();
+#else
+    return StatsClock::time_point();
+#endif
+}
+
+/// \brief ns since start
+inline uint64_t ElapsedNs(StatsClock::time_point start)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(StatsNow() - start).count());
+}
+
+/// \brief Percentiles of a LatencyHistogram in ns. Percentiles are the upper bound of their bucket, at most max.
+struct LatencySummary {
+    uint64_t count{0};
+    uint64_t min{0};
+    uint64_t max{0};
+    double mean{0};
+    uint64_t p50{0};
+    uint64_t p90{0};
+    uint64_t p99{0};
+    uint64_t p999{0};
+};
+
+/// \class LatencyHistogram
+/// \brief HDR style histogram of ns. Values below 2^SUB_BITS have a bucket each, every power of two above is
+///        split into 2^SUB_BITS buckets, so a bucket is within 12.5% of its values. Values from 2^MAX_BITS ns
+///        (about 18 minutes) on are counted in the last bucket.
+class LatencyHistogram {
+public:
+    static const uint32_t SUB_BITS = 3;
+    static const uint32_t SUB_BUCKETS = 1 << SUB_BITS;
+    static const uint32_t MAX_BITS = 40;
+    static const uint32_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+
+private:
+    std::atomic<uint64_t> m_buckets[BUCKETS]{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_min{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> m_max{0};
+
+public:
+    /// \brief Bucket of ns
+    static uint32_t Index(uint64_t ns) {
+        ns = std::min(ns, (uint64_t(1) << MAX_BITS) - 1);
+        if (ns < SUB_BUCKETS) {
+            return static_cast<uint32_t>(ns);
+        }
+        uint32_t log2 = SUB_BITS;
+        while ((ns >> (log2 + 1)) != 0) {
+            log2++;
+        }
+        return (log2 - SUB_BITS + 1) * SUB_BUCKETS + static_cast<uint32_t>((ns >> (log2 - SUB_BITS)) & (SUB_BUCKETS - 1));
+    }
+
+    /// \brief Largest ns of bucket index
+    static uint64_t UpperBound(uint32_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        const uint32_t shift = index / SUB_BUCKETS - 1;
+        const uint64_t lower = uint64_t(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+        return lower + (uint64_t(1) << shift) - 1;
+    }
+
+    void Record(uint64_t ns) {
+        m_buckets[Index(ns)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t seen = m_min.load(std::memory_order_relaxed);
+        while (ns < seen && !m_min.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+        seen = m_max.load(std::memory_order_relaxed);
+        while (ns > seen && !m_max.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+    }
+
+    /// \brief Summary of the values recorded so far. Not a consistent snapshot while values are being recorded.
+    LatencySummary Summary() const {
+        uint64_t buckets[BUCKETS];
+        uint64_t count = 0;
+        for (uint32_t i = 0; i < BUCKETS; i++) {
+            buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+            count += buckets[i];
+        }
+
+        LatencySummary summary;
+        if (count == 0) {
+            return summary;
+        }
+        summary.count = count;
+        summary.min = m_min.load(std::memory_order_relaxed);
+        summary.max = m_max.load(std::memory_order_relaxed);
+        summary.mean = static_cast<double>(m_sum.load(std::memory_order_relaxed)) / m_count.load(std::memory_order_relaxed);
+
+        // smallest bucket holding at least q * count values
+        auto percentile = [&] (double q) {
+            const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.5));
+            uint64_t seen = 0;
+            for (uint32_t i = 0; i < BUCKETS; i++) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    return std::min(UpperBound(i), summary.max);
+                }
+            }
+            return summary.max;
+        };
+        summary.p50 = percentile(0.5);
+        summary.p90 = percentile(0.9);
+        summary.p99 = percentile(0.99);
+        summary.p999 = percentile(0.999);
+        return summary;
+    }
+};
+
+/// \brief Plain copy of NodeStats, see GetStats
+struct NodeStatsSnapshot {
+    uint64_t valuesGenerated{0};
+    uint64_t chunksPushed{0};
+    uint64_t queueDepth{0};
+    uint64_t maxQueueDepth{0};
+    uint64_t backpressureStalls{0};
+    uint64_t queueFullStalls{0};
+    uint64_t seedRefills{0};
+    LatencySummary chunkGenerate;
+    LatencySummary chunkPush;
+};
+
+/// \class NodeStats
+/// \brief Counters and histograms of one NodeRand instance and the streams and rings it created.
+///        Update through NODE_RAND_STAT(stats, ...) so that they compile out.
+class NodeStats {
+    // numbers generated: Generate, GenerateInto(Async), distribution handles, streams and rings
+    std::atomic<uint64_t> m_valuesGenerated{0};
+    // chunks handed to Readable.push()
+    std::atomic<uint64_t> m_chunksPushed{0};
+    // chunks queued on the tsfn of every stream, or about to be
+    std::atomic<uint64_t> m_queueDepth{0};
+    std::atomic<uint64_t> m_maxQueueDepth{0};
+    // Readable.push() returned false, the stream stops producing until the next _read()
+    std::atomic<uint64_t> m_backpressureStalls{0};
+    // a stream worker blocked on a full tsfn queue
+    std::atomic<uint64_t> m_queueFullStalls{0};
+    // pseudo seeds drawn: reseeds after SetSeed, streams, async and parallel fills
+    std::atomic<uint64_t> m_seedRefills{0};
+    // ns to generate one chunk of a stream or one slot of a ring
+    LatencyHistogram m_chunkGenerate;
+    // ns from queueing a chunk on the worker to Readable.push() returning on the JS thread
+    LatencyHistogram m_chunkPush;
+
+public:
+    void AddValues(uint64_t count) { m_valuesGenerated.fetch_add(count, std::memory_order_relaxed); }
+
+    void AddSeedRefill() { m_seedRefills.fetch_add(1, std::memory_order_relaxed); }
+
+    void ChunkGenerated(uint64_t count, uint64_t ns) {
+        AddValues(count);
+        m_chunkGenerate.Record(ns);
+    }
+
+    void ChunkQueued() {
+        const uint64_t depth = m_queueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint64_t seen = m_maxQueueDepth.load(std::memory_order_relaxed);
+        while (depth > seen && !m_maxQueueDepth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {}
+    }
+
+    void QueueFull() { m_queueFullStalls.fetch_add(1, std::memory_order_relaxed); }
+
+    /// \brief Chunk left the tsfn queue, pushed or dropped
+    void ChunkDequeued() { m_queueDepth.fetch_sub(1, std::memory_order_relaxed); }
+
+    void ChunkPushed(uint64_t ns) {
+        m_chunksPushed.fetch_add(1, std::memory_order_relaxed);
+        m_chunkPush.Record(ns);
+    }
+
+    void Backpressure() { m_backpressureStalls.fetch_add(1, std::memory_order_relaxed); }
+
+    NodeStatsSnapshot Snapshot() const {
+        NodeStatsSnapshot snapshot;
+        snapshot.valuesGenerated = m_valuesGenerated.load(std::memory_order_relaxed);
+        snapshot.chunksPushed = m_chunksPushed.load(std::memory_order_relaxed);
+        snapshot.queueDepth = m_queueDepth.load(std::memory_order_relaxed);
+        snapshot.maxQueueDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+        snapshot.backpressureStalls = m_backpressureStalls.load(std::memory_order_relaxed);
+        snapshot.queueFullStalls = m_queueFullStalls.load(std::memory_order_relaxed);
+        snapshot.seedRefills = m_seedRefills.load(std::memory_order_relaxed);
+        snapshot.chunkGenerate = m_chunkGenerate.Summary();
+        snapshot.chunkPush = m_chunkPush.Summary();
+        return snapshot;
+    }
+};
+
+}
@@ -1,32 +1,84 @@
 {
+  'variables': {
+    # Build counter based engine kernels with AVX2: node-gyp rebuild -- -Dnode_rand_avx2=1
+    'node_rand_avx2%': 0,
+    # Build the native benchmark executable: node-gyp rebuild -- -Dnode_rand_bench=1
+    'node_rand_bench%': 0,
+    # rng.GetStats() counters and histograms, compile them out with: node-gyp rebuild -- -Dnode_rand_stats=0
+    'node_rand_stats%': 1
+  },
   'defines': [
-    "NAPI_VERSION=4"
+    "NAPI_VERSION=6"
   ],
+  # Compiler flags of every target, the bench and kat executables must build the same kernels as the addon
+  'target_defaults': {
+    "conditions": [['OS=="win"', {
+       'msvs_settings':
+        {
+          'VCCLCompilerTool':
+          {
+            'AdditionalOptions':
+              [
+              '/std:c++17',
+              ]
+          }
+        }
+      }],
+      ['OS=="linux"', {
+       'cflags_cc': [
+         '-std=c++17'
+       ]
+      }
+      ],
+      ['OS=="linux" and node_rand_avx2==1', {
+       'cflags_cc': [
+         '-mavx2'
+       ]
+      }
+      ],
+      ['OS=="win" and node_rand_avx2==1', {
+       'msvs_settings':
+        {
+          'VCCLCompilerTool':
+          {
+            'AdditionalOptions':
+              [
+              '/arch:AVX2',
+              ]
+          }
+        }
+      }]
+    ]
+  },
   'targets': [
     {
       'target_name': 'node_rand',
-      'sources': [ 'NodeGlobalBuffer.cpp', 'NodeRand.cpp' ],
-      "conditions": [['OS=="win"', {
-         'msvs_settings':
-          {
-            'VCCLCompilerTool':
-            {
-              'AdditionalOptions':
-                [
-                '/std:c++17',
-                ]
-            }
-          }
-        }],
-        ['OS=="linux"', {
-         'cflags_cc': [
-           '-std=c++17'
-         ]
+      'sources': [ 'NodeAliasTable.cpp', 'NodeBufferPool.cpp', 'NodeGlobalBuffer.cpp', 'NodeRand.cpp', 'NodeRandAliasTable.cpp', 'NodeRandRing.cpp', 'NodeRandBatches.cpp', 'NodeGeneratorPool.cpp' ],
+      'defines': [ 'NODE_RAND_STATS=<(node_rand_stats)' ],
+      'configurations': {
+        # NODE_RAND_LOG output, compiled out of release builds
+        'Debug': {
+          'defines': [ 'NODE_RAND_DEBUG' ]
         }
-        ]
-      ]
+      }
     }
   ],
-  
-  
-}
\ No newline at end of file
+  'conditions': [['node_rand_bench==1', {
+    'targets': [
+      {
+        # engines and distributions without N-API, see bench/native/node_rand_bench.cpp
+        'target_name': 'node_rand_bench',
+        'type': 'executable',
+        'sources': [ '../bench/native/node_rand_bench.cpp', 'NodeAliasTable.cpp' ],
+        'include_dirs': [ '.' ]
+      },
+      {
+        # Random123 known answer and lane equality checks of the counter engines, see bench/native/node_rand_kat.cpp
+        'target_name': 'node_rand_kat',
+        'type': 'executable',
+        'sources': [ '../bench/native/node_rand_kat.cpp' ],
+        'include_dirs': [ '.' ]
+      }
+    ]
+  }]]
+}
@@ -8,12 +8,201 @@ declare enum Generator {
   
 }
 
+// Output type of Generate and GenerateSequenceStream. Streams emit tightly packed elements of the type.
+export declare enum Type {
+  Int8 = 0,
+  Uint8 = 1,
+  Int16 = 3,
+  Uint16 = 4,
+  Int32 = 5,
+  Uint32 = 6,
+  Float32 = 7,
+  Float64 = 8,
+  BigInt64 = 9,
+  BigUint64 = 10
+}
+
+// TypedArrays supported by GenerateInto/GenerateIntoAsync. Uint8ClampedArray fills like Uint8Array
+type FillableArray = Int8Array | Uint8Array | Uint8ClampedArray | Int16Array | Uint16Array | Int32Array | Uint32Array
+  | Float32Array | Float64Array | BigInt64Array | BigUint64Array;
+
+export interface StreamOptions {
+  // numbers per chunk (initial size when adaptive). Default 2000
+  chunkSize?: number;
+  // Readable highWaterMark in bytes. Default 16kb (2mb when adaptive), raised to fit one chunk
+  highWaterMark?: number;
+  // grow chunks while the consumer keeps up, up to half the highWaterMark, shrink them under backpressure
+  adaptive?: boolean;
+  // generate on this many threads (1 - 256). Output depends on the seed only, not the thread count.
+  // Chunks are 65536 numbers, chunkSize/adaptive are ignored.
+  threads?: number;
+  // element type of the chunks. Default BigInt64
+  type?: Type;
+  // seed the stream like Fork(streamId) instead of taking the next seed, integer in [0, 2^64)
+  streamId?: number | bigint;
+}
+
+export interface FillOptions {
+  // fill on this many threads (1 - 256). Same numbers as GenerateSequenceStream with the same threads option set
+  threads?: number;
+}
+
+// Distribution handle bound to the generator it was created from. Parameters are validated once.
+export interface Distribution {
+  // next number, continues the generator's sequence
+  Next(): number;
+  // fill in place, see IntDistribution/RealDistribution for the supported arrays
+  Fill<T extends FillableArray>(array:T): T;
+  // same as GenerateSequenceStream(min, max, count, options) with this distribution. Chunks are
+  // BigInt64 for integer distributions (Uint32 for Discrete) and Float64 for real ones, the type option cannot change it
+  Stream(count:number, options?:StreamOptions): Readable;
+}
+
+// Integer distribution. Fills Float32Array/Float64Array, or any integer array its [min, max] fits in
+export interface IntDistribution extends Distribution {}
+
+// Real distribution. Fills Float32Array/Float64Array only
+export interface RealDistribution extends Distribution {
+  Fill<T extends Float32Array | Float64Array>(array:T): T;
+}
+
+export type UniformIntDistribution = IntDistribution;
+
+export interface RingOptions {
+  // slots in the ring, power of two (2 - 65536). Default 16
+  slots?: number;
+  // numbers per slot, what a reader claims at once (1 - 2^20). Default 4096
+  sliceSize?: number;
+  // the producer refills once this many filled slots or fewer are left, < slots. Default slots / 2
+  lowWater?: number;
+  // element type. Default BigInt64
+  type?: Type;
+  // seed the ring like Fork(streamId) instead of taking the next seed, integer in [0, 2^64)
+  streamId?: number | bigint;
+}
+
+// Producer of a shared ring, see SharedRing. Stops on Close(), when garbage collected, or when its thread exits
+export interface RandomRing {
+  // what RingReaders attach to, can be posted to workers
+  Buffer(): SharedArrayBuffer;
+  // stop the producer, readers drain the filled slots then throw
+  Close(): void;
+  // numbers produced so far
+  Produced(): number;
+}
+
+// Promise based batches of one sequence, see GenerateBatches. for await (const batch of batches) iterates batches of chunkSize
+export interface RandomBatches<T extends FillableArray = FillableArray> extends AsyncIterable<T> {
+  // next n numbers (default chunkSize, at most 2^20), shorter at the end, null once exhausted. Resolves in call order
+  NextBatch(n?:number): Promise<T | null>;
+  // numbers not requested yet
+  Remaining(): number;
+  BatchSize(): number;
+}
+
+// Process wide. Streams created afterwards produce on threads (1 to 256) dedicated generator threads instead of the
+// libuv threadpool, one chunk per stream in turn. 0 (default) goes back to the libuv threadpool for new streams
+export declare function SetGeneratorThreads(threads:number): void;
+// 0 while streams use the libuv threadpool
+export declare function GetGeneratorThreads(): number;
+
+// Reads a shared ring from any thread without calling into the addon. Waits while the ring is drained
+export declare class RingReader {
+  constructor(buffer:SharedArrayBuffer);
+  // bigint for BigInt64/BigUint64 rings
+  Next(): number | bigint;
+  // array type must match the ring type
+  Fill<T extends FillableArray>(array:T): T;
+}
+
+// Latency histogram in ns. Percentiles are within 12.5% of the recorded values
+export interface LatencyStats {
+  count: number;
+  min: number;
+  max: number;
+  mean: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  p999: number;
+}
+
+// Counters of an instance and the streams and rings it created. All 0 when built with -Dnode_rand_stats=0
+export interface NodeRandStats {
+  enabled: boolean;
+  // Generate, GenerateInto(Async), distribution handles, streams and rings
+  valuesGenerated: number;
+  // chunks handed to Readable.push()
+  chunksPushed: number;
+  // chunks waiting for the JS thread now, and the most seen
+  queueDepth: number;
+  maxQueueDepth: number;
+  // push() returned false, production paused until the next _read()
+  backpressureStalls: number;
+  // a stream worker waited for room in the queue to the JS thread
+  queueFullStalls: number;
+  // pseudo seeds taken: reseeds after SetSeed, streams, async and parallel fills
+  seedRefills: number;
+  // generating one stream chunk or ring slot
+  chunkGenerateNs: LatencyStats;
+  // from a worker queueing a chunk to push() returning
+  chunkPushNs: LatencyStats;
+}
+
+// Prebuilt alias table for Discrete. Immutable, shared by every handle and thread using it
+export declare class AliasTable {
+  // throws, create with AliasTable.Build
+  constructor();
+  static Build(weights:ArrayLike<number>): AliasTable;
+  // attach to a table built by another thread of this process, while it is still referenced there
+  static FromId(id:number): AliasTable;
+  Id(): number;
+  Size(): number;
+}
+
 // Not really an abstract class, just useful for definitions. This class is templated on the c++ random number generator type
 // DON'T IMPORT
 declare abstract class _NodeRand {
   SetSeed(seed:number): void;
   Generate(min:number, max:number): number;
-  GenerateSequenceStream(min:number, max:number, count:number): Readable;
+  // min and max must fit in type
+  Generate(min:number | bigint, max:number | bigint, type:Type.BigInt64 | Type.BigUint64): bigint;
+  Generate(min:number, max:number, type:Type): number;
+  GenerateSequenceStream(min:number | bigint, max:number | bigint, count:number, options?:StreamOptions): Readable;
+  GenerateInto<T extends FillableArray>(array:T, min:number | bigint, max:number | bigint, options?:FillOptions): T;
+  GenerateIntoAsync<T extends FillableArray>(array:T, min:number | bigint, max:number | bigint, options?:FillOptions): Promise<T>;
+  // ring of numbers in [min, max] (Float32/Float64: [min, max)) kept filled by a producer thread, read it with RingReader.
+  // In slot order it holds what GenerateSequenceStream(min, max, count, options) emits
+  SharedRing(min:number | bigint, max:number | bigint, options?:RingOptions): RandomRing;
+  // the numbers of GenerateSequenceStream(min, max, count, options) as TypedArrays of options.type, without a Readable.
+  // chunkSize, type and streamId are used, threads is not supported
+  GenerateBatches(min:number | bigint, max:number | bigint, count:number, options?:StreamOptions): RandomBatches;
+  // new instance of the same engine seeded from a hash of this seed and streamId, O(1). Does not depend on call order
+  Fork(streamId:number | bigint): this;
+  // binary snapshot of the generator and pseudo seed state, for checkpoints. Stable across platforms and versions
+  GetState(): Buffer;
+  // resume exactly where GetState() was called, state must come from the same engine
+  SetState(state:Uint8Array): void;
+  GetStats(): NodeRandStats;
+  UniformInt(min:number, max:number): UniformIntDistribution;
+  // Ziggurat
+  Normal(mean:number, stddev:number): RealDistribution;
+  // exp(Normal(mean, stddev))
+  LogNormal(mean:number, stddev:number): RealDistribution;
+  // rate lambda, Ziggurat
+  Exponential(lambda:number): RealDistribution;
+  Gamma(shape:number, scale:number): RealDistribution;
+  Poisson(mean:number): IntDistribution;
+  // successes in n trials with probability p
+  Binomial(n:number, p:number): IntDistribution;
+  // index i with probability weights[i] / sum(weights), alias table. An AliasTable is shared, not rebuilt
+  Discrete(weights:ArrayLike<number> | AliasTable): IntDistribution;
+  // Fisher-Yates in place, any TypedArray. threads: scatter shuffle, same result for any thread count
+  Shuffle<T extends FillableArray>(array:T, options?:FillOptions): T;
+  // 0..n-1 shuffled, n <= 2^32
+  Permutation(n:number, options?:FillOptions): Uint32Array;
+  // k distinct integers of [0, n) in random order, n <= 2^32
+  SampleWithoutReplacement(n:number, k:number): Uint32Array;
 }
 
 export class NodeRand_mt19937 extends _NodeRand {
@@ -22,4 +211,41 @@ export class NodeRand_mt19937 extends _NodeRand {
 
 export class NodeRand_mt19937_64 extends _NodeRand {
   constructor();
-}
\ No newline at end of file
+}
+
+// Philox4x32-10 counter based engine, SIMD batched
+export class NodeRand_philox4x32 extends _NodeRand {
+  constructor();
+  // skip n raw engine outputs in O(1)
+  Advance(n:number): void;
+}
+
+// Threefry4x64-20 counter based engine, SIMD batched
+export class NodeRand_threefry4x64 extends _NodeRand {
+  constructor();
+  // skip n raw engine outputs in O(1)
+  Advance(n:number): void;
+}
+
+// xoshiro256** small state engine (32 bytes)
+export class NodeRand_xoshiro256ss extends _NodeRand {
+  constructor();
+  // skip 2^128 numbers, splits the sequence into non-overlapping parts
+  Jump(): void;
+}
+
+// PCG64 (XSL RR 128/64) small state engine (16 bytes)
+export class NodeRand_pcg64 extends _NodeRand {
+  constructor();
+  // skip 2^64 numbers, splits the sequence into non-overlapping parts
+  Jump(): void;
+  // skip n raw engine outputs in O(log n)
+  Advance(n:number): void;
+}
+
+// SplitMix64 small state engine (8 bytes)
+export class NodeRand_splitmix64 extends _NodeRand {
+  constructor();
+  // skip n raw engine outputs in O(1)
+  Advance(n:number): void;
+}
@@ -1,7 +1,41 @@
 const node_rand = require("./node_rand.node");
 const { Readable } = require('stream')
-node_rand.NodeRand_mt19937.SetReadable(Readable);
-node_rand.NodeRand_mt19937_64.SetReadable(Readable);
 
-exports.NodeRand_mt19937 = node_rand.NodeRand_mt19937;
-exports.NodeRand_mt19937_64 = node_rand.NodeRand_mt19937_64;
\ No newline at end of file
+const classes = [
+    'NodeRand_mt19937',
+    'NodeRand_mt19937_64',
+    'NodeRand_philox4x32',
+    'NodeRand_threefry4x64',
+    'NodeRand_xoshiro256ss',
+    'NodeRand_pcg64',
+    'NodeRand_splitmix64'
+];
+
+for (const name of classes) {
+    node_rand[name].SetReadable(Readable);
+    exports[name] = node_rand[name];
+}
+
+// Output type selector, values match the TypedArray element types
+exports.Type = Object.freeze(node_rand.Type);
+
+// Prebuilt weighted sampling tables, shared by rng.Discrete(table) across instances and worker threads
+exports.AliasTable = node_rand.AliasTable;
+
+// Process wide, streams created after SetGeneratorThreads(n > 0) produce on n dedicated threads instead of the libuv threadpool
+exports.SetGeneratorThreads = node_rand.SetGeneratorThreads;
+exports.GetGeneratorThreads = node_rand.GetGeneratorThreads;
+
+// Reads rng.SharedRing(min, max, options).Buffer() from any thread
+exports.RingReader = require('./ring').RingReader;
+
+// rng.GenerateBatches(min, max, count, options) handles iterate their batches of options.chunkSize.
+// The next batch is requested before yielding, so it is generated while the consumer works on the current one
+node_rand.RandomBatches.prototype[Symbol.asyncIterator] = async function* () {
+    const size = this.BatchSize();
+    let next = this.NextBatch(size);
+    for (let batch = await next; batch !== null; batch = await next) {
+        next = this.NextBatch(size);
+        yield batch;
+    }
+};
@@ -11,112 +11,205 @@
 #include <array>
 #include <type_traits>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
+/*
+    Debug logging. Compiled out unless NODE_RAND_DEBUG is defined (node-gyp --debug builds define it).
+    NODE_RAND_LOG("seed: " << seed);
+*/
+#ifdef NODE_RAND_DEBUG
+#define NODE_RAND_LOG(msg) do { std::cout << msg << std::endl; } while (0)
+#else
+#define NODE_RAND_LOG(msg) do { } while (0)
+#endif
+
 namespace napi_extensions
 {
-// TODO: Add logging capabilities in debug mode
 
 /*
     Check return status from napi_xxx(). If status != napi_ok, log message along with napi_extended_error_info
 */
-inline void CheckStatus(napi_status status, napi_env env, const std::string& message = "unknown")
+inline void CheckStatus(napi_status status, napi_env env, const char* message = "unknown")
 {
     if (status != napi_ok) {
 
-        const napi_extended_error_info* info;
-        napi_get_last_error_info(env, (const napi_extended_error_info**)&info);
+        // owned by napi, valid until the next napi call
+        const napi_extended_error_info* info = nullptr;
+        napi_get_last_error_info(env, &info);
 
         std::stringstream ss;
         ss << "[ERROR]: " << message << "\n";
         ss << "\tnapi error code: " << info->error_code << "\n";
         ss << "\tengine error code: " << info->engine_error_code << "\n";
-        ss << "\tmessage: " << info->error_message << "\n";
-        delete info;
+        ss << "\tmessage: " << (info->error_message ? info->error_message : "") << "\n";
 
         napi_throw_type_error(env, nullptr, ss.str().c_str());
     }
 }
 
 /*
-    Get and validate napi_callback_info_arguments
+    Get and validate napi_callback_info_arguments.
+    Validators are plain classes, SetVal(env, value) is resolved at compile time by GetArgs.
 */
 template<typename T>
 class NapiArgValidator {
+protected:
+    T _val{};
+
 public:
-    virtual void SetVal(napi_env env, napi_value value) = 0;
-    virtual T GetVal() = 0;
+    T GetVal() const
+    {
+        return _val;
+    }
 };
 
 template<typename T>
 class NapiArgNumber : public NapiArgValidator<T> {
 protected:
-    T _val;
+    /// \brief napi_get_value_xxx reports napi_number_expected itself, no separate napi_typeof needed
+    static void CheckNumber(napi_env env, napi_status status, const char* message) {
+        assert(status != napi_number_expected && "Argument invalid. Expecting number!");
+        CheckStatus(status, env, message);
+    }
+};
 
-    void CheckNumber(napi_env env, napi_value value) {
-        napi_valuetype type;
-        CheckStatus(napi_typeof(env, value, &type), env, "Failed to get napi typeof");
-        assert(type == napi_number && "Argument invalid. Expecting number!");
+class NapiArgUint32 : public NapiArgNumber<uint32_t> {
+public:
+    void SetVal(napi_env env, napi_value value)
+    {
+        CheckNumber(env, napi_get_value_uint32(env, value, &_val), "Failed to get uint32 value");
     }
+};
 
+class NapiArgInt64 : public NapiArgNumber<int64_t> {
 public:
-    T GetVal() override
+    void SetVal(napi_env env, napi_value value)
     {
-        return _val;
+        CheckNumber(env, napi_get_value_int64(env, value, &_val), "Failed to get int64 value");
     }
 };
 
-class NapiArgUint32 : public NapiArgNumber<uint32_t> {
+class NapiArgDouble : public NapiArgNumber<double> {
 public:
-    void SetVal(napi_env env, napi_value value) override
+    void SetVal(napi_env env, napi_value value)
     {
-        CheckNumber(env, value);
-        uint32_t result;
-        CheckStatus(napi_get_value_uint32(env, value, &result), env, "Failed to get uint32 value");
-        _val = result;
+        CheckNumber(env, napi_get_value_double(env, value, &_val), "Failed to get double value");
     }
 };
 
-class NapiArgInt64 : public NapiArgNumber<int64_t> {
+/// \brief View of a caller-owned TypedArray. Data is not copied.
+struct NapiTypedArrayInfo {
+    napi_value value{nullptr};
+    napi_typedarray_type type{napi_uint8_array};
+    size_t length{0};
+    void* data{nullptr};
+};
+
+class NapiArgTypedArray : public NapiArgValidator<NapiTypedArrayInfo> {
 public:
-    void SetVal(napi_env env, napi_value value) override
+    void SetVal(napi_env env, napi_value value)
     {
-        CheckNumber(env, value);
-        int64_t result;
-        CheckStatus(napi_get_value_int64(env, value, &result), env, "Failed to get int64 value");
-        _val = result;
+        bool isTypedArray = false;
+        CheckStatus(napi_is_typedarray(env, value, &isTypedArray), env, "Failed to check typedarray");
+        assert(isTypedArray && "Argument invalid. Expecting TypedArray!");
+        _val.value = value;
+        CheckStatus(napi_get_typedarray_info(env, value, &_val.type, &_val.length, &_val.data, nullptr, nullptr),
+            env, "Failed to get typedarray info");
     }
+
 };
 
-template<typename T>
-inline void _GetArgs(napi_env env, napi_callback_info info, napi_value* argv, size_t& argv_index, T& arg)
-{
-    arg.SetVal(env, argv[argv_index]);
-}
+/*
+    Read optional properties off a JS options object. Missing or undefined properties keep their default.
+*/
+class NapiOptions {
+    napi_env m_env;
+    napi_value m_object;
+
+    /// \brief Get property, false if options or property are null/undefined
+    bool Get(const char* name, napi_value& value) const
+    {
+        if (m_object == nullptr) {
+            return false;
+        }
+        napi_valuetype type;
+        CheckStatus(napi_get_named_property(m_env, m_object, name, &value), m_env, "Failed to get option property");
+        CheckStatus(napi_typeof(m_env, value, &type), m_env, "Failed to get napi typeof");
+        return type != napi_undefined && type != napi_null;
+    }
+
+public:
+    /// \param object JS object, or nullptr/undefined for all defaults
+    NapiOptions(napi_env env, napi_value object) : m_env(env), m_object(nullptr)
+    {
+        if (object != nullptr) {
+            napi_valuetype type;
+            CheckStatus(napi_typeof(env, object, &type), env, "Failed to get napi typeof");
+            assert((type == napi_object || type == napi_undefined || type == napi_null) && "Argument invalid. Expecting options object!");
+            m_object = type == napi_object ? object : nullptr;
+        }
+    }
+
+    bool Has(const char* name) const
+    {
+        napi_value value;
+        return Get(name, value);
+    }
+
+    uint32_t GetUint32(const char* name, uint32_t defaultVal) const
+    {
+        napi_value value;
+        if (!Get(name, value)) {
+            return defaultVal;
+        }
+        NapiArgUint32 arg;
+        arg.SetVal(m_env, value);
+        return arg.GetVal();
+    }
+
+    /// \brief Property value, false if not set
+    bool GetValue(const char* name, napi_value& value) const
+    {
+        return Get(name, value);
+    }
+
+    bool GetBool(const char* name, bool defaultVal) const
+    {
+        napi_value value;
+        if (!Get(name, value)) {
+            return defaultVal;
+        }
+        bool result = defaultVal;
+        CheckStatus(napi_get_value_bool(m_env, value, &result), m_env, "Failed to get bool value");
+        return result;
+    }
+};
 
-template<typename T, typename ...Args>
-inline void _GetArgs(napi_env env, napi_callback_info info, napi_value* argv, size_t& argv_index, T& arg, Args& ...args)
+template<typename ...Args>
+inline void _SetArgs(napi_env env, const napi_value* argv, Args& ...args)
 {
-    arg.SetVal(env, argv[argv_index]);
-    _GetArgs(env, info, argv, ++argv_index, args...);
+    size_t index = 0;
+    (args.SetVal(env, argv[index++]), ...);
 }
 
+/*
+    Read exactly sizeof...(Args) arguments. argv lives on the stack.
+*/
 template<typename ...Args>
 inline void GetArgs(napi_env env, napi_callback_info info, Args& ...args)
 {
     const std::size_t n = sizeof...(Args);
     size_t argc = n;
-    napi_value* argv = new napi_value[argc];
+    napi_value argv[n > 0 ? n : 1];
     CheckStatus(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr), env, "Failed to get cb info. napi_extensions::GetArgs");
     assert(argc == n && "invalid number of arguments");
-    
-    size_t index = 0;
-    _GetArgs(env, info, argv, index, args...);
-    delete [] argv;
+
+    _SetArgs(env, argv, args...);
 }
 
 /*
-    Unwrap jsthis into class instance
+    Unwrap jsthis into class instance. nullptr if unwrap fails, eg: the env is stopping (worker terminated) mid call
 */
 template<class T> 
 inline T* GetSelf(napi_env env, napi_callback_info info) {
@@ -127,6 +220,25 @@ inline T* GetSelf(napi_env env, napi_callback_info info) {
     return self;
 }
 
+/*
+    GetSelf and GetArgs with a single napi_get_cb_info call, for hot paths
+*/
+template<class T, typename ...Args>
+inline T* GetSelfArgs(napi_env env, napi_callback_info info, Args& ...args)
+{
+    const std::size_t n = sizeof...(Args);
+    size_t argc = n;
+    napi_value argv[n > 0 ? n : 1];
+    napi_value jsthis;
+    CheckStatus(napi_get_cb_info(env, info, &argc, argv, &jsthis, nullptr), env, "Failed to get cb info. napi_extensions::GetSelfArgs");
+    assert(argc == n && "invalid number of arguments");
+
+    T* self = nullptr;
+    CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(&self)), env, "Failed to unwrap in napi_extensions::GetSelfArgs");
+    _SetArgs(env, argv, args...);
+    return self;
+}
+
 /*
 @function - napi_inherts
 @description - This function will prototype chain the child class to the parent class. 
@@ -195,16 +307,83 @@ inline napi_status napi_inherits(napi_env env,           // Node-api env
 static const int64_t JAVASCRIPT_MAX_SAFE_NUMBER = 0x1FFFFFFFFFFFFF; //(2^53 - 1)
 static const int64_t JAVASCRIPT_MIN_SAFE_NUMBER = -(JAVASCRIPT_MAX_SAFE_NUMBER);
 
+/// \brief Per environment state. The main thread and every worker_thread loading the addon is its own napi_env, with
+///        its own copy of the JS values the addon holds on to (class constructors, Readable). Statics would be overwritten
+///        by the Init of the last env loaded. Set as napi instance data, deleted with its references at env teardown.
+class NapiEnvData {
+    napi_env m_env;
+    // references by key, see Key()
+    std::unordered_map<const void*, napi_ref> m_refs;
+
+    explicit NapiEnvData(napi_env env) : m_env(env) {}
+
+    /// \brief napi_finalize of the instance data, runs when env is torn down
+    static void Finalize(napi_env /*env*/, void* data, void* /*hint*/) {
+        delete reinterpret_cast<NapiEnvData*>(data);
+    }
+
+public:
+    NapiEnvData(const NapiEnvData&) = delete;
+    NapiEnvData& operator=(const NapiEnvData&) = delete;
+
+    ~NapiEnvData() {
+        for (auto& ref : m_refs) {
+            napi_delete_reference(m_env, ref.second);
+        }
+    }
+
+    /// \brief Data of env, created on first use. JS thread of env only.
+    static NapiEnvData& Get(napi_env env) {
+        void* data = nullptr;
+        CheckStatus(napi_get_instance_data(env, &data), env, "Failed to get instance data");
+        if (data == nullptr) {
+            data = new NapiEnvData(env);
+            CheckStatus(napi_set_instance_data(env, data, Finalize, nullptr), env, "Failed to set instance data");
+        }
+        return *reinterpret_cast<NapiEnvData*>(data);
+    }
+
+    /// \brief Key unique to TAG, eg: Key<NapiObjectWrap<T>>()
+    template<class TAG>
+    static const void* Key() {
+        static const char key = 0;
+        return &key;
+    }
+
+    /// \brief Keep a strong reference to value under key, replaces the previous one
+    void SetRef(const void* key, napi_value value) {
+        napi_ref& ref = m_refs[key];
+        if (ref != nullptr) {
+            napi_delete_reference(m_env, ref);
+            ref = nullptr;
+        }
+        CheckStatus(napi_create_reference(m_env, value, 1, &ref), m_env, "Failed to create env data reference");
+    }
+
+    /// \brief Reference kept under key, nullptr if none
+    napi_ref GetRef(const void* key) const {
+        auto it = m_refs.find(key);
+        return it != m_refs.end() ? it->second : nullptr;
+    }
+};
+
 /// \brief TODO Fill this out
 template<class T>
 class NapiObjectWrap {
-    // reference to contructor for NapiObjectWrap
-    static napi_ref m_thisConstructor;
     // passed along to class to get reference to 'this'
     napi_ref m_wrapper;
+
+    /// \brief Constructor of T in env, defined by Init
+    static napi_value Constructor(napi_env env) {
+        napi_ref ref = NapiEnvData::Get(env).GetRef(NapiEnvData::Key<NapiObjectWrap<T>>());
+        assert(ref != nullptr && "Class not initialized in this env");
+        napi_value cons = nullptr;
+        CheckStatus(napi_get_reference_value(env, ref, &cons), env, "Constructor::napi_get_reference_value");
+        return cons;
+    }
     
     static napi_value NewAsConstructor(napi_env env, napi_callback_info info) {
-        std::cout << "NewAsConstructor" << std::endl;
+        NODE_RAND_LOG("NewAsConstructor");
         napi_value jsthis;
         CheckStatus(napi_get_cb_info(env, info, nullptr, nullptr, &jsthis, nullptr), env, "NewAsConstructor::napi_get_cb_info");
 
@@ -222,12 +401,11 @@ class NapiObjectWrap {
     }
 
     static napi_value NewAsFunction(napi_env env, napi_callback_info info) {
-        std::cout << "NewAsFunction" << std::endl;
+        NODE_RAND_LOG("NewAsFunction");
         CheckStatus(napi_get_cb_info(env, info, nullptr, nullptr, nullptr, nullptr), env, "NewAsFunction::napi_get_cb_info");
 
-        napi_value cons, instance;
-        CheckStatus(napi_get_reference_value(env, m_thisConstructor, &cons), env, "NewAsFunction::napi_get_reference_value");
-        CheckStatus(napi_new_instance(env, cons, 0, nullptr, &instance), env, "NewAsFunction::napi_new_instance");
+        napi_value instance;
+        CheckStatus(napi_new_instance(env, Constructor(env), 0, nullptr, &instance), env, "NewAsFunction::napi_new_instance");
 
         return instance;
     }
@@ -235,13 +413,15 @@ class NapiObjectWrap {
     /// \brief Instantiate class either using new or function() syntax. New T().
     /// \return this
     static napi_value New(napi_env env, napi_callback_info info) {
-        std::cout << "New" << std::endl;
-        return m_thisConstructor ? NewAsConstructor(env, info) : NewAsFunction(env, info);
+        NODE_RAND_LOG("New");
+        napi_value newTarget;
+        CheckStatus(napi_get_new_target(env, info, &newTarget), env, "New::napi_get_new_target");
+        return newTarget != nullptr ? NewAsConstructor(env, info) : NewAsFunction(env, info);
     }
 
     /// \brief Calls T->~Destructor()
     static void Destructor(napi_env env, void* nativeObject, void* /*finalize_hint*/) {
-        std::cout << "Destructor" << std::endl;
+        NODE_RAND_LOG("Destructor");
         delete reinterpret_cast<T*>(nativeObject);
     }
 
@@ -255,29 +435,47 @@ protected:
 
 public:
     virtual ~NapiObjectWrap() {
-        std::cout << "~NapiObjectWrap" << std::endl;
+        NODE_RAND_LOG("~NapiObjectWrap");
         napi_delete_reference(m_env, m_wrapper);
     }
 
+    /// \brief Create a JS instance from native code, same as new T() in JS
+    /// \param instance set to the wrapped native object
+    /// \return jsthis of the new instance
+    static napi_value NewInstance(napi_env env, T** instance) {
+        napi_value jsthis;
+        CheckStatus(napi_new_instance(env, Constructor(env), 0, nullptr, &jsthis), env, "NewInstance::napi_new_instance");
+        CheckStatus(napi_unwrap(env, jsthis, reinterpret_cast<void**>(instance)), env, "NewInstance::napi_unwrap");
+        return jsthis;
+    }
+
+    /// \brief value was created by this class, from JS or NewInstance
+    static bool IsInstance(napi_env env, napi_value value) {
+        bool result = false;
+        CheckStatus(napi_instanceof(env, value, Constructor(env), &result), env, "IsInstance::napi_instanceof");
+        return result;
+    }
+
     /// \brief Module init function
+    /// \param exports nullptr defines the class without exporting it, instances are made with NewInstance
     static napi_value Init(const std::string& className, napi_env env, napi_value exports) {
-        std::cout << "Init: " << std::endl;
+        NODE_RAND_LOG("Init: ");
 
         auto props = T::GetClassProps();
         auto NodeRandProps = props.data();
 
-        napi_value cons;
+        // stays null if the env is stopping (worker terminated while loading), later calls then fail with napi_invalid_arg
+        napi_value cons = nullptr;
         CheckStatus(napi_define_class(env, className.c_str(), NAPI_AUTO_LENGTH, New, nullptr, 
             props.size(), NodeRandProps, &cons), env, "Define class");
-        CheckStatus(napi_create_reference(env, cons, 1, &m_thisConstructor), env, "Create class reference");
-        CheckStatus(napi_set_named_property(env, exports, className.c_str(), cons), env, "Set ctor property");
+        NapiEnvData::Get(env).SetRef(NapiEnvData::Key<NapiObjectWrap<T>>(), cons);
+        if (exports != nullptr) {
+            CheckStatus(napi_set_named_property(env, exports, className.c_str(), cons), env, "Set ctor property");
+        }
 
         return exports;
     }
 };
 
-template<class T>
-napi_ref NapiObjectWrap<T>::m_thisConstructor;
-
 
 } // end napi_extensions namespace
@@ -0,0 +1,119 @@
+const { isMainThread } = require('worker_threads');
+
+// Int32 header fields of a shared ring, see RingHeader in NodeRandRing.h
+const HEAD = 0;
+const CLOSED = 1;
+const SLOTS = 2;
+const SLICE_SIZE = 3;
+const TYPE = 4;
+const DATA_OFFSET = 5;
+const WAIT = 6;
+const SEQUENCE = 16;
+
+// TypedArray of a napi_typedarray_type, the values of the Type enum
+const ARRAY_TYPES = [
+    Int8Array, Uint8Array, Uint8ClampedArray, Int16Array, Uint16Array, Int32Array, Uint32Array,
+    Float32Array, Float64Array, BigInt64Array, BigUint64Array
+];
+
+// backoff while the ring is drained, ms
+const DRAINED_WAIT = 0.05;
+
+/**
+ * Reads the numbers of rng.SharedRing(min, max, options) from any thread. Readers claim whole slots with
+ * Atomics and copy them out, no call into the addon. Every number is read by exactly one reader.
+ * A single reader reads the ring's sequence in order, several readers each get a share of its slots.
+ */
+class RingReader {
+    /**
+     * @param {SharedArrayBuffer} buffer ring.Buffer(), eg: posted to a Worker
+     */
+    constructor(buffer) {
+        const fields = new Int32Array(buffer, 0, SEQUENCE);
+        this.slots = Atomics.load(fields, SLOTS);
+        this.sliceSize = Atomics.load(fields, SLICE_SIZE);
+        this.header = new Int32Array(buffer, 0, SEQUENCE + this.slots);
+
+        const ArrayType = ARRAY_TYPES[Atomics.load(fields, TYPE)];
+        this.data = new ArrayType(buffer, Atomics.load(fields, DATA_OFFSET), this.slots * this.sliceSize);
+        this.slice = new ArrayType(this.sliceSize);
+        this.offset = this.sliceSize;
+        // Atomics.wait blocks, not allowed on the main thread
+        this.canWait = !isMainThread;
+    }
+
+    /**
+     * Next number, BigInt for BigInt64/BigUint64 rings
+     */
+    Next() {
+        if (this.offset === this.sliceSize) {
+            this._take(this.slice, 0);
+            this.offset = 0;
+        }
+        return this.slice[this.offset++];
+    }
+
+    /**
+     * Fill a TypedArray of the ring's type, continues where Next() stopped
+     * @returns the filled TypedArray
+     */
+    Fill(array) {
+        if (array.constructor !== this.slice.constructor) {
+            throw new TypeError(`Expecting a ${this.slice.constructor.name} to match the ring type`);
+        }
+
+        let filled = 0;
+        while (filled < array.length) {
+            if (this.offset === this.sliceSize && array.length - filled >= this.sliceSize) {
+                // whole slots straight into array
+                this._take(array, filled);
+                filled += this.sliceSize;
+                continue;
+            }
+            if (this.offset === this.sliceSize) {
+                this._take(this.slice, 0);
+                this.offset = 0;
+            }
+            const n = Math.min(this.sliceSize - this.offset, array.length - filled);
+            array.set(this.slice.subarray(this.offset, this.offset + n), filled);
+            this.offset += n;
+            filled += n;
+        }
+        return array;
+    }
+
+    /**
+     * Claim the next filled slot, copy it to out at offset and hand it back to the producer.
+     * Waits while the ring is drained, throws once it is drained and closed.
+     */
+    _take(out, offset) {
+        const header = this.header;
+        for (;;) {
+            const pos = Atomics.load(header, HEAD);
+            const slot = pos & (this.slots - 1);
+            const diff = (Atomics.load(header, SEQUENCE + slot) - ((pos + 1) | 0)) | 0;
+            if (diff === 0) {
+                if (Atomics.compareExchange(header, HEAD, pos, (pos + 1) | 0) !== pos) {
+                    continue;
+                }
+                const first = slot * this.sliceSize;
+                out.set(this.data.subarray(first, first + this.sliceSize), offset);
+                Atomics.store(header, SEQUENCE + slot, (pos + this.slots) | 0);
+                return;
+            }
+            if (diff < 0) {
+                // not produced yet. The producer sets closed after its last slot, look at the slot again
+                if (Atomics.load(header, CLOSED) === 1 &&
+                    ((Atomics.load(header, SEQUENCE + slot) - ((pos + 1) | 0)) | 0) < 0) {
+                    throw new Error('RandomRing is closed and drained');
+                }
+                if (this.canWait) {
+                    Atomics.wait(header, WAIT, 0, DRAINED_WAIT);
+                }
+            }
+            // diff > 0: another reader claimed pos, retry with the new head
+        }
+    }
+}
+
+exports.RingReader = RingReader;
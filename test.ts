@@ -26,4 +26,4 @@ console.log(rng.Generate(0, 10));
  // std_uniform_int_distribution.generate(std_mt19937)
  // std_uniform_int_distribution.generateSequence(std_m19937, 1000) // generator, count
 
- // TODO: Test Generate vs GenerateSequence speed
\ No newline at end of file
+ // Generate vs GenerateSequenceStream speed: npm run bench (bench/generate_into.bench.ts)
\ No newline at end of file
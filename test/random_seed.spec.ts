@@ -1,5 +1,10 @@
-import { NodeRand_mt19937 as NodeRand } from '../src'
+import { NodeRand_mt19937 as NodeRand, NodeRand_mt19937_64, NodeRand_philox4x32, NodeRand_threefry4x64, NodeRand_xoshiro256ss, NodeRand_pcg64, NodeRand_splitmix64, Type, AliasTable, RingReader, SetGeneratorThreads, GetGeneratorThreads } from '../src'
 import { Readable, Writable } from 'stream'
+import { Worker } from 'worker_threads'
+import fs = require('fs')
+import path = require('path')
+import v8 = require('v8')
+import vm = require('vm')
 
 import 'mocha'
 import chai = require('chai')
@@ -17,23 +22,30 @@ class TestWriteableStream extends Writable {
         super(options);
     }
     _write(chunk: any, encoding: any, callback: any) {
-        let d = new DataView(chunk.buffer)
+        // default stream type is BigInt64, little endian
+        let d = new DataView(chunk.buffer, chunk.byteOffset, chunk.byteLength)
         callback(null);
         
         for (let i = 0; i < d.byteLength; i+=8) {
-            let num = d.getInt32(i, true) + d.getInt32(i+4, true);
-
-            // TODO: WTH??? Why is this required???
-            if (num < 0) {
-                num += 1;
-            }
-            this.randNumbers.push(num);
+            this.randNumbers.push(Number(d.getBigInt64(i, true)));
         }
     }
     GetNumbers = () => this.randNumbers;
     ClearNumbers = () : void => { this.randNumbers = []; } 
 }
 
+// Collect a typed stream, chunks are tightly packed elements of the type
+let collect = (stream: Readable, ArrayType: any) => {
+    return new Promise<any[]>(resolve => {
+        let nums: any[] = [];
+        stream.on('data', (chunk: Uint8Array) => {
+            chai.expect(chunk.byteLength % ArrayType.BYTES_PER_ELEMENT).equal(0);
+            nums = nums.concat(Array.from(new ArrayType(chunk.buffer, chunk.byteOffset, chunk.byteLength / ArrayType.BYTES_PER_ELEMENT)));
+        });
+        stream.on('end', () => resolve(nums));
+    });
+}
+
 describe('Random Seed', () => {
 
     it('Check multiple instances with same seed', () => {
@@ -90,6 +102,146 @@ describe('Random Seed', () => {
         chai.expect(nums).eql(nums2);
     })
 
+    it('Check GenerateInto BigInt64Array should match sequence of Generate', () => {
+        const RangeToTest = 100;
+
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+
+        let nums: Number[] = [];
+        for (let i = 0; i < RangeToTest; i++) {
+            nums.push(a.Generate(TEST_MIN, TEST_MAX))
+        }
+
+        a.SetSeed(TEST_SEED);
+        let arr = new BigInt64Array(RangeToTest);
+        chai.expect(a.GenerateInto(arr, TEST_MIN, TEST_MAX)).equal(arr);
+        chai.expect(Array.from(arr, n => Number(n))).eql(nums);
+    })
+
+    it('Check GenerateIntoAsync should match sequence of GenerateSequenceStream', async () => {
+        const RangeToTest = 5000;
+
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+
+        let w = new TestWriteableStream({});
+        a.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest).pipe(w);
+        let nums: Number[] = await new Promise(resolve => w.on('finish', () => resolve(w.GetNumbers())));
+
+        a.SetSeed(TEST_SEED);
+        let arr = await a.GenerateIntoAsync(new BigInt64Array(RangeToTest), TEST_MIN, TEST_MAX);
+        chai.expect(Array.from(arr, n => Number(n))).eql(nums);
+    })
+
+    it('Check GenerateInto Int32Array/Float64Array bounds', () => {
+        let a = new NodeRand();
+
+        let ints = a.GenerateInto(new Int32Array(1000), TEST_MIN, TEST_MAX);
+        chai.expect(ints.every(n => n >= TEST_MIN && n <= TEST_MAX)).equal(true);
+
+        let doubles = a.GenerateInto(new Float64Array(1000), -0.5, 0.5);
+        chai.expect(doubles.every(n => n >= -0.5 && n < 0.5)).equal(true);
+
+        chai.expect(() => a.GenerateInto(new Int32Array(1), 0, Number.MAX_SAFE_INTEGER)).to.throw();
+        chai.expect(() => a.GenerateInto(new Int32Array(1), TEST_MAX, TEST_MIN)).to.throw();
+    })
+
+    it('Check UniformInt handle continues the Generate sequence', async () => {
+        const RangeToTest = 1000;
+
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+        let nums: Number[] = [];
+        for (let i = 0; i < RangeToTest; i++) {
+            nums.push(a.Generate(TEST_MIN, TEST_MAX));
+        }
+
+        a.SetSeed(TEST_SEED);
+        let d = a.UniformInt(TEST_MIN, TEST_MAX);
+        let nums2: Number[] = [];
+        for (let i = 0; i < RangeToTest / 2; i++) {
+            nums2.push(d.Next());
+        }
+        nums2 = nums2.concat(Array.from(d.Fill(new Int32Array(RangeToTest / 4))));
+        nums2 = nums2.concat(Array.from(d.Fill(new BigInt64Array(RangeToTest / 4)), n => Number(n)));
+        chai.expect(nums2).eql(nums);
+
+        // Stream matches GenerateSequenceStream
+        a.SetSeed(TEST_SEED);
+        let w1 = new TestWriteableStream({});
+        a.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest).pipe(w1);
+        let s1: Number[] = await new Promise(resolve => w1.on('finish', () => resolve(w1.GetNumbers())));
+
+        a.SetSeed(TEST_SEED);
+        let w2 = new TestWriteableStream({});
+        a.UniformInt(TEST_MIN, TEST_MAX).Stream(RangeToTest).pipe(w2);
+        let s2: Number[] = await new Promise(resolve => w2.on('finish', () => resolve(w2.GetNumbers())));
+        chai.expect(s2).eql(s1);
+
+        chai.expect(() => a.UniformInt(TEST_MAX, TEST_MIN)).to.throw();
+        chai.expect(() => a.UniformInt(0, Number.MAX_SAFE_INTEGER).Fill(new Int32Array(1))).to.throw();
+    })
+
+    it('Check parallel GenerateSequenceStream/GenerateInto/GenerateIntoAsync do not depend on thread count', async () => {
+        // spans several 65536 number blocks, last one short
+        const RangeToTest = 150000;
+
+        let a = new NodeRand();
+        let results: Number[][] = [];
+        for (let threads of [1, 2, 5]) {
+            a.SetSeed(TEST_SEED);
+            let w = new TestWriteableStream({});
+            a.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest, { threads }).pipe(w);
+            results.push(await new Promise(resolve => w.on('finish', () => resolve(w.GetNumbers()))));
+
+            a.SetSeed(TEST_SEED);
+            results.push(Array.from(a.GenerateInto(new BigInt64Array(RangeToTest), TEST_MIN, TEST_MAX, { threads }), n => Number(n)));
+
+            a.SetSeed(TEST_SEED);
+            results.push(Array.from(await a.GenerateIntoAsync(new BigInt64Array(RangeToTest), TEST_MIN, TEST_MAX, { threads }), n => Number(n)));
+        }
+
+        chai.expect(results[0].length).equal(RangeToTest);
+        for (let result of results) {
+            chai.expect(result).eql(results[0]);
+        }
+        chai.expect(() => a.GenerateInto(new Int32Array(1), TEST_MIN, TEST_MAX, { threads: 0 })).to.throw();
+    })
+
+    it('Check Fork and streamId streams do not depend on call order', async () => {
+        const RangeToTest = 100;
+
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+        let generate = (rng: NodeRand) => Array.from({ length: RangeToTest }, () => rng.Generate(TEST_MIN, TEST_MAX));
+        let forked = [3, 1, 2].map(id => generate(a.Fork(id)));
+        let nums = generate(a.Fork(1));
+        chai.expect(nums).eql(forked[1]);
+
+        // other calls on a in between, streams in reverse order
+        a.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest);
+        a.Generate(TEST_MIN, TEST_MAX);
+        let streams: Number[][] = [];
+        for (let streamId of [2, 1n]) {
+            let w = new TestWriteableStream({});
+            a.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest, { streamId }).pipe(w);
+            streams.push(await new Promise(resolve => w.on('finish', () => resolve(w.GetNumbers()))));
+        }
+        chai.expect(streams[1]).eql(nums);
+        chai.expect(streams[0]).not.eql(nums);
+
+        // forks of forks hash the path
+        let b = new NodeRand();
+        b.SetSeed(TEST_SEED);
+        chai.expect(b.Fork(1).Fork(2).Generate(TEST_MIN, TEST_MAX)).equal(a.Fork(1).Fork(2).Generate(TEST_MIN, TEST_MAX));
+        chai.expect(b.Fork(1).Fork(2).Generate(TEST_MIN, TEST_MAX)).not.equal(b.Fork(2).Fork(1).Generate(TEST_MIN, TEST_MAX));
+        chai.expect(forked[1]).not.eql(forked[0]);
+
+        chai.expect(() => a.Fork(-1)).to.throw();
+        chai.expect(() => a.GenerateSequenceStream(TEST_MIN, TEST_MAX, 1, { streamId: -1 })).to.throw();
+    })
+
     it('Check 3 generate streams of size 1000, same seed, triggered in parallel, should be equal', async () => {
 
         const RangeToTest = 1000;
@@ -189,6 +341,132 @@ describe('Random Seed', () => {
         chai.expect(p1).eql(p2);
     })
 
+    it('Check GenerateSequenceStream chunkSize/adaptive options do not change the sequence', async () => {
+        const RangeToTest = 20000;
+
+        let r1 = new NodeRand();
+
+        let promiseWrapper = (r: any, options?: any) => {
+            return new Promise<Number[]>(resolve => {
+                let w = new TestWriteableStream({});
+                r.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest, options).pipe(w);
+                w.on('finish', () => resolve(w.GetNumbers()));
+            })
+        }
+
+        r1.SetSeed(TEST_SEED);
+        let expected = await promiseWrapper(r1);
+
+        for (let options of [{ chunkSize: 1 }, { chunkSize: 7777 }, { chunkSize: 50000, highWaterMark: 1024 * 1024 }, { adaptive: true }]) {
+            r1.SetSeed(TEST_SEED);
+            chai.expect(await promiseWrapper(r1, options)).eql(expected);
+        }
+
+        chai.expect(() => r1.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest, { chunkSize: 0 })).to.throw();
+    })
+
+    it('Check adaptive GenerateSequenceStream grows its chunks for a fast consumer', async () => {
+        const InitialChunkBytes = 2000 * 8;
+
+        let r1 = new NodeRand();
+        let readableStream: Readable = r1.GenerateSequenceStream(TEST_MIN, TEST_MAX, 4000000000, { adaptive: true });
+
+        let largest = 0;
+        readableStream.on('data', (chunk: Uint8Array) => { largest = Math.max(largest, chunk.byteLength); });
+        await new Promise(resolve => setTimeout(resolve, 500));
+        readableStream.destroy();
+
+        chai.expect(largest).gt(InitialChunkBytes);
+        // half the default adaptive highWaterMark
+        chai.expect(largest).lte(readableStream.readableHighWaterMark / 2);
+    })
+
+    it('Check GenerateSequenceStream honors backpressure from a slow consumer', async () => {
+        const RangeToTest = 4000000000;
+        const BytesPerChunk = 2000 * 8;
+
+        let r1 = new NodeRand();
+        let readableStream: Readable = r1.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest);
+
+        let consumed = 0;
+        let slow = new Writable({
+            highWaterMark: BytesPerChunk,
+            write(chunk: any, encoding: any, callback: any) {
+                consumed += chunk.length;
+                setTimeout(callback, 5);
+            }
+        });
+        readableStream.pipe(slow);
+
+        await new Promise(resolve => setTimeout(resolve, 500));
+
+        // Readable buffer stays around highWaterMark instead of holding the whole sequence
+        chai.expect(consumed).gt(0);
+        chai.expect(readableStream.readableLength).lte(readableStream.readableHighWaterMark + 4 * BytesPerChunk);
+
+        readableStream.unpipe(slow);
+        readableStream.destroy();
+    })
+
+    it('Check destroy() stops the generator thread of GenerateSequenceStream', async () => {
+        const RangeToTest = 4000000000;
+
+        for (const options of [{}, { threads: 4 }]) {
+            let r1 = new NodeRand();
+            let readableStream: Readable = r1.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest, options);
+            let closed = new Promise(resolve => readableStream.on('close', resolve));
+            // paused after the first chunk, the worker fills the queue and blocks
+            readableStream.once('data', () => {
+                readableStream.pause();
+                setTimeout(() => readableStream.destroy(), 50);
+            });
+            await closed;
+
+            await new Promise(resolve => setTimeout(resolve, 100));
+            let generated = r1.GetStats().valuesGenerated;
+            await new Promise(resolve => setTimeout(resolve, 100));
+            let stats = r1.GetStats();
+            chai.expect(stats.valuesGenerated).equal(generated);
+            chai.expect(stats.valuesGenerated).lt(RangeToTest);
+            // queued chunks were freed without being pushed
+            chai.expect(stats.queueDepth).equal(0);
+        }
+    })
+
+    it('Check unread and paused GenerateSequenceStreams are garbage collected', async () => {
+        // mocha does not run node with --expose-gc
+        v8.setFlagsFromString('--expose-gc');
+        const gc: () => void = (global as any).gc || vm.runInNewContext('gc');
+        const Unread = 200;
+        const Paused = 50;
+
+        let finalized = 0;
+        const registry = new (global as any).FinalizationRegistry(() => finalized++);
+        let r1 = new NodeRand();
+        for (let i = 0; i < Unread; i++) {
+            registry.register(r1.GenerateSequenceStream(TEST_MIN, TEST_MAX, 100), i);
+        }
+        for (let i = 0; i < Paused; i++) {
+            let readableStream: Readable = r1.GenerateSequenceStream(TEST_MIN, TEST_MAX, 4000000000, i % 2 ? { threads: 2 } : {});
+            registry.register(readableStream, i);
+            await new Promise(resolve => readableStream.once('data', resolve));
+            readableStream.pause();
+        }
+
+        for (let i = 0; i < 20 && finalized < Unread + Paused; i++) {
+            await new Promise(resolve => setTimeout(resolve, 50));
+            gc();
+        }
+        chai.expect(finalized).equal(Unread + Paused);
+
+        // their production runs stopped and queued chunks were freed
+        await new Promise(resolve => setTimeout(resolve, 100));
+        let generated = r1.GetStats().valuesGenerated;
+        await new Promise(resolve => setTimeout(resolve, 100));
+        chai.expect(r1.GetStats().valuesGenerated).equal(generated);
+        chai.expect(r1.GetStats().queueDepth).equal(0);
+    }).timeout(20000)
+
     it('Check Number.MIN_SAFE_INTEGER <= number <= Number.MAX_SAFE_INTEGER', async () => {
         let r1 = new NodeRand();
 
@@ -276,8 +554,676 @@ describe('Random Seed', () => {
 
         chai.expect(p1).not.eq(p2);
     })
-    
-    // TODO: Add these tests in future when implemented (TDD style)
-    // 1. Test everything here, but with different types, BigInt64, Int64 (MAX_JS_NUMBER), uint32/int32, uint16/int16, uint8/int8, double
-    
-})
\ No newline at end of file
+
+    it('Check GetStats counts values, chunks and pseudo seeds', async () => {
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+        let stats = a.GetStats();
+        if (!stats.enabled) {
+            // built with -Dnode_rand_stats=0
+            chai.expect(stats.valuesGenerated).equal(0);
+            return;
+        }
+        chai.expect(stats.valuesGenerated).equal(0);
+
+        a.Generate(TEST_MIN, TEST_MAX);
+        a.GenerateInto(new Int32Array(100), TEST_MIN, TEST_MAX);
+        a.UniformInt(TEST_MIN, TEST_MAX).Fill(new BigInt64Array(10));
+        let nums = await collect(a.GenerateSequenceStream(TEST_MIN, TEST_MAX, 5000, { chunkSize: 1000 }), BigInt64Array);
+        chai.expect(nums.length).equal(5000);
+
+        stats = a.GetStats();
+        chai.expect(stats.valuesGenerated).equal(1 + 100 + 10 + 5000);
+        chai.expect(stats.chunksPushed).equal(5);
+        chai.expect(stats.queueDepth).equal(0);
+        chai.expect(stats.maxQueueDepth).least(1);
+        // reseed after SetSeed, then the stream
+        chai.expect(stats.seedRefills).equal(2);
+        chai.expect(stats.chunkGenerateNs.count).equal(5);
+        chai.expect(stats.chunkPushNs.count).equal(5);
+        chai.expect(stats.chunkPushNs.p50).within(stats.chunkPushNs.min, stats.chunkPushNs.max);
+        chai.expect(stats.chunkPushNs.p999).most(stats.chunkPushNs.max);
+
+        // forks count on their own
+        chai.expect(a.Fork(1).GetStats().valuesGenerated).equal(0);
+    })
+
+    it('Check GenerateBatches should match sequence of GenerateSequenceStream', async () => {
+        const RangeToTest = 20000;
+
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+        let nums = await collect(a.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest, { type: Type.Int32 }), Int32Array);
+
+        // async iterator, batches of chunkSize
+        a.SetSeed(TEST_SEED);
+        let iterated: number[] = [];
+        for await (const batch of a.GenerateBatches(TEST_MIN, TEST_MAX, RangeToTest, { type: Type.Int32, chunkSize: 3000 })) {
+            chai.expect(batch).instanceOf(Int32Array);
+            iterated = iterated.concat(Array.from(batch as Int32Array));
+        }
+        chai.expect(iterated).eql(nums);
+
+        // concurrent NextBatch calls resolve in call order, small batches are filled synchronously
+        a.SetSeed(TEST_SEED);
+        let batches = a.GenerateBatches(TEST_MIN, TEST_MAX, RangeToTest, { type: Type.Int32 });
+        let pending = [batches.NextBatch(10), batches.NextBatch(15000), batches.NextBatch(5), batches.NextBatch(RangeToTest)];
+        chai.expect(batches.Remaining()).equal(0);
+        let results = await Promise.all(pending);
+        chai.expect(results.map(batch => batch!.length)).eql([10, 15000, 5, RangeToTest - 15015]);
+        chai.expect(([] as number[]).concat(...results.map(batch => Array.from(batch as Int32Array)))).eql(nums);
+        chai.expect(await batches.NextBatch()).equal(null);
+
+        chai.expect(() => batches.NextBatch(0)).to.throw(RangeError);
+        chai.expect(() => a.GenerateBatches(TEST_MIN, TEST_MAX, 10, { threads: 2 })).to.throw(RangeError);
+    })
+
+})
+
+describe('Types', () => {
+
+    const Arrays: { [name: string]: any } = { Int8: Int8Array, Uint8: Uint8Array, Int16: Int16Array, Uint16: Uint16Array, Int32: Int32Array, Uint32: Uint32Array,
+        BigInt64: BigInt64Array, BigUint64: BigUint64Array };
+
+    for (let [name, ArrayType] of Object.entries(Arrays)) {
+        it(`Check ${name} Generate, GenerateInto and GenerateSequenceStream match`, async () => {
+            const RangeToTest = 1000;
+            const type = (Type as any)[name];
+            const big = name.startsWith('Big');
+            const min = big ? BigInt(3) : 3;
+            const max = big ? BigInt(120) : 120;
+
+            let a = new NodeRand();
+            a.SetSeed(TEST_SEED);
+            let nums: any[] = [];
+            for (let i = 0; i < RangeToTest; i++) {
+                nums.push(a.Generate(min, max, type));
+            }
+            chai.expect(typeof nums[0]).equal(big ? 'bigint' : 'number');
+
+            a.SetSeed(TEST_SEED);
+            chai.expect(Array.from(a.GenerateInto(new ArrayType(RangeToTest), min, max))).eql(nums);
+
+            for (let options of [{ type }, { type, chunkSize: 7 }]) {
+                a.SetSeed(TEST_SEED);
+                chai.expect(await collect(a.GenerateSequenceStream(min, max, RangeToTest, options), ArrayType)).eql(nums);
+            }
+
+            // same range, same numbers as the untyped Generate
+            a.SetSeed(TEST_SEED);
+            let untyped: number[] = [];
+            for (let i = 0; i < RangeToTest; i++) {
+                untyped.push(a.Generate(3, 120));
+            }
+            chai.expect(nums.map(n => Number(n))).eql(untyped);
+        })
+    }
+
+    it('Check 64 bit types return BigInt beyond Number.MAX_SAFE_INTEGER', () => {
+        let a = new NodeRand();
+        const top = BigInt('18446744073709551615');
+        chai.expect(a.Generate(top, top, Type.BigUint64)).equal(top);
+        chai.expect(a.Generate(-BigInt('9223372036854775808'), -BigInt('9223372036854775808'), Type.BigInt64)).equal(-BigInt('9223372036854775808'));
+
+        let arr = a.GenerateInto(new BigUint64Array(1000), top - BigInt(10), top);
+        chai.expect(arr.every(n => n >= top - BigInt(10))).equal(true);
+    })
+
+    for (let [name, ArrayType] of [['Float32', Float32Array], ['Float64', Float64Array]] as [string, any][]) {
+        it(`Check ${name} Generate, GenerateInto and GenerateSequenceStream match`, async () => {
+            const RangeToTest = 1000;
+            const type = (Type as any)[name];
+            let a = new NodeRand_philox4x32();
+            a.SetSeed(TEST_SEED);
+            let nums: number[] = [];
+            for (let i = 0; i < RangeToTest; i++) {
+                nums.push(a.Generate(-0.5, 0.5, type));
+            }
+            chai.expect(nums.every(n => n >= -0.5 && n < 0.5)).equal(true);
+            chai.expect(Array.from(ArrayType.from(nums))).eql(nums);
+
+            // batched conversion gives the same numbers
+            a.SetSeed(TEST_SEED);
+            chai.expect(Array.from(a.GenerateInto(new ArrayType(RangeToTest), -0.5, 0.5))).eql(nums);
+            a.SetSeed(TEST_SEED);
+            chai.expect(await collect(a.GenerateSequenceStream(-0.5, 0.5, RangeToTest, { type, chunkSize: 7 }), ArrayType)).eql(nums);
+        })
+    }
+
+    it('Check float ranges', () => {
+        let a = new NodeRand();
+        chai.expect(a.Generate(2.5, 2.5, Type.Float64)).equal(2.5);
+        let wide = a.GenerateInto(new Float64Array(1000), -Number.MAX_VALUE, Number.MAX_VALUE);
+        chai.expect(wide.every(n => Number.isFinite(n))).equal(true);
+        chai.expect(() => a.Generate(0, Infinity, Type.Float64)).to.throw();
+        chai.expect(() => a.Generate(0, 1e39, Type.Float32)).to.throw();
+    })
+
+    it('Check typed min/max must fit in the type', () => {
+        let a = new NodeRand();
+        chai.expect(() => a.Generate(-1, 5, Type.Uint8)).to.throw();
+        chai.expect(() => a.Generate(0, 256, Type.Uint8)).to.throw();
+        chai.expect(() => a.Generate(5, 1, Type.Int8)).to.throw();
+        chai.expect(() => a.Generate(0, 1, 99 as Type)).to.throw();
+        chai.expect(() => a.GenerateInto(new Int16Array(1), 0, 40000)).to.throw();
+        chai.expect(() => a.GenerateSequenceStream(0, 300, 10, { type: Type.Uint8 })).to.throw();
+
+        // UniformInt handles fill any integer array the range fits in
+        a.SetSeed(TEST_SEED);
+        let nums: Number[] = [];
+        for (let i = 0; i < 100; i++) {
+            nums.push(a.Generate(TEST_MIN / 10, TEST_MAX / 10));
+        }
+        a.SetSeed(TEST_SEED);
+        chai.expect(Array.from(a.UniformInt(TEST_MIN / 10, TEST_MAX / 10).Fill(new Int8Array(100)))).eql(nums);
+        chai.expect(() => a.UniformInt(-1, 5).Fill(new Uint8Array(1))).to.throw();
+    })
+})
+
+describe('Distributions', () => {
+
+    // name, parameters, expected mean, stream element type
+    const Distributions: [string, any[], number, any][] = [
+        ['Normal', [2, 3], 2, Float64Array],
+        ['LogNormal', [0, 0.5], Math.exp(0.125), Float64Array],
+        ['Exponential', [2], 0.5, Float64Array],
+        ['Gamma', [0.5, 2], 1, Float64Array],
+        ['Poisson', [3.5], 3.5, BigInt64Array],
+        ['Poisson', [250], 250, BigInt64Array],
+        ['Binomial', [20, 0.3], 6, BigInt64Array],
+        ['Binomial', [1000, 0.8], 800, BigInt64Array],
+        ['Discrete', [[1, 0, 3, 6]], 2.4, Uint32Array]
+    ];
+
+    for (let [name, params, mean, StreamArray] of Distributions) {
+        const integer = StreamArray !== Float64Array;
+        it(`Check ${name}(${params}) Next, Fill and Stream match`, async () => {
+            const RangeToTest = 100000;
+
+            let a = new NodeRand_xoshiro256ss();
+            a.SetSeed(TEST_SEED);
+            let d = (a as any)[name](...params);
+            let nums: number[] = [];
+            for (let i = 0; i < 1000; i++) {
+                nums.push(d.Next());
+            }
+
+            a.SetSeed(TEST_SEED);
+            let filled = (a as any)[name](...params).Fill(new Float64Array(RangeToTest));
+            chai.expect(Array.from(filled.subarray(0, 1000))).eql(nums);
+
+            a.SetSeed(TEST_SEED);
+            let streamed = await collect((a as any)[name](...params).Stream(RangeToTest, { chunkSize: 777 }), StreamArray);
+            chai.expect(streamed.map(n => Number(n))).eql(Array.from(filled));
+
+            let sampleMean = filled.reduce((sum: number, n: number) => sum + n, 0) / RangeToTest;
+            chai.expect(sampleMean).closeTo(mean, mean * 0.02);
+            if (integer) {
+                chai.expect(filled.every((n: number) => Number.isInteger(n) && n >= 0)).equal(true);
+            }
+        })
+    }
+
+    it('Check distribution parameters are validated', () => {
+        let a = new NodeRand();
+        chai.expect(() => a.Normal(0, 0)).to.throw(RangeError);
+        chai.expect(() => a.LogNormal(NaN, 1)).to.throw(RangeError);
+        chai.expect(() => a.Exponential(-1)).to.throw(RangeError);
+        chai.expect(() => a.Gamma(0, 1)).to.throw(RangeError);
+        chai.expect(() => a.Poisson(-1)).to.throw(RangeError);
+        chai.expect(() => a.Binomial(10.5, 0.5)).to.throw(RangeError);
+        chai.expect(() => a.Binomial(10, 1.5)).to.throw(RangeError);
+        chai.expect(() => a.Discrete([])).to.throw(RangeError);
+        chai.expect(() => a.Discrete([0, 0])).to.throw(RangeError);
+        chai.expect(() => a.Discrete([1, -1])).to.throw(RangeError);
+
+        chai.expect(() => a.Normal(0, 1).Fill(new Int32Array(1))).to.throw(TypeError);
+        chai.expect(() => a.Poisson(5).Fill(new Int32Array(1))).to.throw(TypeError);
+        chai.expect(Array.from(a.Binomial(200, 0.5).Fill(new Uint8Array(100))).every(n => n <= 200)).equal(true);
+        chai.expect(Array.from(a.Discrete(new Float64Array([0, 2, 0])).Fill(new Int8Array(100))).every(n => n == 1)).equal(true);
+    })
+
+    it('Check AliasTable is shared between instances without rebuilding', () => {
+        const RangeToTest = 10000;
+        let table = AliasTable.Build([1, 0, 3, 6]);
+        chai.expect(table.Size()).equal(4);
+
+        let a = new NodeRand_xoshiro256ss();
+        let b = new NodeRand_xoshiro256ss();
+        a.SetSeed(TEST_SEED);
+        b.SetSeed(TEST_SEED);
+        let nums = a.Discrete(table).Fill(new Uint32Array(RangeToTest));
+        chai.expect(b.Discrete([1, 0, 3, 6]).Fill(new Uint32Array(RangeToTest))).eql(nums);
+        chai.expect(nums.includes(1)).equal(false);
+
+        // same table attached by id, as a worker thread would
+        let attached = AliasTable.FromId(table.Id());
+        chai.expect(attached.Id()).equal(table.Id());
+        b.SetSeed(TEST_SEED);
+        chai.expect(b.Discrete(attached).Fill(new Uint32Array(RangeToTest))).eql(nums);
+
+        chai.expect(() => AliasTable.FromId(0)).to.throw(RangeError);
+        chai.expect(() => AliasTable.Build([0, 0])).to.throw(RangeError);
+        chai.expect(() => new AliasTable().Size()).to.throw(Error);
+    })
+})
+
+describe('Shuffle', () => {
+
+    let isPermutation = (array: Uint32Array, n: number) => {
+        let sorted = Array.from(array).sort((a, b) => a - b);
+        return array.length == n && sorted.every((x, i) => x == i);
+    }
+
+    it('Check Permutation matches Shuffle and is reproducible', () => {
+        const RangeToTest = 10000;
+        let a = new NodeRand_xoshiro256ss();
+        a.SetSeed(TEST_SEED);
+        let perm = a.Permutation(RangeToTest);
+        chai.expect(isPermutation(perm, RangeToTest)).equal(true);
+
+        a.SetSeed(TEST_SEED);
+        chai.expect(a.Shuffle(Uint32Array.from({ length: RangeToTest }, (_, i) => i))).eql(perm);
+
+        let shuffled = a.Shuffle(Float64Array.from(perm));
+        chai.expect(Array.from(shuffled).sort((x, y) => x - y)).eql(Array.from({ length: RangeToTest }, (_, i) => i));
+    })
+
+    it('Check parallel Shuffle does not depend on thread count', () => {
+        const RangeToTest = 300000;
+        let a = new NodeRand_pcg64();
+        let results: Uint32Array[] = [];
+        for (let threads of [1, 3, 8]) {
+            a.SetSeed(TEST_SEED);
+            results.push(a.Permutation(RangeToTest, { threads }));
+        }
+        chai.expect(isPermutation(results[0], RangeToTest)).equal(true);
+        chai.expect(results[1]).eql(results[0]);
+        chai.expect(results[2]).eql(results[0]);
+    })
+
+    it('Check SampleWithoutReplacement sparse and dense samples agree', () => {
+        let a = new NodeRand();
+        // k < n / 16 uses the hash map, k >= n / 16 the index array. Both are prefixes of the same partial shuffle
+        a.SetSeed(TEST_SEED);
+        let sparse = a.SampleWithoutReplacement(16000, 999);
+        a.SetSeed(TEST_SEED);
+        let dense = a.SampleWithoutReplacement(16000, 16000);
+        chai.expect(isPermutation(dense, 16000)).equal(true);
+        chai.expect(sparse).eql(dense.subarray(0, 999));
+
+        chai.expect(new Set(a.SampleWithoutReplacement(2 ** 32, 10000)).size).equal(10000);
+        chai.expect(() => a.SampleWithoutReplacement(10, 11)).to.throw(RangeError);
+        chai.expect(() => a.Permutation(1.5)).to.throw(RangeError);
+    })
+})
+
+describe('Worker threads', () => {
+
+    // each worker loads the addon into its own env, generates from seed and reports the numbers
+    const WorkerScript = `
+        const { parentPort, workerData } = require('worker_threads');
+        const { NodeRand_mt19937, AliasTable } = require(workerData.addon);
+        const rng = new NodeRand_mt19937();
+        rng.SetSeed(workerData.seed);
+        const into = Array.from(rng.GenerateInto(new BigInt64Array(workerData.count), -1000, 1000), Number);
+        const discrete = Array.from(rng.Discrete(AliasTable.FromId(workerData.table)).Fill(new Uint32Array(100)));
+        const streamed = [];
+        rng.GenerateSequenceStream(-1000, 1000, workerData.count, { streamId: workerData.seed, threads: 2 })
+            .on('data', chunk => streamed.push(...Array.from(new BigInt64Array(chunk.buffer.slice(chunk.byteOffset, chunk.byteOffset + chunk.byteLength)), Number)))
+            .on('end', () => parentPort.postMessage({ into, discrete, streamed }));
+    `;
+
+    let runWorker = (seed: number, count: number, table: number) => new Promise<any>((resolve, reject) => {
+        const worker = new Worker(WorkerScript, { eval: true, workerData: { addon: path.join(__dirname, '../src'), seed, count, table } });
+        worker.on('message', resolve);
+        worker.on('error', reject);
+    });
+
+    it('Check N workers generating at the same time match the main thread', async () => {
+        const Workers = 4;
+        const RangeToTest = 100000;
+        const table = AliasTable.Build([1, 0, 3, 6]);
+
+        // twice, workers of the second round load the addon after the first ones were torn down
+        for (let round = 0; round < 2; round++) {
+            let results = await Promise.all(Array.from({ length: Workers }, (_, seed) => runWorker(seed, RangeToTest, table.Id())));
+
+            for (let seed = 0; seed < Workers; seed++) {
+                let a = new NodeRand();
+                a.SetSeed(seed);
+                chai.expect(results[seed].into).eql(Array.from(a.GenerateInto(new BigInt64Array(RangeToTest), TEST_MIN, TEST_MAX), n => Number(n)));
+                chai.expect(results[seed].discrete).eql(Array.from(a.Discrete(table).Fill(new Uint32Array(100))));
+                let streamed = Array.from(a.Fork(seed).GenerateInto(new BigInt64Array(RangeToTest), TEST_MIN, TEST_MAX, { threads: 1 }), n => Number(n));
+                chai.expect(results[seed].streamed).eql(streamed);
+            }
+            chai.expect(results[1].into).not.eql(results[0].into);
+        }
+    }).timeout(20000)
+
+    it('Check SharedRing readers share the stream sequence across workers', async () => {
+        const Workers = 3;
+        const SliceSize = 256;
+        const Count = SliceSize * 40;
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+
+        // one reader, small ring: wraps around and refills many times, same numbers as the stream of the fork
+        let ring = a.SharedRing(TEST_MIN, TEST_MAX, { slots: 4, sliceSize: 64, lowWater: 1, streamId: 1 });
+        let reader = new RingReader(ring.Buffer());
+        let read = new BigInt64Array(Count + 3);
+        read[0] = reader.Next() as bigint;
+        reader.Fill(read.subarray(1));
+        chai.expect(Array.from(read)).eql(Array.from(a.Fork(1).GenerateInto(new BigInt64Array(Count + 3), TEST_MIN, TEST_MAX)));
+        ring.Close();
+        chai.expect(() => { for (;;) reader.Fill(new BigInt64Array(64)); }).to.throw('closed');
+
+        // workers claim disjoint slots, together they read the first Workers * Count numbers
+        ring = a.SharedRing(0, 1e9, { type: Type.Uint32, slots: 8, sliceSize: SliceSize, streamId: 2 });
+        let results = await Promise.all(Array.from({ length: Workers }, () => new Promise<Uint32Array>((resolve, reject) => {
+            const worker = new Worker(`
+                const { parentPort, workerData } = require('worker_threads');
+                const { RingReader } = require(workerData.addon);
+                parentPort.postMessage(new RingReader(workerData.buffer).Fill(new Uint32Array(workerData.count)));
+            `, { eval: true, workerData: { addon: path.join(__dirname, '../src'), buffer: ring.Buffer(), count: Count } });
+            worker.on('message', resolve);
+            worker.on('error', reject);
+        })));
+        ring.Close();
+
+        let all = results.flatMap(r => Array.from(r)).sort((x, y) => x - y);
+        let expected = Array.from(a.Fork(2).GenerateInto(new Uint32Array(Workers * Count), 0, 1e9)).sort((x, y) => x - y);
+        chai.expect(all).eql(expected);
+    }).timeout(20000)
+
+    it('Check terminating a worker with running streams', async () => {
+        const worker = new Worker(`
+            const { parentPort, workerData } = require('worker_threads');
+            const rng = new (require(workerData.addon).NodeRand_mt19937)();
+            rng.GenerateSequenceStream(0, 100, 4e9).on('data', () => {});
+            rng.GenerateSequenceStream(0, 100, 4e9, { threads: 2 }).on('data', () => parentPort.postMessage('data'));
+        `, { eval: true, workerData: { addon: path.join(__dirname, '../src') } });
+        await new Promise(resolve => worker.once('message', resolve));
+        await worker.terminate();
+
+        // addon still usable on this thread
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+        chai.expect(a.Generate(TEST_MIN, TEST_MAX)).to.be.a('number');
+    }).timeout(20000)
+})
+
+describe('Generator pool', () => {
+
+    // streams created while the pool is enabled produce on it
+    let onPool = async <R>(threads: number, fn: () => Promise<R>) => {
+        SetGeneratorThreads(threads);
+        try {
+            return await fn();
+        }
+        finally {
+            SetGeneratorThreads(0);
+        }
+    }
+
+    let streamAll = (a: any) => Promise.all([
+        collect(a.GenerateSequenceStream(TEST_MIN, TEST_MAX, 50000, { chunkSize: 100, highWaterMark: 800 }), BigInt64Array),
+        collect(a.GenerateSequenceStream(TEST_MIN, TEST_MAX, 50000, { adaptive: true, type: Type.Int16 }), Int16Array),
+        collect(a.GenerateSequenceStream(TEST_MIN, TEST_MAX, 300000, { threads: 2 }), BigInt64Array),
+        collect(a.Normal(0, 1).Stream(20000), Float64Array)
+    ]);
+
+    it('Check streams on the generator pool match the libuv threadpool', async () => {
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+        let expected = await streamAll(a);
+
+        a.SetSeed(TEST_SEED);
+        let nums = await onPool(3, () => {
+            chai.expect(GetGeneratorThreads()).equal(3);
+            return streamAll(a);
+        });
+        chai.expect(nums).eql(expected);
+        chai.expect(GetGeneratorThreads()).equal(0);
+        chai.expect(() => SetGeneratorThreads(257)).to.throw(RangeError);
+    }).timeout(20000)
+
+    it('Check fs latency stays flat while 16 large streams run on the generator pool', async () => {
+        const Streams = 16;
+        let median = (ms: number[]) => ms.slice().sort((x, y) => x - y)[ms.length >> 1];
+        // Linux only, threads of the process
+        let threadCount = () => fs.existsSync('/proc/self/task') ? fs.readdirSync('/proc/self/task').length : 0;
+        let statLatency = async () => {
+            let ms: number[] = [];
+            for (let i = 0; i < 50; i++) {
+                const start = process.hrtime.bigint();
+                await fs.promises.stat(__filename);
+                ms.push(Number(process.hrtime.bigint() - start) / 1e6);
+            }
+            return median(ms);
+        }
+
+        let idle = await statLatency();
+        let [loaded, bytes] = await onPool(2, async () => {
+            // long lived runs of the libuv threadpool would hold all 4 of its threads, fs calls would wait for them to end
+            let a = new NodeRand();
+            let bytes = new Array(Streams).fill(0);
+            let streams: Readable[] = [];
+            const baseline = threadCount();
+            let maxThreads = baseline;
+            for (let i = 0; i < Streams; i++) {
+                // the last stream generates its blocks on the pool threads too
+                let options = i + 1 < Streams ? { chunkSize: 65536 } : { threads: 4 };
+                let s = a.GenerateSequenceStream(TEST_MIN, TEST_MAX, 4000000000, options);
+                s.on('data', (chunk: Uint8Array) => {
+                    bytes[i] += chunk.byteLength;
+                    maxThreads = Math.max(maxThreads, threadCount());
+                });
+                streams.push(s);
+            }
+            await new Promise(resolve => setTimeout(resolve, 100));
+            let loaded = await statLatency();
+            streams.forEach(s => s.destroy());
+            chai.expect(maxThreads).equal(baseline);
+            return [loaded, bytes];
+        });
+
+        chai.expect(loaded).lt(idle * 10 + 5);
+        // every stream gets a chunk in turn, a round of the threads stream is 4 blocks
+        let chunked = bytes.slice(0, Streams - 1);
+        chai.expect(Math.min(...chunked)).gt(0);
+        chai.expect(Math.min(...chunked) * 4).gte(Math.max(...chunked));
+        chai.expect(bytes[Streams - 1]).gt(0);
+    }).timeout(20000)
+
+    it('Check every stream keeps producing after the generator pool shrinks', async () => {
+        const Streams = 4;
+        let bytes = await onPool(Streams, async () => {
+            let a = new NodeRand();
+            let bytes = new Array(Streams).fill(0);
+            let streams: Readable[] = [];
+            for (let i = 0; i < Streams; i++) {
+                let s = a.GenerateSequenceStream(TEST_MIN, TEST_MAX, 4000000000);
+                s.on('data', (chunk: Uint8Array) => { bytes[i] += chunk.byteLength; });
+                streams.push(s);
+            }
+            await new Promise(resolve => setTimeout(resolve, 100));
+
+            // the streams of the 3 removed threads move to the remaining one
+            SetGeneratorThreads(1);
+            bytes.fill(0);
+            await new Promise(resolve => setTimeout(resolve, 500));
+            let shrunk = bytes.slice();
+            streams.forEach(s => s.destroy());
+            return shrunk;
+        });
+
+        chai.expect(Math.min(...bytes)).gt(0);
+        chai.expect(Math.min(...bytes) * 4).gte(Math.max(...bytes));
+    }).timeout(20000)
+
+    it('Check terminating a worker with streams on the generator pool', async () => {
+        await onPool(2, async () => {
+            const worker = new Worker(`
+                const { parentPort, workerData } = require('worker_threads');
+                const rng = new (require(workerData.addon).NodeRand_mt19937)();
+                rng.GenerateSequenceStream(0, 100, 4e9).on('data', () => {});
+                const paused = rng.GenerateSequenceStream(0, 100, 4e9);
+                paused.once('data', () => paused.pause());
+                rng.GenerateSequenceStream(0, 100, 4e9, { threads: 2 }).on('data', () => parentPort.postMessage('data'));
+            `, { eval: true, workerData: { addon: path.join(__dirname, '../src') } });
+            await new Promise(resolve => worker.once('message', resolve));
+            await worker.terminate();
+        });
+
+        let a = new NodeRand();
+        a.SetSeed(TEST_SEED);
+        chai.expect(a.Generate(TEST_MIN, TEST_MAX)).to.be.a('number');
+    }).timeout(20000)
+})
+
+describe('Engines', () => {
+
+    const Engines = { NodeRand_mt19937: NodeRand, NodeRand_mt19937_64, NodeRand_philox4x32, NodeRand_threefry4x64, NodeRand_xoshiro256ss, NodeRand_pcg64, NodeRand_splitmix64 };
+
+    for (let [name, Engine] of Object.entries(Engines)) {
+        it(`Check ${name} Generate, GenerateInto and GenerateSequenceStream are reproducible from a seed`, async () => {
+            const RangeToTest = 5000;
+
+            let a = new Engine();
+            let b = new Engine();
+            a.SetSeed(TEST_SEED);
+            b.SetSeed(TEST_SEED);
+
+            let nums: Number[] = [];
+            for (let i = 0; i < RangeToTest; i++) {
+                nums.push(a.Generate(TEST_MIN, TEST_MAX));
+            }
+
+            let arr = b.GenerateInto(new BigInt64Array(RangeToTest), TEST_MIN, TEST_MAX);
+            chai.expect(Array.from(arr, n => Number(n))).eql(nums);
+
+            a.SetSeed(TEST_SEED);
+            let w = new TestWriteableStream({});
+            a.GenerateSequenceStream(TEST_MIN, TEST_MAX, RangeToTest).pipe(w);
+            let nums2: Number[] = await new Promise(resolve => w.on('finish', () => resolve(w.GetNumbers())));
+            chai.expect(nums2).eql(nums);
+
+            a.SetSeed(TEST_SEED + 1);
+            chai.expect(a.GenerateInto(new BigInt64Array(RangeToTest), TEST_MIN, TEST_MAX)).not.eql(arr);
+        })
+    }
+
+    it('Check Advance(n) matches generating n numbers', () => {
+        const Skip = 1000;
+        for (let Engine of [NodeRand_philox4x32, NodeRand_threefry4x64, NodeRand_pcg64, NodeRand_splitmix64]) {
+            let a = new Engine();
+            let b = new Engine();
+            a.SetSeed(TEST_SEED);
+            b.SetSeed(TEST_SEED);
+
+            // power of two range, every number consumes exactly one engine output
+            for (let i = 0; i < Skip; i++) {
+                a.Generate(0, 255);
+            }
+            b.Advance(Skip);
+            chai.expect(b.GenerateInto(new Int32Array(100), 0, 255)).eql(a.GenerateInto(new Int32Array(100), 0, 255));
+            chai.expect(() => b.Advance(-1)).to.throw();
+        }
+    })
+
+    it('Check Jump() splits the sequence of a seed', () => {
+        for (let Engine of [NodeRand_xoshiro256ss, NodeRand_pcg64]) {
+            let a = new Engine();
+            let b = new Engine();
+            a.SetSeed(TEST_SEED);
+            b.SetSeed(TEST_SEED);
+            b.Jump();
+            let aNums = a.GenerateInto(new BigInt64Array(100), TEST_MIN, TEST_MAX);
+            let bNums = b.GenerateInto(new BigInt64Array(100), TEST_MIN, TEST_MAX);
+            chai.expect(aNums).not.eql(bNums);
+
+            a.Jump();
+            chai.expect(a.GenerateInto(new BigInt64Array(100), TEST_MIN, TEST_MAX)).not.eql(bNums);
+        }
+    })
+
+    it('Check golden values, output must not depend on platform or standard library', () => {
+        // Changing these is a breaking change, every seeded sequence changes with them
+        const Golden: { [name: string]: number[] } = {
+            NodeRand_mt19937: [272, -172, -761, 428, 983, 579, 320, 882],
+            NodeRand_mt19937_64: [-380, 274, -561, -441, -389, -945, 175, -495],
+            NodeRand_philox4x32: [657, 973, -29, -528, 538, -17, -634, -149],
+            NodeRand_threefry4x64: [423, -32, -517, 902, -477, 407, -879, 415],
+            NodeRand_xoshiro256ss: [526, -127, -475, -541, 98, -697, 800, -475],
+            NodeRand_pcg64: [582, -815, 94, 901, -629, -463, -81, 926],
+            NodeRand_splitmix64: [-814, -848, -696, 958, -326, 600, 23, 691]
+        };
+
+        for (let [name, Engine] of Object.entries(Engines)) {
+            let a = new Engine();
+            a.SetSeed(TEST_SEED);
+            let nums: Number[] = [];
+            for (let i = 0; i < Golden[name].length; i++) {
+                nums.push(a.Generate(TEST_MIN, TEST_MAX));
+            }
+            chai.expect(nums, name).eql(Golden[name]);
+
+            a.SetSeed(TEST_SEED);
+            chai.expect(Array.from(a.GenerateInto(new Int32Array(Golden[name].length), TEST_MIN, TEST_MAX)), name).eql(Golden[name]);
+        }
+
+        // 64 bit range path
+        let b = new NodeRand_pcg64();
+        b.SetSeed(TEST_SEED);
+        chai.expect(Array.from(b.GenerateInto(new BigInt64Array(4), -1e15, 1e15), n => Number(n)))
+            .eql([581277006149283, -815035832560786, 93952063560399, 900924927996915]);
+    })
+
+    it('Check GetState/SetState resume mid sequence and the state format is stable', () => {
+        // Changing these is a breaking change, saved checkpoints stop loading. First 72 bytes of the state
+        // after SetSeed(TEST_SEED) and 3 draws: header, then the first engine words
+        const Golden: { [name: string]: string } = {
+            NodeRand_mt19937: '4e525354010001000a00000000000000010000000000000000000000700200000000008000000000f735160a000000007879658b000000002837611700000000cf2af7a100000000',
+            NodeRand_mt19937_64: '4e525354010002000a000000000000000100000000000000000000003801000000000080439e22ae6c4f418c1e9fd1642e0953a4b3ffdfe5efef56c70fdd25170abe6ac5817d462d',
+            NodeRand_philox4x32: '4e525354010003000a0000000000000001000000000000000000000003000000ca2f588a00000000be128708000000000300000000000000',
+            NodeRand_threefry4x64: '4e525354010004000a0000000000000001000000000000000000000005000000ca2f588abe1287080000000000000000000000000000000000000000000000000300000000000000',
+            NodeRand_xoshiro256ss: '4e525354010005000a0000000000000001000000000000000000000004000000503d5cbbf29634152787d4203e1f30fc94ac1c650adc76545871be7efb6e4947',
+            NodeRand_pcg64: '4e525354010006000a00000000000000010000000000000000000000020000008e33663704624bb6ad3587e48453e9e1',
+            NodeRand_splitmix64: '4e525354010007000a000000000000000100000000000000000000000100000009a43708eb7f2de3'
+        };
+
+        for (let [name, Engine] of Object.entries(Engines)) {
+            let a = new Engine();
+            a.SetSeed(TEST_SEED);
+            for (let i = 0; i < 3; i++) {
+                a.Generate(TEST_MIN, TEST_MAX);
+            }
+            chai.expect(a.GetState().subarray(0, 72).toString('hex'), name).eql(Golden[name]);
+
+            // mersenne twisters regenerate their state every 624/312 draws, resume on both sides of it
+            for (let skip of [0, 311, 312, 623, 624, 5000]) {
+                a.SetSeed(TEST_SEED);
+                let pending = a.GetState();
+                a.GenerateInto(new Int32Array(skip), TEST_MIN, TEST_MAX);
+                let state = a.GetState();
+                let expected = Array.from(a.GenerateInto(new Int32Array(1000), TEST_MIN, TEST_MAX));
+                let seeds = Array.from(a.GenerateInto(new Int32Array(10), TEST_MIN, TEST_MAX, { threads: 1 }));
+
+                let b = new Engine();
+                b.SetState(state);
+                chai.expect(Array.from(b.GenerateInto(new Int32Array(1000), TEST_MIN, TEST_MAX)), name).eql(expected);
+                chai.expect(Array.from(b.GenerateInto(new Int32Array(10), TEST_MIN, TEST_MAX, { threads: 1 })), name).eql(seeds);
+
+                // taken right after SetSeed, before the first draw
+                b.SetState(pending);
+                a.SetSeed(TEST_SEED);
+                chai.expect(b.Generate(TEST_MIN, TEST_MAX), name).eql(a.Generate(TEST_MIN, TEST_MAX));
+            }
+        }
+
+        let a = new NodeRand();
+        chai.expect(() => new NodeRand_pcg64().SetState(a.GetState())).to.throw(TypeError);
+        chai.expect(() => a.SetState(Buffer.from('not a state'))).to.throw(TypeError);
+    })
+})